@@ -32,10 +32,10 @@ Event Event::make_dq_event(Sign player, MoveResult reason) {
   return result;
 }
 
-Event Event::make_player_joined_event(Sign player, const char *player_name) {
+Event Event::make_player_joined_event(Sign player, NameId player_name_id) {
   Event result;
   result.type = EventType::PLAYER_JOINED;
-  result.data.player_joined.player_name = player_name;
+  result.data.player_joined.player_name_id = player_name_id;
   result.data.player_joined.player_sign = player;
   return result;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "names.hpp"
 #include "state.hpp"
 
 namespace ttt::game {
@@ -18,7 +19,7 @@ struct Event {
   union {
     struct {
       Sign player_sign;
-      const char *player_name;
+      NameId player_name_id;
     } player_joined;
 
     struct {
@@ -39,7 +40,7 @@ struct Event {
   } data;
 
   static Event make_game_started_event();
-  static Event make_player_joined_event(Sign player, const char *player_name);
+  static Event make_player_joined_event(Sign player, NameId player_name_id);
   static Event make_move_event(int x, int y, Sign player);
   static Event make_win_event(Sign player);
   static Event make_dq_event(Sign player, MoveResult reason);
@@ -51,10 +51,12 @@ MoveResult Game::process() {
     }
     m_x_player->set_sign(Sign::X);
     m_o_player->set_sign(Sign::O);
-    m_observer.handle_event(m_state, Event::make_player_joined_event(
-                                         Sign::X, m_x_player->get_name()));
-    m_observer.handle_event(m_state, Event::make_player_joined_event(
-                                         Sign::O, m_o_player->get_name()));
+    const NameId x_name = intern_name(m_x_player->get_name());
+    const NameId o_name = intern_name(m_o_player->get_name());
+    m_observer.handle_event(m_state,
+                            Event::make_player_joined_event(Sign::X, x_name));
+    m_observer.handle_event(m_state,
+                            Event::make_player_joined_event(Sign::O, o_name));
     m_observer.handle_event(m_state, Event::make_game_started_event());
   }
   Sign sign = m_state.get_current_player();
@@ -126,12 +128,13 @@ void ComposedObserver::add_observer(IObserver *obs) {
 void ComposedObserver::remove_observer(IObserver *obs) {
   if (!obs)
     return;
-  for (IObserver **pt1 = m_observers, **pt2 = m_observers; *pt2; ++pt1, ++pt2) {
-    if (*pt1 == obs) {
-      ++pt2;
+  IObserver **pt2 = m_observers;
+  for (IObserver **pt1 = m_observers; *pt1; ++pt1) {
+    if (*pt1 != obs) {
+      *pt2++ = *pt1;
     }
-    *pt1 = *pt2;
   }
+  *pt2 = 0;
 }
 
 void ComposedObserver::handle_event(const State &state, const Event &event) {
@@ -147,7 +150,7 @@ ComposedObserver &ComposedObserver::operator=(const ComposedObserver &obs) {
   for (; obs.m_observers[n]; ++n)
     ;
   delete[] m_observers;
-  m_observers = new IObserver *[n];
+  m_observers = new IObserver *[n + 1];
   for (n = 0; obs.m_observers[n]; ++n)
     m_observers[n] = obs.m_observers[n];
   m_observers[n] = 0;
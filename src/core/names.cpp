@@ -0,0 +1,58 @@
+#include "names.hpp"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ttt::game {
+
+namespace {
+
+struct NameTable {
+  std::mutex mutex;
+  // deque never moves its elements, so the strings keep their addresses
+  std::deque<std::string> names;
+  std::vector<const char *> by_id;
+  std::unordered_map<std::string_view, NameId> ids;
+
+  NameTable() {
+    names.emplace_back();
+    by_id.push_back(names.back().c_str());
+    ids.emplace(names.back(), NO_NAME);
+  }
+};
+
+NameTable &get_table() {
+  static NameTable table;
+  return table;
+}
+
+}; // namespace
+
+NameId intern_name(const char *name) {
+  if (name == nullptr || *name == 0)
+    return NO_NAME;
+  NameTable &table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.ids.find(name);
+  if (it != table.ids.end())
+    return it->second;
+  const NameId id = table.by_id.size();
+  table.names.emplace_back(name);
+  table.by_id.push_back(table.names.back().c_str());
+  table.ids.emplace(table.names.back(), id);
+  return id;
+}
+
+const char *get_name(NameId id) {
+  NameTable &table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  if (id >= table.by_id.size())
+    return table.by_id[NO_NAME];
+  return table.by_id[id];
+}
+
+}; // namespace ttt::game
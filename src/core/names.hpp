@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ttt::game {
+
+// Player names are interned in a process-wide table, so events carry small
+// ids instead of pointers to strings owned by somebody else. A name resolved
+// by an id stays valid until the process exits.
+using NameId = std::uint32_t;
+
+// Id of the empty name.
+const NameId NO_NAME = 0;
+
+// Returns the id of the name, adding it to the table if needed.
+// nullptr is interned as the empty name. Thread-safe.
+NameId intern_name(const char *name);
+
+// Returns the name with the given id or "" for unknown ids. Thread-safe.
+const char *get_name(NameId id);
+
+}; // namespace ttt::game
@@ -32,6 +32,21 @@ State::State(const State &state)
 
 State::~State() { delete m_initializer; }
 
+State &State::operator=(const State &state) {
+  if (this == &state)
+    return *this;
+  IFieldInitializer *initializer = state.m_initializer->clone();
+  delete m_initializer;
+  m_initializer = initializer;
+  m_opts = state.m_opts;
+  m_field = state.m_field;
+  m_move_no = state.m_move_no;
+  m_status = state.m_status;
+  m_player = state.m_player;
+  m_winner = state.m_winner;
+  return *this;
+}
+
 void State::reset() {
   m_field.reset();
   m_initializer->initialize(m_field);
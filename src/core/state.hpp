@@ -56,7 +56,7 @@ public:
   const Opts &get_opts() const;
   Sign get_winner() const;
 
-  State &operator=(const State &state) = default;
+  State &operator=(const State &state);
 
   void set_field_initializer(const IFieldInitializer *initializer);
 
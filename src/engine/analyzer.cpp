@@ -0,0 +1,43 @@
+#include "analyzer.hpp"
+
+namespace ttt::engine {
+
+Analyzer::Analyzer(TranspositionTable *tt, size_t hash_mb) : m_tt(tt) {
+  if (!m_tt) {
+    m_own_tt = std::make_unique<TranspositionTable>(hash_mb);
+    m_tt = m_own_tt.get();
+  }
+  m_search.set_table(m_tt);
+}
+
+void Analyzer::start(const State &state, const SearchLimits &limits,
+                     int n_lines, IIterationObserver *observer) {
+  stop();
+  m_search.set_multi_pv(n_lines);
+  m_search.set_iteration_observer(observer);
+  m_search.clear_deadline();
+  m_thread = std::thread([this, board = Board(state, m_weights), limits]() {
+    m_result = m_search.run(board, limits);
+  });
+}
+
+void Analyzer::stop() {
+  if (!m_thread.joinable())
+    return;
+  // unlike `Search::stop` the deadline is not lost by a search which is
+  // just starting
+  m_search.set_deadline(Search::Clock::now());
+  m_thread.join();
+}
+
+SearchResult Analyzer::analyze(const State &state, const SearchLimits &limits,
+                               int n_lines) {
+  stop();
+  m_search.set_multi_pv(n_lines);
+  m_search.set_iteration_observer(nullptr);
+  m_search.clear_deadline();
+  m_result = m_search.run(Board(state, m_weights), limits);
+  return m_result;
+}
+
+}; // namespace ttt::engine
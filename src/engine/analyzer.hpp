@@ -0,0 +1,52 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+#include "search.hpp"
+#include "transposition_table.hpp"
+
+#include <memory>
+#include <thread>
+
+namespace ttt::engine {
+
+// Searches positions on a background thread for spectators and debugging:
+// the best `n_lines` moves with their scores and principal variations are
+// reported after every iteration. The analysis may share the transposition
+// table of a player, it does not age the table, its owner does.
+class Analyzer {
+  Search m_search;
+  TranspositionTable *m_tt;
+  std::unique_ptr<TranspositionTable> m_own_tt;
+  EvalWeights m_weights;
+  std::thread m_thread;
+  SearchResult m_result;
+
+public:
+  // Without a table the analyzer gets its own one of `hash_mb`.
+  explicit Analyzer(TranspositionTable *tt = nullptr, size_t hash_mb = 16);
+  Analyzer(const Analyzer &) = delete;
+  Analyzer &operator=(const Analyzer &) = delete;
+  ~Analyzer() { stop(); }
+
+  // The settings apply to the next analysis.
+  void set_weights(const EvalWeights &weights) { m_weights = weights; }
+  void set_params(const SearchParams &params) { m_search.set_params(params); }
+
+  // Stops the running analysis and starts the one of the state. The
+  // observer is called by the thread of the analysis, the state is copied.
+  void start(const State &state, const SearchLimits &limits, int n_lines,
+             IIterationObserver *observer = nullptr);
+  // Stops the analysis and waits for its thread, it takes at most the time
+  // of a thousand nodes.
+  void stop();
+  bool is_running() const { return m_thread.joinable(); }
+  // Result of the last stopped or finished analysis.
+  const SearchResult &get_result() const { return m_result; }
+
+  // Analyses the state on the calling thread.
+  SearchResult analyze(const State &state, const SearchLimits &limits,
+                       int n_lines);
+};
+
+}; // namespace ttt::engine
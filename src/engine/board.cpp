@@ -0,0 +1,366 @@
+#include "board.hpp"
+
+#include "nnue.hpp"
+
+namespace ttt::engine {
+
+static const uint64_t LAST_MOVE_KEY = 0x9e3779b97f4a7c15ull;
+
+static uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Keys depend only on the coordinates, so equal positions of different
+// games with the same options have equal hashes.
+static uint64_t stone_key(int x, int y, int side) {
+  return mix((uint64_t(x) << 33) ^ (uint64_t(y) << 2) ^ uint64_t(side + 1));
+}
+
+static std::shared_ptr<const Geometry> make_geometry(const State &state) {
+  const auto &opts = state.get_opts();
+  auto geo = std::make_shared<Geometry>();
+  const int border = Geometry::BORDER;
+  geo->rows = opts.rows;
+  geo->cols = opts.cols;
+  geo->stride = opts.cols + 2 * border;
+  geo->win_len = opts.win_len;
+  geo->n_cells = geo->stride * (opts.rows + 2 * border);
+  geo->dirs[0] = 1;
+  geo->dirs[1] = geo->stride;
+  geo->dirs[2] = geo->stride + 1;
+  geo->dirs[3] = geo->stride - 1;
+  static const int dx[4] = {1, 0, 1, -1};
+  static const int dy[4] = {0, 1, 1, 1};
+
+  uint64_t layout = mix(uint64_t(opts.rows) << 48 ^ uint64_t(opts.cols) << 32 ^
+                        uint64_t(opts.win_len) << 16 ^
+                        uint64_t(opts.max_moves));
+  geo->keys.assign(2 * geo->n_cells, 0);
+  for (int y = 0; y < opts.rows; ++y) {
+    for (int x = 0; x < opts.cols; ++x) {
+      const int cell = (y + border) * geo->stride + x + border;
+      geo->keys[2 * cell] = stone_key(x, y, 0);
+      geo->keys[2 * cell + 1] = stone_key(x, y, 1);
+      if (state.get_value(x, y) == Sign::WALL)
+        layout ^= stone_key(x, y, 2);
+    }
+  }
+  geo->layout_key = layout;
+
+  std::vector<int> n_windows(geo->n_cells, 0);
+  for (int d = 0; d < 4; ++d) {
+    for (int y = 0; y < opts.rows; ++y) {
+      for (int x = 0; x < opts.cols; ++x) {
+        bool ok = true;
+        for (int k = 0; k < opts.win_len && ok; ++k)
+          ok = state.get_value(x + k * dx[d], y + k * dy[d]) != Sign::WALL;
+        if (!ok)
+          continue;
+        const int start = (y + border) * geo->stride + x + border;
+        geo->window_start.push_back(start);
+        geo->window_dir.push_back(d);
+        for (int k = 0; k < opts.win_len; ++k)
+          ++n_windows[start + k * geo->dirs[d]];
+      }
+    }
+  }
+  geo->cell_windows_begin.assign(geo->n_cells + 1, 0);
+  for (int i = 0; i < geo->n_cells; ++i)
+    geo->cell_windows_begin[i + 1] = geo->cell_windows_begin[i] + n_windows[i];
+  geo->cell_windows.resize(geo->cell_windows_begin.back());
+  std::vector<int> pos(geo->cell_windows_begin.begin(),
+                       geo->cell_windows_begin.end() - 1);
+  for (int w = 0; w < int(geo->window_start.size()); ++w) {
+    const int step = geo->dirs[geo->window_dir[w]];
+    for (int k = 0; k < opts.win_len; ++k)
+      geo->cell_windows[pos[geo->window_start[w] + k * step]++] = w;
+  }
+  return geo;
+}
+
+Board::Board(const State &state, const EvalWeights &weights)
+    : m_geo(make_geometry(state)), m_weights(weights) {
+  const int win_len = m_geo->win_len;
+  m_weight_by_count.assign(win_len + 1, 0);
+  for (int n = 1; n <= win_len; ++n)
+    m_weight_by_count[n] = window_weight(win_len, n, m_weights);
+
+  m_cells.assign(m_geo->n_cells, WALL);
+  m_near.assign(m_geo->n_cells, 0);
+  for (int side = 0; side < 2; ++side) {
+    m_count[side].assign(m_geo->window_start.size(), 0);
+    m_wins[side].assign(m_geo->n_cells, 0);
+    m_win_cells[side].clear();
+    m_win_pos[side].assign(m_geo->n_cells, -1);
+  }
+  for (int y = 0; y < m_geo->rows; ++y)
+    for (int x = 0; x < m_geo->cols; ++x)
+      if (state.get_value(x, y) != Sign::WALL)
+        m_cells[index(x, y)] = EMPTY;
+
+  // stones are placed one by one, so the counters stay consistent
+  m_hash = m_geo->layout_key;
+  const int stride = m_geo->stride;
+  for (int y = 0; y < m_geo->rows; ++y) {
+    for (int x = 0; x < m_geo->cols; ++x) {
+      const Sign sign = state.get_value(x, y);
+      if (sign != Sign::X && sign != Sign::O)
+        continue;
+      const int cell = index(x, y);
+      const int side = side_of(sign);
+      m_cells[cell] = side + 1;
+      _add_stone(cell, side, 1);
+      m_hash ^= m_geo->keys[2 * cell + side];
+      for (int dy = -2; dy <= 2; ++dy)
+        for (int dx = -2; dx <= 2; ++dx)
+          ++m_near[cell + dy * stride + dx];
+    }
+  }
+  m_masks.init(state);
+  m_move_no = state.get_move_no();
+  m_max_moves = state.get_opts().max_moves;
+  m_last_move = state.get_status() == game::Status::LAST_MOVE;
+  if (m_last_move)
+    m_hash ^= LAST_MOVE_KEY;
+  if (state.get_status() == game::Status::ENDED) {
+    switch (state.get_winner()) {
+    case Sign::X:
+      m_outcome = Outcome::X_WINS;
+      break;
+    case Sign::O:
+      m_outcome = Outcome::O_WINS;
+      break;
+    default:
+      m_outcome = Outcome::DRAW;
+    }
+  }
+}
+
+int Board::_window_score(int n_x, int n_o) const {
+  if (n_o == 0)
+    return m_weight_by_count[n_x];
+  if (n_x == 0)
+    return -m_weight_by_count[n_o];
+  return 0;
+}
+
+int Board::_empty_cell_of(int window, int skip) const {
+  const int step = m_geo->dirs[m_geo->window_dir[window]];
+  int cell = m_geo->window_start[window];
+  for (int k = 0; k < m_geo->win_len; ++k, cell += step)
+    if (m_cells[cell] == EMPTY && cell != skip)
+      return cell;
+  return -1;
+}
+
+// Updates window counters after a stone of the side was placed at the cell
+// (delta = 1) or removed from it (delta = -1). The cell must already hold
+// its new value. Returns whether some window is completed by the side.
+bool Board::_add_stone(int cell, int side, int delta) {
+  const int win_len = m_geo->win_len;
+  const int *w = m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell];
+  const int *end =
+      m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell + 1];
+  bool completes = false;
+  for (; w != end; ++w) {
+    int n[2] = {m_count[0][*w], m_count[1][*w]};
+    const bool was_threat[2] = {n[0] == win_len - 1 && n[1] == 0,
+                                n[1] == win_len - 1 && n[0] == 0};
+    m_eval -= _window_score(n[0], n[1]);
+    n[side] += delta;
+    m_count[side][*w] = n[side];
+    m_eval += _window_score(n[0], n[1]);
+    completes |= n[side] == win_len;
+    const bool is_threat[2] = {n[0] == win_len - 1 && n[1] == 0,
+                               n[1] == win_len - 1 && n[0] == 0};
+    for (int s = 0; s < 2; ++s) {
+      if (was_threat[s] == is_threat[s])
+        continue;
+      // a placed stone always fills the single empty cell of a window that
+      // stops being a threat and a removed stone frees the empty cell of a
+      // new threat, in the other cases the cell has to be found
+      int empty = cell;
+      if (delta > 0 ? is_threat[s] : was_threat[s])
+        empty = _empty_cell_of(*w, cell);
+      if (is_threat[s]) {
+        ++m_threats[s];
+        if (m_wins[s][empty]++ == 0)
+          _add_win(s, empty);
+      } else {
+        --m_threats[s];
+        if (--m_wins[s][empty] == 0)
+          _remove_win(s, empty);
+      }
+    }
+  }
+  return completes;
+}
+
+void Board::_add_win(int side, int cell) {
+  m_win_pos[side][cell] = m_win_cells[side].size();
+  m_win_cells[side].push_back(cell);
+}
+
+void Board::_remove_win(int side, int cell) {
+  auto &cells = m_win_cells[side];
+  const int pos = m_win_pos[side][cell];
+  cells[pos] = cells.back();
+  m_win_pos[side][cells[pos]] = pos;
+  cells.pop_back();
+  m_win_pos[side][cell] = -1;
+}
+
+int Board::find_winning_move() const {
+  const int stm = get_side_to_move();
+  if (m_win_cells[stm].empty() || m_last_move)
+    return -1;
+  if (stm == 1 || m_move_no + 1 >= m_max_moves)
+    return m_win_cells[stm][0];
+  for (const int cell : m_win_cells[0])
+    if (m_wins[1][cell] == m_threats[1])
+      return cell;
+  return -1;
+}
+
+void Board::list_x_wins(std::vector<int> &cells) const {
+  cells.clear();
+  if (m_last_move)
+    return;
+  const bool last_game_move = m_move_no + 1 >= m_max_moves;
+  for (const int cell : m_win_cells[0])
+    if (last_game_move || m_wins[1][cell] == m_threats[1])
+      cells.push_back(cell);
+}
+
+int Board::get_move_gain(int cell, int side) const {
+  const int *w = m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell];
+  const int *end =
+      m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell + 1];
+  const uint8_t *own = m_count[side].data();
+  const uint8_t *opp = m_count[1 - side].data();
+  int gain = 0;
+  for (; w != end; ++w) {
+    if (opp[*w] == 0)
+      gain += m_weight_by_count[own[*w] + 1] - m_weight_by_count[own[*w]];
+    else if (own[*w] == 0)
+      gain += m_weight_by_count[opp[*w]];
+  }
+  return gain;
+}
+
+bool Board::makes_threat(int cell, int side) const {
+  const int win_len = m_geo->win_len;
+  const int *w = m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell];
+  const int *end =
+      m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell + 1];
+  for (; w != end; ++w)
+    if (m_count[side][*w] == win_len - 2 && m_count[1 - side][*w] == 0)
+      return true;
+  return false;
+}
+
+int Board::count_windows(int cell, int side, int n_stones) const {
+  const int *w = m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell];
+  const int *end =
+      m_geo->cell_windows.data() + m_geo->cell_windows_begin[cell + 1];
+  int n = 0;
+  for (; w != end; ++w)
+    n += m_count[side][*w] == n_stones && m_count[1 - side][*w] == 0;
+  return n;
+}
+
+void Board::make(int cell) {
+  const int side = get_side_to_move();
+  m_history.push_back({cell, m_last_move, m_outcome});
+  m_cells[cell] = side + 1;
+  m_hash ^= m_geo->keys[2 * cell + side];
+  const bool completes = _add_stone(cell, side, 1);
+  if (m_net)
+    _push_accumulator(cell, side);
+  const int stride = m_geo->stride;
+  for (int dy = -2; dy <= 2; ++dy)
+    for (int dx = -2; dx <= 2; ++dx)
+      ++m_near[cell + dy * stride + dx];
+  if (m_masks.is_valid())
+    m_masks.set_stone(get_x(cell), get_y(cell), side);
+  ++m_move_no;
+  if (m_last_move) {
+    m_last_move = false;
+    m_hash ^= LAST_MOVE_KEY;
+    m_outcome = completes ? Outcome::DRAW : Outcome::X_WINS;
+  } else if (completes) {
+    if (side == 1) {
+      m_outcome = Outcome::O_WINS;
+    } else if (m_move_no >= m_max_moves) {
+      m_outcome = Outcome::X_WINS;
+    } else {
+      m_last_move = true;
+      m_hash ^= LAST_MOVE_KEY;
+    }
+  } else if (m_move_no >= m_max_moves) {
+    m_outcome = Outcome::DRAW;
+  }
+}
+
+void Board::unmake() {
+  const Undo undo = m_history.back();
+  m_history.pop_back();
+  const int cell = undo.cell;
+  const int side = m_cells[cell] - 1;
+  m_cells[cell] = EMPTY;
+  m_hash ^= m_geo->keys[2 * cell + side];
+  _add_stone(cell, side, -1);
+  const int stride = m_geo->stride;
+  for (int dy = -2; dy <= 2; ++dy)
+    for (int dx = -2; dx <= 2; ++dx)
+      --m_near[cell + dy * stride + dx];
+  if (m_masks.is_valid())
+    m_masks.clear_stone(get_x(cell), get_y(cell), side);
+  --m_move_no;
+  if (m_last_move != undo.last_move)
+    m_hash ^= LAST_MOVE_KEY;
+  m_last_move = undo.last_move;
+  m_outcome = undo.outcome;
+  if (m_net)
+    _pop_accumulator();
+}
+
+bool Board::set_network(std::shared_ptr<const Network> net) {
+  if (net && !net->fits(*this))
+    return false;
+  m_net = std::move(net);
+  m_acc.clear();
+  if (m_net) {
+    const int hidden = m_net->get_hidden();
+    m_acc.reserve(size_t(m_geo->rows * m_geo->cols + 1) * hidden);
+    m_acc.resize(hidden);
+    m_net->refresh(*this, m_acc.data());
+  }
+  return true;
+}
+
+void Board::_push_accumulator(int cell, int side) {
+  const int hidden = m_net->get_hidden();
+  const size_t top = m_acc.size();
+  m_acc.resize(top + hidden);
+  m_net->add_feature(m_acc.data() + top - hidden, m_acc.data() + top,
+                     m_net->get_feature(get_x(cell), get_y(cell), side));
+}
+
+void Board::_pop_accumulator() {
+  const int hidden = m_net->get_hidden();
+  // moves made before the network was set have no accumulator to return to
+  if (m_acc.size() > size_t(hidden))
+    m_acc.resize(m_acc.size() - hidden);
+  else
+    m_net->refresh(*this, m_acc.data());
+}
+
+int Board::_network_eval() const {
+  return m_net->evaluate(m_acc.data() + m_acc.size() - m_net->get_hidden());
+}
+
+}; // namespace ttt::engine
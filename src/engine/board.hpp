@@ -0,0 +1,216 @@
+#pragma once
+
+#include "candidates.hpp"
+#include "core/state.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::Sign;
+using game::State;
+
+// Values of the board cells, they match `game::Sign`.
+enum Cell : uint8_t { EMPTY = 0, X_STONE = 1, O_STONE = 2, WALL = 3 };
+
+// Sides are numbered 0 for X and 1 for O.
+inline int side_of(Sign sign) { return sign == Sign::O ? 1 : 0; }
+inline Sign sign_of(int side) { return side == 0 ? Sign::X : Sign::O; }
+
+enum class Outcome : uint8_t { NONE, X_WINS, O_WINS, DRAW };
+
+// Scores of the line windows used by the static evaluation.
+struct EvalWeights {
+  // window which misses 1, 2, 3 and 4 stones of one side to a line,
+  // windows which miss more stones score 1
+  int missing[4] = {1024, 128, 16, 2};
+};
+
+// Score of a window with `n_stones` stones of one side and no stones of the
+// other, a completed line scores eight times a window one stone short.
+constexpr int window_weight(int win_len, int n_stones,
+                            const EvalWeights &weights) {
+  const int missing = win_len - n_stones;
+  if (n_stones == 0)
+    return 0;
+  if (missing == 0)
+    return 8 * weights.missing[0];
+  return missing <= 4 ? weights.missing[missing - 1] : 1;
+}
+
+// Immutable part of the board: dimensions and line windows which do not
+// cross walls or edges. It is shared between copies of a board.
+struct Geometry {
+  // cells are stored row by row with a border of this width around the field
+  static const int BORDER = 2;
+
+  int rows;
+  int cols;
+  int stride;
+  int win_len;
+  int n_cells;
+  // index deltas of the four line directions
+  int dirs[4];
+  // first cell and direction of every window
+  std::vector<int> window_start;
+  std::vector<uint8_t> window_dir;
+  // windows containing a cell are
+  // cell_windows[cell_windows_begin[i]] .. cell_windows[cell_windows_begin[i+1]]
+  std::vector<int> cell_windows_begin;
+  std::vector<int> cell_windows;
+  // zobrist keys of stones, two per cell
+  std::vector<uint64_t> keys;
+  // key of walls layout and field options
+  uint64_t layout_key;
+};
+
+class Network;
+
+// Fast board for search: make/unmake moves, incremental zobrist hash, line
+// window counters and evaluation. The game rules follow
+// `State::process_move`, including the LAST_MOVE reply of O.
+class Board {
+  struct Undo {
+    int cell;
+    bool last_move;
+    Outcome outcome;
+  };
+
+  std::shared_ptr<const Geometry> m_geo;
+  EvalWeights m_weights;
+  std::vector<int> m_weight_by_count;
+  std::vector<uint8_t> m_cells;
+  // number of stones at distance of at most 2 from a cell
+  std::vector<uint8_t> m_near;
+  // rows of walls and stones, empty for fields larger than masks allow
+  FieldMasks m_masks;
+  // stones of X and O in every window
+  std::vector<uint8_t> m_count[2];
+  // number of windows of a side with a single empty cell at the cell
+  std::vector<uint16_t> m_wins[2];
+  // cells with non-zero `m_wins` of a side and their positions in the list
+  std::vector<int> m_win_cells[2];
+  std::vector<int> m_win_pos[2];
+  int m_threats[2] = {0, 0};
+  int m_eval = 0;
+  uint64_t m_hash = 0;
+  int m_move_no = 0;
+  int m_max_moves = 0;
+  bool m_last_move = false;
+  Outcome m_outcome = Outcome::NONE;
+  std::vector<Undo> m_history;
+  // with a network the evaluation comes from its first layer accumulators,
+  // one per position from the one it was set at to the current
+  std::shared_ptr<const Network> m_net;
+  std::vector<int16_t> m_acc;
+
+public:
+  explicit Board(const State &state, const EvalWeights &weights = {});
+
+  const Geometry &get_geometry() const { return *m_geo; }
+  int get_rows() const { return m_geo->rows; }
+  int get_cols() const { return m_geo->cols; }
+  int get_win_len() const { return m_geo->win_len; }
+  int get_cells_num() const { return m_geo->n_cells; }
+
+  int index(int x, int y) const {
+    return (y + Geometry::BORDER) * m_geo->stride + x + Geometry::BORDER;
+  }
+  int get_x(int cell) const {
+    return cell % m_geo->stride - Geometry::BORDER;
+  }
+  int get_y(int cell) const {
+    return cell / m_geo->stride - Geometry::BORDER;
+  }
+  uint8_t at(int cell) const { return m_cells[cell]; }
+  bool is_empty(int cell) const { return m_cells[cell] == EMPTY; }
+  bool has_neighbours(int cell) const { return m_near[cell] > 0; }
+  const FieldMasks &get_masks() const { return m_masks; }
+
+  int get_side_to_move() const { return m_move_no & 1; }
+  int get_move_no() const { return m_move_no; }
+  int get_max_moves() const { return m_max_moves; }
+  int get_last_cell() const {
+    return m_history.empty() ? -1 : m_history.back().cell;
+  }
+  // X has completed a line, O makes the last reply
+  bool is_last_move() const { return m_last_move; }
+  Outcome get_outcome() const { return m_outcome; }
+  bool is_over() const { return m_outcome != Outcome::NONE; }
+  uint64_t get_hash() const { return m_hash; }
+
+  // Number of distinct ways for a side to complete a line with one stone.
+  int get_threats(int side) const { return m_threats[side]; }
+  // Whether a stone of a side at the cell completes a line.
+  bool is_winning_cell(int cell, int side) const {
+    return m_wins[side][cell] > 0;
+  }
+  // Number of threats of a side which a stone at the cell completes.
+  int get_winning_windows(int cell, int side) const {
+    return m_wins[side][cell];
+  }
+  // Distinct cells at which a side completes a line, in no particular order.
+  const std::vector<int> &get_winning_cells(int side) const {
+    return m_win_cells[side];
+  }
+  // Some cell which completes a line for a side or -1.
+  int find_winning_cell(int side) const {
+    return m_win_cells[side].empty() ? -1 : m_win_cells[side][0];
+  }
+  // Cell at which the side to move wins at once or -1. A line of X wins when
+  // its stone also takes every cell at which O would complete a line.
+  int find_winning_move() const;
+
+  // The LAST_MOVE rule without search. After a line of X the game is a draw
+  // if O completes a line with the reply, at any of `get_winning_cells(1)`,
+  // and X wins otherwise.
+  Outcome get_last_move_outcome() const {
+    return m_win_cells[1].empty() ? Outcome::X_WINS : Outcome::DRAW;
+  }
+  // Cells at which X completes a line that O cannot answer, as the stone
+  // also takes every cell at which O would complete a line. Any of them wins
+  // unless it is the last move of the game, then every line of X wins.
+  void list_x_wins(std::vector<int> &cells) const;
+
+  // Evaluates positions by the network instead of the line windows. Returns
+  // false and keeps the windows if the network is for another field; null
+  // detaches the network.
+  bool set_network(std::shared_ptr<const Network> net);
+  const Network *get_network() const { return m_net.get(); }
+
+  // Static evaluation from X point of view.
+  int get_eval() const { return m_net ? _network_eval() : m_eval; }
+  // Evaluation by the line windows, even with a network.
+  int get_window_eval() const { return m_eval; }
+  // Static evaluation from the side to move point of view.
+  int evaluate() const {
+    return get_side_to_move() == 0 ? get_eval() : -get_eval();
+  }
+  // Gain in evaluation of a side if it plays at the empty cell, both from
+  // building own lines and from blocking lines of the opponent.
+  int get_move_gain(int cell, int side) const;
+  // Whether a stone of a side at the empty cell leaves a window one stone
+  // short of a line.
+  bool makes_threat(int cell, int side) const;
+  // Number of windows through the cell without stones of the opponent in
+  // which a side has `n_stones` stones.
+  int count_windows(int cell, int side, int n_stones) const;
+
+  // Places a stone of the side to move at an empty cell.
+  void make(int cell);
+  void unmake();
+
+private:
+  bool _add_stone(int cell, int side, int delta);
+  int _window_score(int n_x, int n_o) const;
+  int _empty_cell_of(int window, int skip = -1) const;
+  void _add_win(int side, int cell);
+  void _remove_win(int side, int cell);
+  void _push_accumulator(int cell, int side);
+  void _pop_accumulator();
+  int _network_eval() const;
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,131 @@
+#include "candidates.hpp"
+
+#include <algorithm>
+
+namespace ttt::engine {
+
+using game::Sign;
+
+using Rows = std::array<uint64_t, MAX_MASK_SIZE>;
+
+bool FieldMasks::init(const State &state) {
+  *this = FieldMasks();
+  const auto &opts = state.get_opts();
+  if (opts.rows > MAX_MASK_SIZE || opts.cols > MAX_MASK_SIZE)
+    return false;
+  m_rows = opts.rows;
+  m_cols = opts.cols;
+  m_win_len = opts.win_len;
+  m_full = m_cols == 64 ? ~uint64_t(0) : (uint64_t(1) << m_cols) - 1;
+  for (int y = 0; y < m_rows; ++y) {
+    for (int x = 0; x < m_cols; ++x) {
+      const Sign sign = state.get_value(x, y);
+      if (sign == Sign::WALL)
+        m_walls[y] |= uint64_t(1) << x;
+      else if (sign == Sign::X || sign == Sign::O)
+        set_stone(x, y, sign == Sign::O);
+    }
+  }
+  return true;
+}
+
+// Bit x of the result is bit x + dx of the row.
+static uint64_t shift(uint64_t row, int dx) {
+  return dx >= 0 ? row >> dx : row << -dx;
+}
+
+// Cells at which a stone of the side leaves a window with at most one empty
+// cell. Every window of `win_len` cells in a direction is counted at its
+// first cell: the stones of its cells are added up by bit-sliced counters,
+// one bit of each counter per cell of the row.
+static void add_threat_cells(const FieldMasks &masks, int side, Rows &rows) {
+  static const int DIRS[4][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
+  const int n_rows = masks.get_rows(), win_len = masks.get_win_len();
+  int n_planes = 1;
+  while ((win_len >> n_planes) != 0)
+    ++n_planes;
+  Rows free, windows;
+  for (int y = 0; y < n_rows; ++y)
+    free[y] = masks.get_full() & ~masks.get_walls(y) &
+              ~masks.get_stones(y, 1 - side);
+  auto equals = [&](const uint64_t *planes, int n) {
+    uint64_t eq = ~uint64_t(0);
+    for (int p = 0; p < n_planes; ++p)
+      eq &= (n >> p) & 1 ? planes[p] : ~planes[p];
+    return eq;
+  };
+  for (const auto &dir : DIRS) {
+    const int dx = dir[0], dy = dir[1];
+    for (int y = 0; y < n_rows; ++y) {
+      windows[y] = 0;
+      if (y + (win_len - 1) * dy >= n_rows)
+        continue;
+      uint64_t ok = ~uint64_t(0);
+      uint64_t planes[7] = {};
+      for (int i = 0; i < win_len; ++i) {
+        const int yy = y + i * dy;
+        ok &= shift(free[yy], i * dx);
+        uint64_t carry = shift(masks.get_stones(yy, side), i * dx);
+        for (int p = 0; p < n_planes && carry; ++p) {
+          const uint64_t t = planes[p] & carry;
+          planes[p] ^= carry;
+          carry = t;
+        }
+      }
+      uint64_t counts = equals(planes, win_len - 1);
+      if (win_len > 2)
+        counts |= equals(planes, win_len - 2);
+      windows[y] = ok & counts;
+    }
+    for (int y = 0; y < n_rows; ++y)
+      if (windows[y])
+        for (int i = 0; i < win_len; ++i)
+          rows[y + i * dy] |= shift(windows[y], -i * dx);
+  }
+}
+
+void get_candidate_rows(const FieldMasks &masks, const CandidateOpts &opts,
+                        Rows &rows) {
+  const int n_rows = masks.get_rows();
+  const uint64_t full = masks.get_full();
+  rows.fill(0);
+  if (opts.threats_only) {
+    if (masks.get_win_len() <= std::max(n_rows, masks.get_cols()))
+      for (int side = 0; side < 2; ++side)
+        add_threat_cells(masks, side, rows);
+  } else {
+    const int radius = std::clamp(opts.radius, 0, MAX_MASK_SIZE - 1);
+    // stones spread along their rows, then the rows spread to their
+    // neighbours
+    Rows spread;
+    for (int y = 0; y < n_rows; ++y) {
+      const uint64_t stones = masks.get_stones(y, 0) | masks.get_stones(y, 1);
+      spread[y] = stones;
+      for (int r = 1; r <= radius; ++r)
+        spread[y] |= stones << r | stones >> r;
+    }
+    for (int y = 0; y < n_rows; ++y) {
+      const int end = std::min(n_rows - 1, y + radius);
+      for (int yy = std::max(0, y - radius); yy <= end; ++yy)
+        rows[y] |= spread[yy];
+    }
+  }
+  uint64_t any = 0;
+  for (int y = 0; y < n_rows; ++y) {
+    rows[y] &= full & ~masks.get_occupied(y);
+    any |= rows[y];
+  }
+  // no stones yet or walls cut the empty cells off the stones
+  if (!any && !opts.threats_only)
+    for (int y = 0; y < n_rows; ++y)
+      rows[y] = full & ~masks.get_occupied(y);
+}
+
+void list_candidates(const FieldMasks &masks, const CandidateOpts &opts,
+                     std::vector<Point> &moves) {
+  moves.clear();
+  for_each_candidate(masks, opts,
+                     [&](int x, int y) { moves.push_back({x, y}); });
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::Point;
+using game::State;
+
+// Fields of at most this number of rows and columns have masks.
+const int MAX_MASK_SIZE = 64;
+
+// Walls and stones of a field as bit masks of its rows, bit x of row y is
+// the cell (x, y). Candidate moves are found by shifts of whole rows.
+class FieldMasks {
+  int m_rows = 0;
+  int m_cols = 0;
+  int m_win_len = 0;
+  uint64_t m_full = 0;
+  std::array<uint64_t, MAX_MASK_SIZE> m_walls = {};
+  // stones of X and O
+  std::array<uint64_t, MAX_MASK_SIZE> m_stones[2] = {};
+  int m_n_stones = 0;
+
+public:
+  // Returns false for larger fields, the masks stay empty.
+  bool init(const State &state);
+  bool is_valid() const { return m_rows > 0; }
+
+  int get_rows() const { return m_rows; }
+  int get_cols() const { return m_cols; }
+  int get_win_len() const { return m_win_len; }
+  // bits of the cells of a row
+  uint64_t get_full() const { return m_full; }
+  uint64_t get_walls(int y) const { return m_walls[y]; }
+  uint64_t get_stones(int y, int side) const { return m_stones[side][y]; }
+  uint64_t get_occupied(int y) const {
+    return m_walls[y] | m_stones[0][y] | m_stones[1][y];
+  }
+  int get_stones_num() const { return m_n_stones; }
+
+  void set_stone(int x, int y, int side) {
+    m_stones[side][y] |= uint64_t(1) << x;
+    ++m_n_stones;
+  }
+  void clear_stone(int x, int y, int side) {
+    m_stones[side][y] &= ~(uint64_t(1) << x);
+    --m_n_stones;
+  }
+};
+
+struct CandidateOpts {
+  // candidates are at most this number of cells away from a stone in every
+  // direction
+  int radius = 2;
+  // only cells at which a stone of either side completes a line or leaves a
+  // window one stone short of a line
+  bool threats_only = false;
+};
+
+// Masks of the candidate moves of every row: the empty cells near stones or,
+// when there are none, every empty cell, so the masks are empty only on a
+// full field. In threat mode there may be none.
+void get_candidate_rows(const FieldMasks &masks, const CandidateOpts &opts,
+                        std::array<uint64_t, MAX_MASK_SIZE> &rows);
+
+// Candidate cells row by row, `f(x, y)` is called for every one.
+template <class F>
+void for_each_candidate(const FieldMasks &masks, const CandidateOpts &opts,
+                        F &&f) {
+  std::array<uint64_t, MAX_MASK_SIZE> rows;
+  get_candidate_rows(masks, opts, rows);
+  for (int y = 0; y < masks.get_rows(); ++y)
+    for (uint64_t bits = rows[y]; bits; bits &= bits - 1)
+      f(__builtin_ctzll(bits), y);
+}
+
+void list_candidates(const FieldMasks &masks, const CandidateOpts &opts,
+                     std::vector<Point> &moves);
+
+}; // namespace ttt::engine
@@ -0,0 +1,102 @@
+#include "large_pages.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace ttt::engine {
+
+static std::atomic<PageMode> page_policy{PageMode::TRANSPARENT};
+
+const char *to_string(PageMode mode) {
+  switch (mode) {
+  case PageMode::NORMAL:
+    return "normal";
+  case PageMode::TRANSPARENT:
+    return "transparent";
+  case PageMode::HUGETLB:
+    return "huge";
+  }
+  return "?";
+}
+
+bool parse_page_mode(const char *text, PageMode &mode) {
+  for (PageMode m :
+       {PageMode::NORMAL, PageMode::TRANSPARENT, PageMode::HUGETLB}) {
+    if (std::strcmp(text, to_string(m)) == 0) {
+      mode = m;
+      return true;
+    }
+  }
+  return false;
+}
+
+void set_page_policy(PageMode policy) {
+  page_policy.store(policy, std::memory_order_relaxed);
+}
+
+PageMode get_page_policy() {
+  return page_policy.load(std::memory_order_relaxed);
+}
+
+static size_t round_up(size_t size, size_t step) {
+  return (size + step - 1) / step * step;
+}
+
+bool PageMemory::allocate(size_t size, PageMode policy) {
+  release();
+  if (size == 0)
+    return true;
+  const PageMode mode = size >= HUGE_PAGE_SIZE ? policy : PageMode::NORMAL;
+  const size_t huge_size = round_up(size, HUGE_PAGE_SIZE);
+#ifdef __linux__
+  if (mode == PageMode::HUGETLB) {
+    void *data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      m_data = data;
+      m_mapped = huge_size;
+      m_mode = PageMode::HUGETLB;
+    }
+  }
+  // without reserved huge pages the transparent ones are tried
+  if (!m_data && mode != PageMode::NORMAL) {
+    m_data = std::aligned_alloc(HUGE_PAGE_SIZE, huge_size);
+    if (m_data && madvise(m_data, huge_size, MADV_HUGEPAGE) == 0)
+      m_mode = PageMode::TRANSPARENT;
+  }
+#endif
+  if (!m_data)
+    m_data = std::aligned_alloc(64, round_up(size, 64));
+  if (!m_data)
+    return false;
+  m_size = size;
+  // writing every page maps it now instead of in the first search
+  std::memset(m_data, 0, size);
+  return true;
+}
+
+void PageMemory::release() {
+#ifdef __linux__
+  if (m_mapped > 0)
+    munmap(m_data, m_mapped);
+  else
+#endif
+    std::free(m_data);
+  m_data = nullptr;
+  m_size = m_mapped = 0;
+  m_mode = PageMode::NORMAL;
+}
+
+void PageMemory::swap(PageMemory &other) noexcept {
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+  std::swap(m_mapped, other.m_mapped);
+  std::swap(m_mode, other.m_mode);
+}
+
+}; // namespace ttt::engine
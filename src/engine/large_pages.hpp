@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ttt::engine {
+
+// Pages which back a block of memory: HUGETLB pages are explicit huge pages
+// of the pool reserved by the administrator (MAP_HUGETLB), TRANSPARENT is
+// normal memory the kernel was asked to back by huge pages (MADV_HUGEPAGE).
+enum class PageMode { NORMAL, TRANSPARENT, HUGETLB };
+
+const char *to_string(PageMode mode);
+// Parses "normal", "transparent" or "huge" (HUGETLB).
+bool parse_page_mode(const char *text, PageMode &mode);
+
+// Largest page mode tried by the next allocations of search tables: huge
+// pages fall back to transparent ones and those to normal pages. The default
+// is transparent. Set it before creating players, tables which exist keep
+// their memory.
+void set_page_policy(PageMode policy);
+PageMode get_page_policy();
+
+const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+// Block of zeroed memory for large tables. The memory is written on
+// allocation, so its pages are mapped before the first search rather than on
+// the first touch under a move deadline. Blocks smaller than a huge page
+// always get normal pages.
+class PageMemory {
+  void *m_data = nullptr;
+  size_t m_size = 0;
+  size_t m_mapped = 0;
+  PageMode m_mode = PageMode::NORMAL;
+
+public:
+  PageMemory() = default;
+  PageMemory(size_t size, PageMode policy = get_page_policy()) {
+    allocate(size, policy);
+  }
+  PageMemory(const PageMemory &) = delete;
+  PageMemory &operator=(const PageMemory &) = delete;
+  PageMemory(PageMemory &&other) noexcept { swap(other); }
+  PageMemory &operator=(PageMemory &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~PageMemory() { release(); }
+
+  // Returns false if no memory could be allocated.
+  bool allocate(size_t size, PageMode policy = get_page_policy());
+  void release();
+  void swap(PageMemory &other) noexcept;
+
+  void *get_data() const { return m_data; }
+  size_t get_size() const { return m_size; }
+  PageMode get_mode() const { return m_mode; }
+};
+
+// Fixed-size array of trivially copyable objects in `PageMemory`, all bytes
+// of the objects are zero after allocation.
+template <class T> class PageArray {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "objects are copied and zeroed as bytes");
+
+  PageMemory m_memory;
+  size_t m_size = 0;
+
+public:
+  PageArray() = default;
+  explicit PageArray(size_t size, PageMode policy = get_page_policy())
+      : m_memory(size * sizeof(T), policy),
+        m_size(m_memory.get_data() ? size : 0) {}
+
+  T *data() const { return static_cast<T *>(m_memory.get_data()); }
+  size_t size() const { return m_size; }
+  T *begin() const { return data(); }
+  T *end() const { return data() + m_size; }
+  T &operator[](size_t i) const { return data()[i]; }
+  PageMode get_mode() const { return m_memory.get_mode(); }
+
+  void swap(PageArray &other) noexcept {
+    m_memory.swap(other.m_memory);
+    std::swap(m_size, other.m_size);
+  }
+};
+
+}; // namespace ttt::engine
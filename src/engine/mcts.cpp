@@ -0,0 +1,289 @@
+#include "mcts.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ttt::engine {
+
+// ordering bonuses of moves completing own and opponent lines
+static const int OWN_WIN_BONUS = 1 << 28;
+static const int BLOCK_BONUS = 1 << 27;
+// evaluation which makes a cut playout count as three quarters of a win
+static const double EVAL_SCALE = 256 / std::log(3.);
+// random cells tried by a playout move before scanning the field
+static const int RANDOM_ATTEMPTS = 16;
+
+// Positions with a known result: finished games and the LAST_MOVE reply.
+static bool is_decided(const Board &board) {
+  return board.is_over() || board.is_last_move();
+}
+
+// Result of a finished or cut playout for X: 1 for a win, 0 for a loss.
+static double score_of(const Board &board) {
+  const Outcome outcome = board.is_last_move() ? board.get_last_move_outcome()
+                                               : board.get_outcome();
+  switch (outcome) {
+  case Outcome::X_WINS:
+    return 1;
+  case Outcome::O_WINS:
+    return 0;
+  case Outcome::DRAW:
+    return 0.5;
+  case Outcome::NONE:
+    break;
+  }
+  return 1 / (1 + std::exp(-board.get_eval() / EVAL_SCALE));
+}
+
+Mcts::Mcts(const MctsParams &params)
+    : m_params(params), m_nodes(params.max_nodes), m_spare(params.max_nodes),
+      m_rng(params.seed | 1) {}
+
+uint64_t Mcts::_rand() {
+  // xorshift64*
+  m_rng ^= m_rng >> 12;
+  m_rng ^= m_rng << 25;
+  m_rng ^= m_rng >> 27;
+  return m_rng * 2685821657736338717ull;
+}
+
+void Mcts::reset(const Board &board) {
+  m_board = board;
+  m_used = 0;
+  m_root = NO_NODE;
+}
+
+uint32_t Mcts::_new_node(int cell) {
+  if (m_used == m_nodes.size())
+    return NO_NODE;
+  m_nodes[m_used] = {cell, NO_NODE, 0, false, 0, 0.f};
+  return m_used++;
+}
+
+void Mcts::advance(game::Point pt) {
+  if (!m_board)
+    return;
+  const int cell = m_board->index(pt.x, pt.y);
+  if (pt.x < 0 || pt.x >= m_board->get_cols() || pt.y < 0 ||
+      pt.y >= m_board->get_rows() || !m_board->is_empty(cell) ||
+      m_board->is_over()) {
+    m_board.reset();
+    m_root = NO_NODE;
+    return;
+  }
+  m_board->make(cell);
+  uint32_t next = NO_NODE;
+  if (m_root != NO_NODE) {
+    const Node &root = m_nodes[m_root];
+    for (int i = 0; i < root.n_children; ++i)
+      if (m_nodes[root.first_child + i].cell == cell)
+        next = root.first_child + i;
+  }
+  m_root = next;
+}
+
+void Mcts::_compact() {
+  // breadth first copy keeps the children of every node together
+  m_spare[0] = m_nodes[m_root];
+  size_t used = 1;
+  for (size_t i = 0; i < used; ++i) {
+    Node &node = m_spare[i];
+    if (node.n_children == 0)
+      continue;
+    std::copy(m_nodes.begin() + node.first_child,
+              m_nodes.begin() + node.first_child + node.n_children,
+              m_spare.begin() + used);
+    node.first_child = used;
+    used += node.n_children;
+  }
+  m_nodes.swap(m_spare);
+  m_used = used;
+  m_root = 0;
+}
+
+void Mcts::_expand(Node &node, Board &board) {
+  const int stm = board.get_side_to_move(), opp = 1 - stm;
+  m_moves.clear();
+  // O draws by completing own line, any other last reply loses
+  const int last_reply = board.is_last_move() ? board.find_winning_cell(1) : -1;
+  if (last_reply >= 0)
+    m_moves.emplace_back(0, last_reply);
+  const bool forced = board.get_threats(opp) > 0;
+  for (int y = 0; y < board.get_rows() && last_reply < 0; ++y) {
+    for (int x = 0; x < board.get_cols(); ++x) {
+      const int cell = board.index(x, y);
+      if (!board.is_empty(cell) || !board.has_neighbours(cell))
+        continue;
+      const bool own_win = board.is_winning_cell(cell, stm);
+      const bool block = board.is_winning_cell(cell, opp);
+      if (forced && !own_win && !block &&
+          !(stm == 1 && board.makes_threat(cell, stm)))
+        continue;
+      int score = board.get_move_gain(cell, stm);
+      if (own_win)
+        score += OWN_WIN_BONUS;
+      if (block)
+        score += BLOCK_BONUS;
+      m_moves.emplace_back(score, cell);
+    }
+  }
+  if (board.is_last_move() && m_moves.size() > 1)
+    m_moves.resize(1);
+  if (m_moves.empty()) {
+    // no stones on the field yet: the free cell closest to the centre
+    int best = -1, best_dist = 0;
+    for (int y = 0; y < board.get_rows(); ++y) {
+      for (int x = 0; x < board.get_cols(); ++x) {
+        const int cell = board.index(x, y);
+        const int dx = 2 * x + 1 - board.get_cols();
+        const int dy = 2 * y + 1 - board.get_rows();
+        if (board.is_empty(cell) &&
+            (best < 0 || dx * dx + dy * dy < best_dist)) {
+          best = cell;
+          best_dist = dx * dx + dy * dy;
+        }
+      }
+    }
+    if (best >= 0)
+      m_moves.emplace_back(0, best);
+  }
+  const size_t n = std::min<size_t>(m_moves.size(), m_params.max_children);
+  std::partial_sort(
+      m_moves.begin(), m_moves.begin() + n, m_moves.end(),
+      [](const auto &a, const auto &b) { return a.first > b.first; });
+  // a full arena leaves the node a leaf
+  if (n == 0 || m_used + n > m_nodes.size())
+    return;
+  node.expanded = true;
+  node.first_child = m_used;
+  node.n_children = n;
+  for (size_t i = 0; i < n; ++i)
+    _new_node(m_moves[i].second);
+}
+
+uint32_t Mcts::_select(const Node &node) const {
+  const double log_visits = std::log(double(node.visits) + 1);
+  uint32_t best = node.first_child;
+  double best_score = -1;
+  for (int i = 0; i < node.n_children; ++i) {
+    const Node &child = m_nodes[node.first_child + i];
+    // unvisited children are tried in the order of their static gain
+    if (child.visits == 0)
+      return node.first_child + i;
+    const double score =
+        child.value / child.visits +
+        m_params.exploration * std::sqrt(log_visits / child.visits);
+    if (score > best_score) {
+      best_score = score;
+      best = node.first_child + i;
+    }
+  }
+  return best;
+}
+
+// Plays until the end or the length limit: completes own lines, blocks
+// lines of the opponent and otherwise plays random cells next to stones.
+double Mcts::_playout(Board &board) {
+  int n_moves = 0;
+  for (; n_moves < m_params.max_playout_len && !is_decided(board);
+       ++n_moves) {
+    const int stm = board.get_side_to_move();
+    int cell = board.find_winning_cell(stm);
+    if (cell < 0)
+      cell = board.find_winning_cell(1 - stm);
+    for (int i = 0; cell < 0 && i < RANDOM_ATTEMPTS; ++i) {
+      const int x = _rand() % board.get_cols(), y = _rand() % board.get_rows();
+      const int c = board.index(x, y);
+      if (board.is_empty(c) && board.has_neighbours(c))
+        cell = c;
+    }
+    for (int y = 0; cell < 0 && y < board.get_rows(); ++y)
+      for (int x = 0; cell < 0 && x < board.get_cols(); ++x)
+        if (board.is_empty(board.index(x, y)))
+          cell = board.index(x, y);
+    if (cell < 0)
+      break;
+    board.make(cell);
+  }
+  const double score = score_of(board);
+  for (int i = 0; i < n_moves; ++i)
+    board.unmake();
+  return score;
+}
+
+MctsResult Mcts::run(const MctsLimits &limits) {
+  const auto start = Clock::now();
+  const auto deadline = start + std::chrono::milliseconds(limits.time_ms);
+  MctsResult result;
+  if (!m_board || m_board->is_over())
+    return result;
+  if (m_root != NO_NODE && m_used > m_nodes.size() / 2)
+    _compact();
+  if (m_root == NO_NODE) {
+    // the played move had no node: the previous tree is of no use
+    m_used = 0;
+    m_root = _new_node(-1);
+  }
+  result.reused_visits = m_nodes[m_root].visits;
+
+  Board board = *m_board;
+  const int root_side = board.get_side_to_move();
+  if (!m_nodes[m_root].expanded)
+    _expand(m_nodes[m_root], board);
+  const Node &root = m_nodes[m_root];
+  if (root.n_children == 0)
+    return result;
+
+  // a single reply needs no search
+  while (root.n_children > 1) {
+    if ((result.playouts & 63) == 0 && result.playouts > 0 &&
+        limits.time_ms > 0 && Clock::now() >= deadline)
+      break;
+    if (limits.playouts > 0 && result.playouts >= limits.playouts)
+      break;
+    m_path.clear();
+    m_path.push_back(m_root);
+    uint32_t node = m_root;
+    while (m_nodes[node].expanded && !is_decided(board)) {
+      node = _select(m_nodes[node]);
+      board.make(m_nodes[node].cell);
+      m_path.push_back(node);
+    }
+    // nodes get children on their second visit
+    if (!is_decided(board) && m_nodes[node].visits > 0) {
+      _expand(m_nodes[node], board);
+      if (m_nodes[node].expanded) {
+        node = _select(m_nodes[node]);
+        board.make(m_nodes[node].cell);
+        m_path.push_back(node);
+      }
+    }
+    const double x_score =
+        is_decided(board) ? score_of(board) : _playout(board);
+    for (size_t i = 0; i < m_path.size(); ++i) {
+      Node &n = m_nodes[m_path[i]];
+      ++n.visits;
+      // the move of a node at depth i is made by the side to move at i - 1
+      const bool x_moved = ((root_side + i - 1) & 1) == 0;
+      n.value += x_moved ? x_score : 1 - x_score;
+    }
+    for (size_t i = 1; i < m_path.size(); ++i)
+      board.unmake();
+    ++result.playouts;
+  }
+
+  uint32_t best = root.first_child;
+  for (int i = 1; i < root.n_children; ++i)
+    if (m_nodes[root.first_child + i].visits > m_nodes[best].visits)
+      best = root.first_child + i;
+  const Node &child = m_nodes[best];
+  result.move = {board.get_x(child.cell), board.get_y(child.cell)};
+  result.win_rate = child.visits > 0 ? child.value / child.visits : 0;
+  result.nodes = m_used;
+  result.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       Clock::now() - start)
+                       .count();
+  return result;
+}
+
+}; // namespace ttt::engine
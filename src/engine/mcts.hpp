@@ -0,0 +1,106 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+#include "large_pages.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ttt::engine {
+
+struct MctsParams {
+  // weight of the exploration term of UCT
+  double exploration = 1.0;
+  // number of best moves by static gain which get a child node
+  int max_children = 24;
+  // playouts longer than this are scored by the static evaluation
+  int max_playout_len = 60;
+  // capacity of the node arena
+  size_t max_nodes = 1 << 20;
+  uint64_t seed = 1;
+};
+
+// Zero values mean no limit.
+struct MctsLimits {
+  int time_ms = 0;
+  int64_t playouts = 0;
+};
+
+struct MctsResult {
+  game::Point move = {-1, -1};
+  // share of won playouts of the chosen move for the side to move
+  double win_rate = 0;
+  int64_t playouts = 0;
+  // visits of the root kept from the search of previous moves
+  int64_t reused_visits = 0;
+  size_t nodes = 0;
+  int time_ms = 0;
+};
+
+// Monte Carlo tree search with UCT selection and short tactical playouts.
+// The tree lives across moves: `advance` makes the subtree of the played
+// move the new root. Nodes are taken from an arena which is only emptied by
+// `reset`, when it fills up the tree of the root is compacted into a spare
+// arena. Playouts make and unmake moves on one working board, so the search
+// loop does not allocate memory.
+class Mcts {
+  using Clock = std::chrono::steady_clock;
+
+  static const uint32_t NO_NODE = UINT32_MAX;
+
+  struct Node {
+    int cell;
+    uint32_t first_child;
+    uint16_t n_children;
+    bool expanded;
+    uint32_t visits;
+    // sum of playout results for the side which made the move of the node
+    float value;
+  };
+
+  MctsParams m_params;
+  PageArray<Node> m_nodes;
+  PageArray<Node> m_spare;
+  size_t m_used = 0;
+  uint32_t m_root = NO_NODE;
+  // position of the root
+  std::optional<Board> m_board;
+  uint64_t m_rng;
+  std::vector<std::pair<int, int>> m_moves;
+  std::vector<uint32_t> m_path;
+
+public:
+  explicit Mcts(const MctsParams &params = {});
+
+  const MctsParams &get_params() const { return m_params; }
+
+  // Starts a new tree for the position.
+  void reset(const Board &board);
+  // Plays a move at the root, the subtree of the move is kept. A move to a
+  // taken cell or out of the field drops the tree.
+  void advance(game::Point pt);
+  // Whether the root is the position of the board.
+  bool is_synced(const Board &board) const {
+    return m_board && m_board->get_hash() == board.get_hash() &&
+           m_board->get_move_no() == board.get_move_no();
+  }
+  size_t get_nodes_used() const { return m_used; }
+  // Pages of the arenas, set by the page policy when the object is created.
+  PageMode get_page_mode() const { return m_nodes.get_mode(); }
+
+  MctsResult run(const MctsLimits &limits);
+
+private:
+  uint32_t _new_node(int cell);
+  void _expand(Node &node, Board &board);
+  uint32_t _select(const Node &node) const;
+  double _playout(Board &board);
+  void _compact();
+  uint64_t _rand();
+};
+
+}; // namespace ttt::engine
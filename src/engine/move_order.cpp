@@ -0,0 +1,95 @@
+#include "move_order.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ttt::engine {
+
+void list_candidates(const Board &board, std::vector<int> &cells) {
+  cells.clear();
+  if (board.get_masks().is_valid()) {
+    for_each_candidate(board.get_masks(), CandidateOpts(), [&](int x, int y) {
+      cells.push_back(board.index(x, y));
+    });
+    return;
+  }
+  for (int y = 0; y < board.get_rows(); ++y) {
+    for (int x = 0; x < board.get_cols(); ++x) {
+      const int cell = board.index(x, y);
+      if (board.is_empty(cell) && board.has_neighbours(cell))
+        cells.push_back(cell);
+    }
+  }
+  if (!cells.empty())
+    return;
+  for (int y = 0; y < board.get_rows(); ++y) {
+    for (int x = 0; x < board.get_cols(); ++x) {
+      const int cell = board.index(x, y);
+      if (board.is_empty(cell))
+        cells.push_back(cell);
+    }
+  }
+}
+
+void MoveOrder::prepare(const Board &board) {
+  const uint64_t layout = board.get_geometry().layout_key;
+  if (board.get_cells_num() != m_n_cells || layout != m_layout) {
+    m_n_cells = board.get_cells_num();
+    m_layout = layout;
+    clear();
+  } else {
+    age();
+  }
+}
+
+void MoveOrder::clear() {
+  for (int side = 0; side < 2; ++side) {
+    m_history[side].assign(m_n_cells, 0);
+    m_counter[side].assign(m_n_cells, -1);
+  }
+  std::fill(m_killers.begin(), m_killers.end(), std::array<int, 2>{-1, -1});
+}
+
+void MoveOrder::age() {
+  for (int side = 0; side < 2; ++side)
+    for (int &h : m_history[side])
+      h /= 2;
+  std::fill(m_killers.begin(), m_killers.end(), std::array<int, 2>{-1, -1});
+}
+
+// The bonus is damped as the score approaches the bound, so the scores of
+// frequent moves do not saturate and new cutoffs still change the order.
+void MoveOrder::_add_history(int side, int cell, int bonus) {
+  int &h = m_history[side][cell];
+  h += bonus - h * std::abs(bonus) / MAX_HISTORY;
+}
+
+void MoveOrder::add_cutoff(int side, int ply, int cell, int prev_cell,
+                           int depth) {
+  _add_history(side, cell, std::min(depth * depth, int(MAX_HISTORY)));
+  if (ply < int(m_killers.size())) {
+    auto &killers = m_killers[ply];
+    if (killers[0] != cell) {
+      killers[1] = killers[0];
+      killers[0] = cell;
+    }
+  }
+  if (prev_cell >= 0)
+    m_counter[side][prev_cell] = cell;
+}
+
+void MoveOrder::add_miss(int side, int cell, int depth) {
+  _add_history(side, cell, -std::min(depth * depth, int(MAX_HISTORY)));
+}
+
+int MoveOrder::get_score(int side, int ply, int cell, int prev_cell) const {
+  int score = m_history[side][cell] / HISTORY_DIVISOR;
+  if (ply < int(m_killers.size()) &&
+      (m_killers[ply][0] == cell || m_killers[ply][1] == cell))
+    score += KILLER_BONUS;
+  if (prev_cell >= 0 && m_counter[side][prev_cell] == cell)
+    score += COUNTER_BONUS;
+  return score;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ttt::engine {
+
+// Empty cells worth searching: cells near stones (see `Board::has_neighbours`)
+// or, when there are none, every empty cell. They come from the masks
+// of the board, fields too large for masks are scanned cell by cell.
+void list_candidates(const Board &board, std::vector<int> &cells);
+
+// Ordering bonus of a cell on a field without stones: cells close to the
+// centre come first.
+inline int centre_score(const Board &board, int cell) {
+  const int dx = 2 * board.get_x(cell) + 1 - board.get_cols();
+  const int dy = 2 * board.get_y(cell) + 1 - board.get_rows();
+  return -(dx * dx + dy * dy);
+}
+
+// Move ordering tables of an alpha-beta search, learnt from the moves which
+// cut off nodes: history scores of every side and cell, two killer moves per
+// ply and the counter-move of every side to the last move of the opponent.
+// Only quiet moves, which neither complete nor block a line, are recorded.
+//
+// The owner calls `prepare` before every search: the tables are cleared for
+// a board with other dimensions and aged otherwise, so the results of the
+// previous moves and games count less. One object is used by one search.
+class MoveOrder {
+public:
+  static const int KILLER_BONUS = 16384;
+  static const int COUNTER_BONUS = 8192;
+  // history scores stay in [-MAX_HISTORY, MAX_HISTORY]
+  static const int MAX_HISTORY = 1 << 14;
+  // the ordering bonus of history is the score divided by this
+  static const int HISTORY_DIVISOR = 2;
+
+private:
+  int m_n_cells = 0;
+  uint64_t m_layout = 0;
+  std::vector<int> m_history[2];
+  // -1 when there is no counter-move
+  std::vector<int> m_counter[2];
+  std::vector<std::array<int, 2>> m_killers;
+
+public:
+  explicit MoveOrder(int max_ply = 128) : m_killers(max_ply, {-1, -1}) {}
+
+  // Clears the tables for a new field and ages them for a new move.
+  void prepare(const Board &board);
+  void clear();
+  // History scores are halved, killers are forgotten as they belong to other
+  // plies; counter-moves are kept until a new cutoff replaces them.
+  void age();
+
+  // `cell` cut off the node at `ply` searched to `depth`, the opponent's
+  // last move was `prev_cell` (-1 if none).
+  void add_cutoff(int side, int ply, int cell, int prev_cell, int depth);
+  // A quiet move searched before the one which cut off the node.
+  void add_miss(int side, int cell, int depth);
+
+  int get_history(int side, int cell) const { return m_history[side][cell]; }
+  int get_killer(int ply, int i) const { return m_killers[ply][i]; }
+  int get_counter(int side, int prev_cell) const {
+    return prev_cell < 0 ? -1 : m_counter[side][prev_cell];
+  }
+  // Ordering bonus of a quiet move.
+  int get_score(int side, int ply, int cell, int prev_cell) const;
+
+private:
+  void _add_history(int side, int cell, int bonus);
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,196 @@
+#include "nnue.hpp"
+
+#include "board.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ttt::engine {
+
+namespace {
+
+size_t network_size(const NetworkHeader &hdr) {
+  const size_t n_features = 3 * size_t(hdr.rows) * hdr.cols;
+  return sizeof(NetworkHeader) +
+         (n_features + 2) * hdr.hidden * sizeof(int16_t) + sizeof(int32_t);
+}
+
+void add_feature_scalar(const int16_t *src, int16_t *dst, const int16_t *w,
+                        int n) {
+  for (int i = 0; i < n; ++i)
+    dst[i] = int16_t(src[i] + w[i]);
+}
+
+int32_t output_scalar(const int16_t *acc, const int16_t *w2, int n) {
+  int32_t sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += std::clamp<int>(acc[i], 0, NNUE_QA) * w2[i];
+  return sum;
+}
+
+#ifdef TTT_X86_SIMD
+
+TTT_TARGET_AVX2 void add_feature_avx2(const int16_t *src, int16_t *dst,
+                                      const int16_t *w, int n) {
+  for (int i = 0; i < n; i += 16) {
+    const __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(w + i));
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_add_epi16(a, b));
+  }
+}
+
+TTT_TARGET_AVX2 int32_t output_avx2(const int16_t *acc, const int16_t *w2,
+                                    int n) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi16(NNUE_QA);
+  __m256i sum = _mm256_setzero_si256();
+  for (int i = 0; i < n; i += 16) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+    a = _mm256_min_epi16(_mm256_max_epi16(a, zero), one);
+    const __m256i w = _mm256_loadu_si256((const __m256i *)(w2 + i));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w));
+  }
+  alignas(32) int32_t lanes[8];
+  _mm256_store_si256((__m256i *)lanes, sum);
+  int32_t total = 0;
+  for (int32_t lane : lanes)
+    total += lane;
+  return total;
+}
+
+#endif
+
+}; // namespace
+
+Network::Network() : m_isa(get_best_isa()) {}
+
+Network::~Network() { close(); }
+
+bool Network::open(const char *path, const char **error) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    if (error)
+      *error = "cannot open network";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(NetworkHeader)) {
+    ::close(fd);
+    if (error)
+      *error = "network is too small";
+    return false;
+  }
+  m_size = st.st_size;
+  void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    if (error)
+      *error = "cannot map network";
+    return false;
+  }
+  m_data = static_cast<const char *>(data);
+  m_mapped = true;
+  return _parse(error);
+}
+
+bool Network::assign(const char *data, size_t size, const char **error) {
+  close();
+  if (size < sizeof(NetworkHeader)) {
+    if (error)
+      *error = "network is too small";
+    return false;
+  }
+  char *copy = new char[size];
+  std::memcpy(copy, data, size);
+  m_data = copy;
+  m_size = size;
+  return _parse(error);
+}
+
+void Network::close() {
+  if (m_mapped)
+    munmap(const_cast<char *>(m_data), m_size);
+  else
+    delete[] m_data;
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped = false;
+  m_header = {};
+  m_w1 = m_b1 = m_w2 = nullptr;
+  m_b2 = 0;
+}
+
+bool Network::_parse(const char **error) {
+  const char *bad = nullptr;
+  std::memcpy(&m_header, m_data, sizeof(m_header));
+  if (std::memcmp(m_header.magic, NETWORK_MAGIC, sizeof(NETWORK_MAGIC)) != 0)
+    bad = "bad network magic";
+  else if (m_header.version != NETWORK_VERSION)
+    bad = "unsupported network version";
+  else if (m_header.rows == 0 || m_header.cols == 0 ||
+           m_header.hidden == 0 || m_header.hidden % 16 != 0)
+    bad = "bad network dimensions";
+  else if (m_size != network_size(m_header))
+    bad = "network size does not match its dimensions";
+  if (bad) {
+    close();
+    if (error)
+      *error = bad;
+    return false;
+  }
+  m_w1 = reinterpret_cast<const int16_t *>(m_data + sizeof(m_header));
+  m_b1 = m_w1 + size_t(get_features_num()) * m_header.hidden;
+  m_w2 = m_b1 + m_header.hidden;
+  std::memcpy(&m_b2, m_w2 + m_header.hidden, sizeof(m_b2));
+  return true;
+}
+
+void Network::set_isa(SimdIsa isa) { m_isa = std::min(isa, get_best_isa()); }
+
+bool Network::fits(const Board &board) const {
+  return m_data && board.get_rows() == m_header.rows &&
+         board.get_cols() == m_header.cols &&
+         board.get_win_len() == m_header.win_len;
+}
+
+void Network::refresh(const Board &board, int16_t *acc) const {
+  std::memcpy(acc, m_b1, m_header.hidden * sizeof(int16_t));
+  for (int y = 0; y < m_header.rows; ++y) {
+    for (int x = 0; x < m_header.cols; ++x) {
+      const uint8_t cell = board.at(board.index(x, y));
+      if (cell != EMPTY)
+        add_feature(acc, acc, get_feature(x, y, cell - 1));
+    }
+  }
+}
+
+void Network::add_feature(const int16_t *src, int16_t *dst,
+                          int feature) const {
+  const int16_t *w = m_w1 + size_t(feature) * m_header.hidden;
+#ifdef TTT_X86_SIMD
+  if (m_isa == SimdIsa::AVX2) {
+    add_feature_avx2(src, dst, w, m_header.hidden);
+    return;
+  }
+#endif
+  add_feature_scalar(src, dst, w, m_header.hidden);
+}
+
+int Network::evaluate(const int16_t *acc) const {
+  int32_t sum;
+#ifdef TTT_X86_SIMD
+  if (m_isa == SimdIsa::AVX2)
+    sum = output_avx2(acc, m_w2, m_header.hidden);
+  else
+#endif
+    sum = output_scalar(acc, m_w2, m_header.hidden);
+  return int64_t(sum + m_b2) * NNUE_EVAL_SCALE / (NNUE_QA * NNUE_QB);
+}
+
+}; // namespace ttt::engine
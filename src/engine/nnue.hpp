@@ -0,0 +1,101 @@
+#pragma once
+
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ttt::engine {
+
+class Board;
+
+/*
+  Network file layout (all integers are little-endian):
+
+    NetworkHeader
+    int16 w1[n_features][hidden]   first layer, one column per feature
+    int16 b1[hidden]
+    int16 w2[hidden]               output layer
+    int32 b2
+
+  Features are the cells of the field times the kind of their content:
+  feature (y * cols + x) * 3 + kind for X (kind 0), O (1) and a wall (2).
+  Empty cells have no features, so a move adds one column of the first layer
+  to the accumulator. The first layer is scaled by NNUE_QA, its outputs are
+  clipped to [0, NNUE_QA], the output layer is scaled by NNUE_QB and its
+  result by NNUE_QA * NNUE_QB is the logit of the win probability of X.
+*/
+
+static const char NETWORK_MAGIC[8] = {'T', 'T', 'T', 'N', 'N', 'U', 'E', '1'};
+static const uint32_t NETWORK_VERSION = 1;
+
+struct NetworkHeader {
+  char magic[8];
+  uint32_t version;
+  uint16_t rows;
+  uint16_t cols;
+  uint16_t win_len;
+  uint16_t hidden; // multiple of 16
+  uint32_t reserved;
+};
+
+const int NNUE_QA = 64;
+const int NNUE_QB = 64;
+// evaluation units per unit of the logit, the scale at which MCTS turns the
+// static evaluation into a win probability
+const int NNUE_EVAL_SCALE = 233;
+
+// Weights of a network for one field size, mapped from a file or copied
+// from memory. A network is read-only after loading and can be shared by
+// any number of boards and threads.
+class Network {
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  bool m_mapped = false;
+  NetworkHeader m_header = {};
+  const int16_t *m_w1 = nullptr;
+  const int16_t *m_b1 = nullptr;
+  const int16_t *m_w2 = nullptr;
+  int32_t m_b2 = 0;
+  SimdIsa m_isa;
+
+public:
+  Network();
+  Network(const Network &) = delete;
+  Network &operator=(const Network &) = delete;
+  ~Network();
+
+  // Maps the weights file into memory.
+  bool open(const char *path, const char **error = nullptr);
+  // Copies weights in the file layout, for example made by the trainer.
+  bool assign(const char *data, size_t size, const char **error = nullptr);
+  void close();
+
+  int get_rows() const { return m_header.rows; }
+  int get_cols() const { return m_header.cols; }
+  int get_win_len() const { return m_header.win_len; }
+  int get_hidden() const { return m_header.hidden; }
+  int get_features_num() const { return 3 * m_header.rows * m_header.cols; }
+  int get_feature(int x, int y, int kind) const {
+    return (y * m_header.cols + x) * 3 + kind;
+  }
+
+  // The instruction set is clamped to the ones the CPU supports, only AVX2
+  // has a vectorised path.
+  void set_isa(SimdIsa isa);
+  SimdIsa get_isa() const { return m_isa; }
+
+  // Whether the network was trained for the field of the board.
+  bool fits(const Board &board) const;
+  // Accumulator of a board from scratch: the biases and every stone and wall.
+  void refresh(const Board &board, int16_t *acc) const;
+  // `dst` is `src` with one more feature.
+  void add_feature(const int16_t *src, int16_t *dst, int feature) const;
+  // Evaluation from X point of view in the units of `Board::get_eval`.
+  int evaluate(const int16_t *acc) const;
+
+private:
+  bool _parse(const char **error);
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,195 @@
+#include "nnue_train.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace ttt::engine {
+
+// bound of the first layer biases, in units of the clipped activation
+static const float B1_LIMIT = 4;
+// headroom of the int16 accumulator for the biases and rounding
+static const int ACC_LIMIT = 32767 - int(B1_LIMIT) * NNUE_QA - 1024;
+
+static float sigmoid(float x) { return 1 / (1 + std::exp(-x)); }
+
+static int16_t quantize_weight(float w, float scale) {
+  return int16_t(std::clamp(std::lround(w * scale), -32767l, 32767l));
+}
+
+NetworkTrainer::NetworkTrainer(int rows, int cols, int win_len, int hidden,
+                               uint64_t seed)
+    : m_rows(rows), m_cols(cols), m_win_len(win_len),
+      m_hidden((std::max(hidden, 1) + 15) / 16 * 16), m_rng(seed) {
+  // every cell of the field can have a feature, together they must not
+  // overflow the quantised accumulator
+  m_w1_limit = std::min(2.f, float(ACC_LIMIT) / (NNUE_QA * rows * cols));
+  const int n_features = 3 * rows * cols;
+  std::uniform_real_distribution<float> w1(-0.1f, 0.1f);
+  std::uniform_real_distribution<float> w2(-1.f, 1.f);
+  m_w1.resize(size_t(n_features) * m_hidden);
+  for (float &w : m_w1)
+    w = std::clamp(w1(m_rng), -m_w1_limit, m_w1_limit);
+  m_b1.assign(m_hidden, 0.5f);
+  m_w2.resize(m_hidden);
+  for (float &w : m_w2)
+    w = w2(m_rng) / std::sqrt(float(m_hidden));
+  m_hidden_out.resize(m_hidden);
+  m_hidden_grad.resize(m_hidden);
+  m_begin.push_back(0);
+}
+
+bool NetworkTrainer::fits(const Board &board) const {
+  return board.get_rows() == m_rows && board.get_cols() == m_cols &&
+         board.get_win_len() == m_win_len;
+}
+
+// Bit 0 of `flip` mirrors the columns and bit 1 the rows, the rules do not
+// change under either.
+void NetworkTrainer::_features(const Board &board, int flip,
+                               std::vector<int> &out) const {
+  out.clear();
+  for (int y = 0; y < m_rows; ++y) {
+    for (int x = 0; x < m_cols; ++x) {
+      const uint8_t cell = board.at(board.index(x, y));
+      if (cell == EMPTY)
+        continue;
+      const int fx = flip & 1 ? m_cols - 1 - x : x;
+      const int fy = flip & 2 ? m_rows - 1 - y : y;
+      out.push_back((fy * m_cols + fx) * 3 + cell - 1);
+    }
+  }
+}
+
+void NetworkTrainer::add_position(const Board &board, float target,
+                                  bool mirrors) {
+  std::vector<int> features;
+  for (int flip = 0; flip < (mirrors ? 4 : 1); ++flip) {
+    _features(board, flip, features);
+    m_features.insert(m_features.end(), features.begin(), features.end());
+    m_begin.push_back(m_features.size());
+    m_targets.push_back(target);
+  }
+}
+
+void NetworkTrainer::split(double validation) {
+  const size_t n = m_targets.size();
+  m_order.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    m_order[i] = i;
+  std::shuffle(m_order.begin(), m_order.end(), m_rng);
+  m_n_train = n - size_t(n * std::clamp(validation, 0., 1.));
+}
+
+float NetworkTrainer::_forward(const uint32_t *features, int n) {
+  float *h = m_hidden_out.data();
+  std::copy(m_b1.begin(), m_b1.end(), h);
+  for (int i = 0; i < n; ++i) {
+    const float *w = m_w1.data() + size_t(features[i]) * m_hidden;
+    for (int j = 0; j < m_hidden; ++j)
+      h[j] += w[j];
+  }
+  float out = m_b2;
+  for (int j = 0; j < m_hidden; ++j)
+    out += std::clamp(h[j], 0.f, 1.f) * m_w2[j];
+  return out;
+}
+
+void NetworkTrainer::_backward(const uint32_t *features, int n, float grad,
+                               float lr) {
+  const float *h = m_hidden_out.data();
+  float *grad_h = m_hidden_grad.data();
+  for (int j = 0; j < m_hidden; ++j) {
+    const bool active = h[j] > 0 && h[j] < 1;
+    grad_h[j] = active ? lr * grad * m_w2[j] : 0;
+    m_w2[j] -= lr * grad * std::clamp(h[j], 0.f, 1.f);
+    m_w2[j] = std::clamp(m_w2[j], -500.f, 500.f);
+    m_b1[j] = std::clamp(m_b1[j] - grad_h[j], -B1_LIMIT, B1_LIMIT);
+  }
+  m_b2 -= lr * grad;
+  for (int i = 0; i < n; ++i) {
+    float *w = m_w1.data() + size_t(features[i]) * m_hidden;
+    for (int j = 0; j < m_hidden; ++j)
+      w[j] = std::clamp(w[j] - grad_h[j], -m_w1_limit, m_w1_limit);
+  }
+}
+
+double NetworkTrainer::train_epoch(float learning_rate) {
+  if (m_order.size() != m_targets.size())
+    split(0);
+  std::shuffle(m_order.begin(), m_order.begin() + m_n_train, m_rng);
+  double loss = 0;
+  for (size_t k = 0; k < m_n_train; ++k) {
+    const uint32_t i = m_order[k];
+    const uint32_t *features = m_features.data() + m_begin[i];
+    const int n = m_begin[i + 1] - m_begin[i];
+    const float p = sigmoid(_forward(features, n));
+    const float error = p - m_targets[i];
+    loss += error * error;
+    _backward(features, n, 2 * error * p * (1 - p), learning_rate);
+  }
+  return m_n_train ? loss / m_n_train : 0;
+}
+
+double NetworkTrainer::get_validation_loss() {
+  if (m_order.size() != m_targets.size())
+    split(0);
+  double loss = 0;
+  for (size_t k = m_n_train; k < m_order.size(); ++k) {
+    const uint32_t i = m_order[k];
+    const float p = sigmoid(_forward(m_features.data() + m_begin[i],
+                                     m_begin[i + 1] - m_begin[i]));
+    loss += (p - m_targets[i]) * (p - m_targets[i]);
+  }
+  const size_t n = m_order.size() - m_n_train;
+  return n ? loss / n : 0;
+}
+
+float NetworkTrainer::predict(const Board &board) {
+  std::vector<int> features;
+  _features(board, 0, features);
+  const std::vector<uint32_t> f(features.begin(), features.end());
+  return sigmoid(_forward(f.data(), f.size()));
+}
+
+std::vector<char> NetworkTrainer::quantize() const {
+  NetworkHeader hdr{};
+  std::memcpy(hdr.magic, NETWORK_MAGIC, sizeof(hdr.magic));
+  hdr.version = NETWORK_VERSION;
+  hdr.rows = m_rows;
+  hdr.cols = m_cols;
+  hdr.win_len = m_win_len;
+  hdr.hidden = m_hidden;
+  std::vector<int16_t> weights;
+  weights.reserve(m_w1.size() + 2 * m_hidden);
+  for (float w : m_w1)
+    weights.push_back(quantize_weight(w, NNUE_QA));
+  for (float b : m_b1)
+    weights.push_back(quantize_weight(b, NNUE_QA));
+  for (float w : m_w2)
+    weights.push_back(quantize_weight(w, NNUE_QB));
+  const int32_t b2 = std::lround(m_b2 * NNUE_QA * NNUE_QB);
+
+  std::vector<char> data(sizeof(hdr) + weights.size() * sizeof(int16_t) +
+                         sizeof(b2));
+  char *out = data.data();
+  std::memcpy(out, &hdr, sizeof(hdr));
+  out += sizeof(hdr);
+  std::memcpy(out, weights.data(), weights.size() * sizeof(int16_t));
+  out += weights.size() * sizeof(int16_t);
+  std::memcpy(out, &b2, sizeof(b2));
+  return data;
+}
+
+bool NetworkTrainer::save(const char *path) const {
+  const std::vector<char> data = quantize();
+  std::FILE *file = std::fopen(path, "wb");
+  if (!file)
+    return false;
+  const bool ok =
+      std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  return std::fclose(file) == 0 && ok;
+}
+
+}; // namespace ttt::engine
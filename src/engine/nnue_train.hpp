@@ -0,0 +1,72 @@
+#pragma once
+
+#include "board.hpp"
+#include "nnue.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ttt::engine {
+
+// Trainer of `Network` weights on CPU. Positions are stored as lists of
+// active features with a target win probability of X, the network is
+// trained in floats by plain SGD on the squared error of the sigmoid of the
+// output and quantised on saving. The first layer weights are kept in the
+// range where the int16 accumulators cannot overflow on the field.
+class NetworkTrainer {
+  int m_rows;
+  int m_cols;
+  int m_win_len;
+  int m_hidden;
+  std::mt19937_64 m_rng;
+  std::vector<float> m_w1;
+  std::vector<float> m_b1;
+  std::vector<float> m_w2;
+  float m_b2 = 0;
+  // bound of the first layer weights
+  float m_w1_limit;
+  // features of sample i are m_features[m_begin[i]] .. m_features[m_begin[i+1]]
+  std::vector<uint32_t> m_features;
+  std::vector<uint32_t> m_begin;
+  std::vector<float> m_targets;
+  std::vector<uint32_t> m_order;
+  // the first samples are trained on, the rest are for validation
+  size_t m_n_train = 0;
+  std::vector<float> m_hidden_out;
+  std::vector<float> m_hidden_grad;
+
+public:
+  // `hidden` is rounded up to a multiple of 16.
+  NetworkTrainer(int rows, int cols, int win_len, int hidden,
+                 uint64_t seed = 1);
+
+  int get_hidden() const { return m_hidden; }
+  bool fits(const Board &board) const;
+
+  // Adds the position of the board with the win probability of X, with
+  // `mirrors` also its three reflections.
+  void add_position(const Board &board, float target, bool mirrors = true);
+  size_t get_samples_num() const { return m_targets.size(); }
+  // Shuffles the samples and leaves the fraction of them for validation.
+  void split(double validation);
+  size_t get_train_num() const { return m_n_train; }
+
+  // One pass over the training samples, returns their mean loss.
+  double train_epoch(float learning_rate);
+  // Mean loss of the validation samples.
+  double get_validation_loss();
+  // Win probability of X by the float network.
+  float predict(const Board &board);
+
+  // Quantised weights in the layout of the network file.
+  std::vector<char> quantize() const;
+  bool save(const char *path) const;
+
+private:
+  void _features(const Board &board, int flip, std::vector<int> &out) const;
+  float _forward(const uint32_t *features, int n);
+  void _backward(const uint32_t *features, int n, float grad, float lr);
+};
+
+}; // namespace ttt::engine
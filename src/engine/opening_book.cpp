@@ -0,0 +1,249 @@
+#include "opening_book.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ttt::engine {
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Bit 2 of a symmetry transposes the field, bits 0 and 1 mirror the columns
+// and the rows after it.
+Point apply_symmetry(int symmetry, Point p, int rows, int cols) {
+  if (symmetry & 4)
+    std::swap(p.x, p.y);
+  if (symmetry & 1)
+    p.x = cols - 1 - p.x;
+  if (symmetry & 2)
+    p.y = rows - 1 - p.y;
+  return p;
+}
+
+Point invert_symmetry(int symmetry, Point p, int rows, int cols) {
+  if (symmetry & 1)
+    p.x = cols - 1 - p.x;
+  if (symmetry & 2)
+    p.y = rows - 1 - p.y;
+  if (symmetry & 4)
+    std::swap(p.x, p.y);
+  return p;
+}
+
+// The window is symmetric around the centre, so a symmetry of the field maps
+// it onto itself.
+bool in_window(int x, int y, const State::Opts &opts, int radius) {
+  return std::abs(2 * x - (opts.cols - 1)) <= 2 * radius + 1 &&
+         std::abs(2 * y - (opts.rows - 1)) <= 2 * radius + 1;
+}
+
+uint32_t pack(Point p) { return uint32_t(p.y) << 16 | uint32_t(p.x); }
+
+}; // namespace
+
+BookKey make_book_key(const State &state, int radius) {
+  const auto &opts = state.get_opts();
+  BookKey result;
+  int n_stones = 0;
+  for (int y = 0; y < opts.rows; ++y) {
+    for (int x = 0; x < opts.cols; ++x) {
+      const Sign sign = state.get_value(x, y);
+      if (sign != Sign::X && sign != Sign::O)
+        continue;
+      if (!in_window(x, y, opts, radius))
+        return result;
+      ++n_stones;
+    }
+  }
+  const uint64_t base = mix(uint64_t(opts.rows) << 40 ^
+                            uint64_t(opts.cols) << 24 ^
+                            uint64_t(opts.win_len) << 8 ^ uint64_t(radius));
+  const int n_symmetries = opts.rows == opts.cols ? 8 : 4;
+  for (int s = 0; s < n_symmetries; ++s) {
+    uint64_t key = base ^ mix(n_stones);
+    for (int y = 0; y < opts.rows; ++y) {
+      for (int x = 0; x < opts.cols; ++x) {
+        const Sign sign = state.get_value(x, y);
+        if (sign == Sign::NONE || !in_window(x, y, opts, radius))
+          continue;
+        const Point p = apply_symmetry(s, {x, y}, opts.rows, opts.cols);
+        key ^= mix(uint64_t(pack(p)) << 2 | uint64_t(sign));
+      }
+    }
+    if (!result.valid || key < result.key) {
+      result.key = key;
+      result.symmetry = s;
+      result.valid = true;
+    }
+  }
+  return result;
+}
+
+bool BookBuilder::add_move(const State &state, Point move, double result) {
+  const auto &opts = state.get_opts();
+  if (!in_window(move.x, move.y, opts, m_radius))
+    return false;
+  const BookKey key = make_book_key(state, m_radius);
+  if (!key.valid)
+    return false;
+  const Point p = apply_symmetry(key.symmetry, move, opts.rows, opts.cols);
+  BookEntry &entry = m_entries[{key.key, pack(p)}];
+  entry.key = key.key;
+  entry.x = p.x;
+  entry.y = p.y;
+  ++entry.games;
+  entry.wins += result > 0.75;
+  entry.draws += result > 0.25 && result <= 0.75;
+  ++m_positions;
+  return true;
+}
+
+void BookBuilder::merge(const BookBuilder &other) {
+  for (const auto &[id, src] : other.m_entries) {
+    BookEntry &entry = m_entries[id];
+    entry.key = src.key;
+    entry.x = src.x;
+    entry.y = src.y;
+    entry.games += src.games;
+    entry.wins += src.wins;
+    entry.draws += src.draws;
+  }
+  m_positions += other.m_positions;
+}
+
+bool BookBuilder::save(const char *path, uint32_t min_games) const {
+  std::vector<BookEntry> entries;
+  for (const auto &item : m_entries)
+    if (item.second.games >= min_games)
+      entries.push_back(item.second);
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const BookEntry &a, const BookEntry &b) {
+                     if (a.key != b.key)
+                       return a.key < b.key;
+                     return a.games > b.games;
+                   });
+  BookHeader hdr{};
+  std::memcpy(hdr.magic, BOOK_MAGIC, sizeof(hdr.magic));
+  hdr.version = BOOK_VERSION;
+  hdr.radius = m_radius;
+  hdr.n_entries = entries.size();
+  std::FILE *file = std::fopen(path, "wb");
+  if (!file)
+    return false;
+  bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+  ok = ok && std::fwrite(entries.data(), sizeof(BookEntry), entries.size(),
+                         file) == entries.size();
+  return std::fclose(file) == 0 && ok;
+}
+
+OpeningBook::~OpeningBook() { close(); }
+
+bool OpeningBook::open(const char *path, const char **error) {
+  close();
+  const char *bad = nullptr;
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    if (error)
+      *error = "cannot open book";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(BookHeader)) {
+    ::close(fd);
+    if (error)
+      *error = "book is too small";
+    return false;
+  }
+  m_size = st.st_size;
+  void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    if (error)
+      *error = "cannot map book";
+    return false;
+  }
+  m_data = static_cast<const char *>(data);
+  const auto *hdr = reinterpret_cast<const BookHeader *>(m_data);
+  if (std::memcmp(hdr->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0)
+    bad = "bad book magic";
+  else if (hdr->version != BOOK_VERSION)
+    bad = "unsupported book version";
+  else if (m_size != sizeof(BookHeader) + hdr->n_entries * sizeof(BookEntry))
+    bad = "book size does not match its entries";
+  if (bad) {
+    close();
+    if (error)
+      *error = bad;
+    return false;
+  }
+  m_radius = hdr->radius;
+  m_n_entries = hdr->n_entries;
+  m_entries = reinterpret_cast<const BookEntry *>(hdr + 1);
+  return true;
+}
+
+void OpeningBook::close() {
+  if (m_data)
+    munmap(const_cast<char *>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+  m_entries = nullptr;
+  m_n_entries = 0;
+  m_radius = 0;
+}
+
+void OpeningBook::probe(const State &state,
+                        std::vector<BookMove> &moves) const {
+  moves.clear();
+  if (!m_data)
+    return;
+  const BookKey key = make_book_key(state, m_radius);
+  if (!key.valid)
+    return;
+  const auto &opts = state.get_opts();
+  const BookEntry *end = m_entries + m_n_entries;
+  const BookEntry *it = std::lower_bound(
+      m_entries, end, key.key,
+      [](const BookEntry &entry, uint64_t k) { return entry.key < k; });
+  for (; it != end && it->key == key.key; ++it) {
+    const Point p =
+        invert_symmetry(key.symmetry, {it->x, it->y}, opts.rows, opts.cols);
+    // a hash collision may point at an occupied cell
+    if (p.x < 0 || p.x >= opts.cols || p.y < 0 || p.y >= opts.rows ||
+        state.get_value(p.x, p.y) != Sign::NONE)
+      continue;
+    moves.push_back({p, it->games, it->wins, it->draws});
+  }
+}
+
+bool OpeningBook::find_move(const State &state, Point &move,
+                            uint32_t min_games) const {
+  std::vector<BookMove> moves;
+  probe(state, moves);
+  const BookMove *best = nullptr;
+  for (const BookMove &m : moves) {
+    if (m.games < min_games)
+      continue;
+    if (!best || m.get_score() > best->get_score())
+      best = &m;
+  }
+  if (!best)
+    return false;
+  move = best->move;
+  return true;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::Point;
+using game::Sign;
+using game::State;
+
+/*
+  Opening book file layout (all integers are little-endian):
+
+    BookHeader
+    BookEntry[n_entries]   sorted by key, then by games in descending order
+
+  A position is in the book only while all its stones are inside the window
+  of cells at most `radius` from the centre of the field. The key is the hash
+  of the field options and of the window content, stones and walls, minimised
+  over the symmetries of the field (four reflections, eight with rotations on
+  a square field); walls outside the window are ignored. Moves are stored in
+  the coordinates of the symmetry with the minimal hash.
+*/
+
+static const char BOOK_MAGIC[8] = {'T', 'T', 'T', 'B', 'O', 'O', 'K', '1'};
+static const uint32_t BOOK_VERSION = 1;
+
+struct BookHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t radius;
+  uint64_t n_entries;
+};
+
+struct BookEntry {
+  uint64_t key;
+  uint16_t x;
+  uint16_t y;
+  // results of the move for the side which makes it
+  uint32_t games;
+  uint32_t wins;
+  uint32_t draws;
+};
+
+// Key of a position with the symmetry which maps it to the book coordinates.
+struct BookKey {
+  uint64_t key = 0;
+  int symmetry = 0;
+  // false when a stone is outside the window
+  bool valid = false;
+};
+
+struct BookMove {
+  Point move;
+  uint32_t games;
+  uint32_t wins;
+  uint32_t draws;
+
+  // mean result for the side to move, a draw counts half
+  double get_score() const {
+    return games ? (wins + 0.5 * draws) / games : 0;
+  }
+};
+
+BookKey make_book_key(const State &state, int radius);
+
+// Aggregates moves of played games into book entries. Builders of several
+// threads are merged before saving.
+class BookBuilder {
+  int m_radius;
+  std::map<std::pair<uint64_t, uint32_t>, BookEntry> m_entries;
+  size_t m_positions = 0;
+
+public:
+  explicit BookBuilder(int radius = 3) : m_radius(radius) {}
+
+  int get_radius() const { return m_radius; }
+  size_t get_positions_num() const { return m_positions; }
+  size_t get_entries_num() const { return m_entries.size(); }
+
+  // Adds the move played in the position with the result of the game for
+  // the side which made it: 1 for a win, 0.5 for a draw, 0 for a loss.
+  // Returns false if the position is out of the book window.
+  bool add_move(const State &state, Point move, double result);
+  void merge(const BookBuilder &other);
+  // Writes the moves played at least `min_games` times.
+  bool save(const char *path, uint32_t min_games = 1) const;
+};
+
+// Memory-mapped opening book.
+class OpeningBook {
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  const BookEntry *m_entries = nullptr;
+  size_t m_n_entries = 0;
+  int m_radius = 0;
+
+public:
+  OpeningBook() = default;
+  OpeningBook(const OpeningBook &) = delete;
+  OpeningBook &operator=(const OpeningBook &) = delete;
+  ~OpeningBook();
+
+  bool open(const char *path, const char **error = nullptr);
+  void close();
+
+  bool is_open() const { return m_data != nullptr; }
+  int get_radius() const { return m_radius; }
+  size_t get_entries_num() const { return m_n_entries; }
+
+  // Book moves of the position in the field coordinates, most played first.
+  void probe(const State &state, std::vector<BookMove> &moves) const;
+  // The move with the best score among the ones played at least
+  // `min_games` times.
+  bool find_move(const State &state, Point &move,
+                 uint32_t min_games = 1) const;
+};
+
+}; // namespace ttt::engine
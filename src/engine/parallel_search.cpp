@@ -0,0 +1,101 @@
+#include "parallel_search.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace ttt::engine {
+
+ParallelSearch::ParallelSearch(int n_threads, const SearchParams &params)
+    : m_params(params) {
+  set_threads(n_threads);
+}
+
+void ParallelSearch::set_threads(int n_threads) {
+  n_threads = std::max(1, n_threads);
+  m_searches.resize(n_threads);
+  for (int i = 0; i < n_threads; ++i) {
+    if (!m_searches[i])
+      m_searches[i] = std::make_unique<Search>(m_params);
+    m_searches[i]->set_helper_id(i);
+    m_searches[i]->set_group_stop(i > 0 ? &m_helpers_stop : nullptr);
+    m_searches[i]->set_table(m_tt);
+  }
+}
+
+void ParallelSearch::set_params(const SearchParams &params) {
+  m_params = params;
+  for (auto &search : m_searches)
+    search->set_params(params);
+}
+
+void ParallelSearch::set_table(TranspositionTable *tt) {
+  m_tt = tt;
+  for (auto &search : m_searches)
+    search->set_table(tt);
+}
+
+void ParallelSearch::stop() {
+  m_helpers_stop.store(true, std::memory_order_relaxed);
+  m_searches[0]->stop();
+}
+
+void ParallelSearch::set_deadline(Search::Clock::time_point deadline) {
+  for (auto &search : m_searches)
+    search->set_deadline(deadline);
+}
+
+void ParallelSearch::set_soft_deadline(Search::Clock::time_point deadline) {
+  for (auto &search : m_searches)
+    search->set_soft_deadline(deadline);
+}
+
+void ParallelSearch::clear_deadline() {
+  for (auto &search : m_searches)
+    search->clear_deadline();
+}
+
+void ParallelSearch::clear_move_order() {
+  for (auto &search : m_searches)
+    search->get_move_order().clear();
+}
+
+SearchResult ParallelSearch::run(const Board &board,
+                                 const SearchLimits &limits) {
+  const int n = m_searches.size();
+  if (n == 1 || !m_tt)
+    return m_searches[0]->run(board, limits);
+
+  std::vector<SearchResult> results(n);
+  std::vector<std::thread> helpers;
+  helpers.reserve(n - 1);
+  // helpers obey the same limits but the main search also stops them
+  m_helpers_stop.store(false, std::memory_order_relaxed);
+  for (int i = 1; i < n; ++i)
+    helpers.emplace_back([this, &board, &limits, &results, i]() {
+      results[i] = m_searches[i]->run(board, limits);
+    });
+  results[0] = m_searches[0]->run(board, limits);
+  m_helpers_stop.store(true, std::memory_order_relaxed);
+  for (auto &thread : helpers)
+    thread.join();
+
+  int best = 0;
+  int64_t nodes = 0;
+  for (int i = 0; i < n; ++i) {
+    nodes += results[i].nodes;
+    if (results[i].depth > results[best].depth)
+      best = i;
+  }
+  // counters of all threads, iterations of the main search
+  SearchStats stats = results[0].stats;
+  for (int i = 1; i < n; ++i)
+    stats.add_counters(results[i].stats);
+  stats.depth = results[best].depth;
+  SearchResult result = std::move(results[best]);
+  result.nodes = nodes;
+  result.time_ms = results[0].time_ms;
+  result.stats = std::move(stats);
+  return result;
+}
+
+}; // namespace ttt::engine
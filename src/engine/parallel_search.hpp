@@ -0,0 +1,45 @@
+#pragma once
+
+#include "search.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace ttt::engine {
+
+// Lazy SMP search: the main search and `n_threads - 1` helpers search the
+// same root independently and share results only through the transposition
+// table. Helpers skip different depths, so they run ahead of the main search
+// and fill the table for it. The move of the deepest finished iteration is
+// played, the main search wins ties. Helper threads are started for every
+// call of `run` and stop together with the main search.
+class ParallelSearch {
+  std::vector<std::unique_ptr<Search>> m_searches;
+  SearchParams m_params;
+  TranspositionTable *m_tt = nullptr;
+  std::atomic<bool> m_helpers_stop{false};
+
+public:
+  explicit ParallelSearch(int n_threads = 1, const SearchParams &params = {});
+
+  void set_threads(int n_threads);
+  int get_threads() const { return m_searches.size(); }
+
+  const SearchParams &get_params() const { return m_params; }
+  void set_params(const SearchParams &params);
+  // Parallel search needs a table, helpers are useless without it.
+  void set_table(TranspositionTable *tt);
+
+  // Called by the thread which runs the main search.
+  SearchResult run(const Board &board, const SearchLimits &limits);
+  void stop();
+  // See `Search::set_deadline`.
+  void set_deadline(Search::Clock::time_point deadline);
+  void set_soft_deadline(Search::Clock::time_point deadline);
+  void clear_deadline();
+  // Clears the move ordering tables of all searches, e.g. for a new game.
+  void clear_move_order();
+};
+
+}; // namespace ttt::engine
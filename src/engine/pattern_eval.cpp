@@ -0,0 +1,287 @@
+#include "pattern_eval.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+
+namespace ttt::engine {
+
+namespace {
+
+constexpr EvalWeights DEFAULT_WEIGHTS{};
+
+constexpr int table_size(int win_len) {
+  return (win_len + 1) * (win_len + 1) * (win_len + 1) + win_len + 1;
+}
+
+// Score of a pattern from X point of view: a window with walls or stones of
+// both sides scores nothing. Patterns past the last full window only appear
+// with a stone added to a full window, which has no empty cell.
+constexpr int pattern_score(int win_len, int pattern) {
+  const int unit = win_len + 1;
+  const int n_x = pattern % unit;
+  const int n_o = pattern / unit % unit;
+  if (pattern / (unit * unit) > 0)
+    return 0;
+  if (n_o == 0)
+    return window_weight(win_len, n_x, DEFAULT_WEIGHTS);
+  if (n_x == 0)
+    return -window_weight(win_len, n_o, DEFAULT_WEIGHTS);
+  return 0;
+}
+
+template <int W> struct PatternTable {
+  int scores[table_size(W)];
+
+  constexpr PatternTable() : scores() {
+    for (int i = 0; i < table_size(W); ++i)
+      scores[i] = pattern_score(W, i);
+  }
+};
+
+template <int W> constexpr PatternTable<W> TABLE{};
+
+static_assert(TABLE<5>.scores[4] == 1024, "four of X in a five");
+static_assert(TABLE<5>.scores[3 * 6] == -128, "three of O in a five");
+static_assert(TABLE<5>.scores[36 + 1] == 0, "a wall in the window");
+
+template <size_t... W>
+constexpr std::array<const int *, sizeof...(W)>
+make_tables(std::index_sequence<W...>) {
+  return {TABLE<int(W)>.scores...};
+}
+
+constexpr auto TABLES =
+    make_tables(std::make_index_sequence<PatternEval::MAX_TABLE_LEN + 1>());
+
+// patterns[i] is the sum of grid[i + k * step] for k < win_len
+void sum_windows_scalar(const uint16_t *grid, uint16_t *patterns, int n,
+                        int step, int win_len) {
+  for (int i = 0; i < n; ++i) {
+    int sum = 0;
+    for (int k = 0; k < win_len; ++k)
+      sum += grid[i + k * step];
+    patterns[i] = sum;
+  }
+}
+
+int sum_scores_scalar(const int *table, const uint16_t *patterns, int n) {
+  int sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += table[patterns[i]];
+  return sum;
+}
+
+// gains[i] gets the sum of delta[i - k * step] for k < win_len
+void sum_deltas_scalar(const int *delta, int *gains, int n, int step,
+                       int win_len) {
+  for (int i = 0; i < n; ++i)
+    for (int k = 0; k < win_len; ++k)
+      gains[i] += delta[i - k * step];
+}
+
+#ifdef TTT_X86_SIMD
+
+// Vectors stop before the end of the row, which may be followed by the next
+// one when the padding is narrow, and the rest is summed by the scalar loop.
+void sum_windows_sse2(const uint16_t *grid, uint16_t *patterns, int n,
+                      int step, int win_len) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i sum = _mm_setzero_si128();
+    for (int k = 0; k < win_len; ++k)
+      sum = _mm_add_epi16(
+          sum, _mm_loadu_si128((const __m128i *)(grid + i + k * step)));
+    _mm_storeu_si128((__m128i *)(patterns + i), sum);
+  }
+  sum_windows_scalar(grid + i, patterns + i, n - i, step, win_len);
+}
+
+void sum_deltas_sse2(const int *delta, int *gains, int n, int step,
+                     int win_len) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i sum = _mm_loadu_si128((const __m128i *)(gains + i));
+    for (int k = 0; k < win_len; ++k)
+      sum = _mm_add_epi32(
+          sum, _mm_loadu_si128((const __m128i *)(delta + i - k * step)));
+    _mm_storeu_si128((__m128i *)(gains + i), sum);
+  }
+  sum_deltas_scalar(delta + i, gains + i, n - i, step, win_len);
+}
+
+TTT_TARGET_AVX2 void sum_windows_avx2(const uint16_t *grid,
+                                      uint16_t *patterns, int n, int step,
+                                      int win_len) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i sum = _mm256_setzero_si256();
+    for (int k = 0; k < win_len; ++k)
+      sum = _mm256_add_epi16(
+          sum, _mm256_loadu_si256((const __m256i *)(grid + i + k * step)));
+    _mm256_storeu_si256((__m256i *)(patterns + i), sum);
+  }
+  sum_windows_scalar(grid + i, patterns + i, n - i, step, win_len);
+}
+
+TTT_TARGET_AVX2 int sum_scores_avx2(const int *table,
+                                    const uint16_t *patterns, int n) {
+  __m256i sum = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i index = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i *)(patterns + i)));
+    sum = _mm256_add_epi32(sum, _mm256_i32gather_epi32(table, index, 4));
+  }
+  alignas(32) int lanes[8];
+  _mm256_store_si256((__m256i *)lanes, sum);
+  int total = 0;
+  for (int lane : lanes)
+    total += lane;
+  return total + sum_scores_scalar(table, patterns + i, n - i);
+}
+
+TTT_TARGET_AVX2 void sum_deltas_avx2(const int *delta, int *gains, int n,
+                                     int step, int win_len) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i sum = _mm256_loadu_si256((const __m256i *)(gains + i));
+    for (int k = 0; k < win_len; ++k)
+      sum = _mm256_add_epi32(
+          sum, _mm256_loadu_si256((const __m256i *)(delta + i - k * step)));
+    _mm256_storeu_si256((__m256i *)(gains + i), sum);
+  }
+  sum_deltas_scalar(delta + i, gains + i, n - i, step, win_len);
+}
+
+#endif
+
+}; // namespace
+
+PatternEval::PatternEval() : m_isa(get_best_isa()) {}
+
+void PatternEval::set_isa(SimdIsa isa) {
+  m_isa = std::min(isa, get_best_isa());
+}
+
+void PatternEval::load(const State &state) {
+  const auto &opts = state.get_opts();
+  m_rows = opts.rows;
+  m_cols = opts.cols;
+  m_win_len = opts.win_len;
+  // walls around the field are as wide as a window without one cell
+  const int pad = std::max(0, m_win_len - 1);
+  m_stride = m_cols + 2 * pad;
+  m_origin = pad * m_stride + pad;
+  const int size = (m_rows + 2 * pad) * m_stride;
+
+  m_table = nullptr;
+  if (m_win_len <= MAX_TABLE_LEN) {
+    m_table = TABLES[m_win_len];
+  } else if (m_win_len <= MAX_WIN_LEN) {
+    m_runtime_table.resize(table_size(m_win_len));
+    for (int i = 0; i < int(m_runtime_table.size()); ++i)
+      m_runtime_table[i] = pattern_score(m_win_len, i);
+    m_table = m_runtime_table.data();
+  }
+
+  const uint16_t unit = m_win_len + 1;
+  const uint16_t codes[4] = {0, 1, unit, uint16_t(unit * unit)};
+  m_grid.assign(size, codes[int(game::Sign::WALL)]);
+  for (int y = 0; y < m_rows; ++y)
+    for (int x = 0; x < m_cols; ++x)
+      m_grid[m_origin + y * m_stride + x] = codes[int(state.get_value(x, y))];
+
+  const int steps[4] = {1, m_stride, m_stride + 1, m_stride - 1};
+  for (int d = 0; d < 4; ++d) {
+    m_patterns[d].assign(size, 0);
+    if (!m_table)
+      continue;
+    for (int y = 0; y < m_rows; ++y) {
+      const int row = m_origin + y * m_stride;
+      const uint16_t *grid = m_grid.data() + row;
+      uint16_t *patterns = m_patterns[d].data() + row;
+      switch (m_isa) {
+#ifdef TTT_X86_SIMD
+      case SimdIsa::AVX2:
+        sum_windows_avx2(grid, patterns, m_cols, steps[d], m_win_len);
+        break;
+      case SimdIsa::SSE2:
+        sum_windows_sse2(grid, patterns, m_cols, steps[d], m_win_len);
+        break;
+#endif
+      default:
+        sum_windows_scalar(grid, patterns, m_cols, steps[d], m_win_len);
+      }
+    }
+  }
+}
+
+int PatternEval::evaluate() const {
+  if (!m_table)
+    return 0;
+  int score = 0;
+  for (int d = 0; d < 4; ++d) {
+    for (int y = 0; y < m_rows; ++y) {
+      const uint16_t *patterns = m_patterns[d].data() + m_origin + y * m_stride;
+#ifdef TTT_X86_SIMD
+      if (m_isa == SimdIsa::AVX2) {
+        score += sum_scores_avx2(m_table, patterns, m_cols);
+        continue;
+      }
+#endif
+      score += sum_scores_scalar(m_table, patterns, m_cols);
+    }
+  }
+  return score;
+}
+
+void PatternEval::get_gains(int side, std::vector<int> &gains) const {
+  gains.assign(m_rows * m_cols, 0);
+  if (!m_table)
+    return;
+  // a stone changes the pattern of every window through the cell by the
+  // same amount, the change of the score is spread back over the cells
+  const int add = side == 0 ? 1 : m_win_len + 1;
+  const int sign = side == 0 ? 1 : -1;
+  const int steps[4] = {1, m_stride, m_stride + 1, m_stride - 1};
+  m_delta.assign(m_grid.size(), 0);
+  m_gains.assign(m_grid.size(), 0);
+  for (int d = 0; d < 4; ++d) {
+    for (int y = 0; y < m_rows; ++y) {
+      const int row = m_origin + y * m_stride;
+      for (int x = 0; x < m_cols; ++x) {
+        const int pattern = m_patterns[d][row + x];
+        m_delta[row + x] =
+            sign * (m_table[pattern + add] - m_table[pattern]);
+      }
+    }
+    for (int y = 0; y < m_rows; ++y) {
+      const int row = m_origin + y * m_stride;
+      const int *delta = m_delta.data() + row;
+      int *sums = m_gains.data() + row;
+      switch (m_isa) {
+#ifdef TTT_X86_SIMD
+      case SimdIsa::AVX2:
+        sum_deltas_avx2(delta, sums, m_cols, steps[d], m_win_len);
+        break;
+      case SimdIsa::SSE2:
+        sum_deltas_sse2(delta, sums, m_cols, steps[d], m_win_len);
+        break;
+#endif
+      default:
+        sum_deltas_scalar(delta, sums, m_cols, steps[d], m_win_len);
+      }
+    }
+  }
+  for (int y = 0; y < m_rows; ++y) {
+    for (int x = 0; x < m_cols; ++x) {
+      const int i = m_origin + y * m_stride + x;
+      if (m_grid[i] == 0)
+        gains[y * m_cols + x] = m_gains[i];
+    }
+  }
+}
+
+}; // namespace ttt::engine
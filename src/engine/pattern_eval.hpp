@@ -0,0 +1,66 @@
+#pragma once
+
+#include "board.hpp"
+#include "simd.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace ttt::engine {
+
+// Static evaluation by line window patterns for players which have only a
+// `State`. The field is read once into a padded grid where an empty cell is
+// 0, X is 1, O is `win_len + 1` and a wall or the edge is `(win_len + 1)^2`,
+// so the sum over a window is a small integer pattern which counts stones of
+// both sides and walls. Sums of all windows of a direction are computed by
+// SSE2 or AVX2 additions of shifted rows and scored by a lookup table which
+// is generated at compile time for every `win_len` up to `MAX_TABLE_LEN`.
+// Scores match `Board` with the default `EvalWeights`.
+class PatternEval {
+public:
+  // longer lines get a table built at runtime
+  static const int MAX_TABLE_LEN = 16;
+  // patterns of longer lines do not fit 16 bits, they are not scored
+  static const int MAX_WIN_LEN = 32;
+
+private:
+  SimdIsa m_isa;
+  int m_rows = 0;
+  int m_cols = 0;
+  int m_win_len = 0;
+  int m_stride = 0;
+  // index of the cell (0, 0) in the padded arrays
+  int m_origin = 0;
+  const int *m_table = nullptr;
+  std::vector<int> m_runtime_table;
+  std::vector<uint16_t> m_grid;
+  // patterns of the windows starting at each cell in the four directions
+  std::vector<uint16_t> m_patterns[4];
+  mutable std::vector<int> m_delta;
+  mutable std::vector<int> m_gains;
+
+public:
+  // Uses the best instruction set the CPU supports.
+  PatternEval();
+
+  // The instruction set is clamped to the ones the CPU supports.
+  void set_isa(SimdIsa isa);
+  SimdIsa get_isa() const { return m_isa; }
+
+  void load(const State &state);
+  int get_rows() const { return m_rows; }
+  int get_cols() const { return m_cols; }
+
+  // Pattern of the window which starts at the cell and goes right, down,
+  // down-right or down-left for `dir` 0 to 3.
+  int get_pattern(int x, int y, int dir) const {
+    return m_patterns[dir][m_origin + y * m_stride + x];
+  }
+  // Static evaluation from X point of view, equal to `Board::get_eval`.
+  int evaluate() const;
+  // Gains of a stone of a side at every cell, row by row, as
+  // `Board::get_move_gain`; occupied cells get 0.
+  void get_gains(int side, std::vector<int> &gains) const;
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,170 @@
+#include "position.hpp"
+
+#include <sstream>
+
+namespace ttt::engine {
+
+using game::Point;
+using game::Sign;
+
+namespace {
+
+class WallsInitializer : public game::IFieldInitializer {
+  std::vector<Point> m_walls;
+
+public:
+  explicit WallsInitializer(const std::vector<Point> &walls)
+      : m_walls(walls) {}
+  void initialize(game::FieldBitmap &field) override {
+    for (const auto &pt : m_walls)
+      field.set(pt.x, pt.y, Sign::WALL);
+  }
+  IFieldInitializer *clone() const override {
+    return new WallsInitializer(*this);
+  }
+};
+
+std::string trim(const std::string &line) {
+  const auto begin = line.find_first_not_of(" \t\r");
+  if (begin == std::string::npos)
+    return "";
+  const auto end = line.find_last_not_of(" \t\r");
+  return line.substr(begin, end - begin + 1);
+}
+
+}; // namespace
+
+const std::string *Position::get_tag(const std::string &key) const {
+  for (const auto &tag : tags)
+    if (tag.first == key)
+      return &tag.second;
+  return nullptr;
+}
+
+bool read_position(std::istream &in, Position &pos, const char **error) {
+  auto fail = [&](const char *message) {
+    if (error)
+      *error = message;
+    return false;
+  };
+  if (error)
+    *error = nullptr;
+  std::string line;
+  do {
+    if (!std::getline(in, line))
+      return false;
+    line = trim(line);
+  } while (line.empty() || line[0] == '#');
+
+  pos = Position();
+  std::istringstream header(line);
+  if (!(header >> pos.opts.rows >> pos.opts.cols >> pos.opts.win_len))
+    return fail("bad header of the position");
+  if (!(header >> pos.opts.max_moves))
+    pos.opts.max_moves = 0;
+  if (pos.opts.rows <= 0 || pos.opts.cols <= 0 || pos.opts.win_len <= 0 ||
+      pos.opts.max_moves < 0)
+    return fail("bad options of the position");
+  for (int y = 0; y < pos.opts.rows; ++y) {
+    if (!std::getline(in, line))
+      return fail("the field is cut short");
+    line = trim(line);
+    if (int(line.size()) != pos.opts.cols)
+      return fail("bad length of a row");
+    if (line.find_first_not_of(".XO#") != std::string::npos)
+      return fail("bad cell of a row");
+    pos.rows.push_back(line);
+  }
+  while (std::getline(in, line)) {
+    line = trim(line);
+    if (line.empty())
+      break;
+    const auto space = line.find_first_of(" \t");
+    const std::string key = line.substr(0, space);
+    const std::string value =
+        space == std::string::npos ? "" : trim(line.substr(space));
+    if (key == "last") {
+      std::istringstream ss(value);
+      if (!(ss >> pos.last.x >> pos.last.y))
+        return fail("bad last move");
+    } else {
+      pos.tags.emplace_back(key, value);
+    }
+  }
+  return true;
+}
+
+void write_position(std::ostream &out, const Position &pos) {
+  out << pos.opts.rows << ' ' << pos.opts.cols << ' ' << pos.opts.win_len
+      << ' ' << pos.opts.max_moves << '\n';
+  for (const auto &row : pos.rows)
+    out << row << '\n';
+  if (pos.last.x >= 0)
+    out << "last " << pos.last.x << ' ' << pos.last.y << '\n';
+  for (const auto &tag : pos.tags)
+    out << tag.first << ' ' << tag.second << '\n';
+  out << '\n';
+}
+
+Position make_position(const State &state, Point last) {
+  static const char CHARS[] = {'.', 'X', 'O', '#'};
+  Position pos;
+  pos.opts = state.get_opts();
+  for (int y = 0; y < pos.opts.rows; ++y) {
+    std::string row;
+    for (int x = 0; x < pos.opts.cols; ++x)
+      row += CHARS[int(state.get_value(x, y))];
+    pos.rows.push_back(row);
+  }
+  pos.last = last;
+  return pos;
+}
+
+std::unique_ptr<State> make_state(const Position &pos, const char **error) {
+  auto fail = [&](const char *message) {
+    if (error)
+      *error = message;
+    return nullptr;
+  };
+  if (error)
+    *error = nullptr;
+  std::vector<Point> walls, stones[2];
+  for (int y = 0; y < pos.opts.rows; ++y) {
+    for (int x = 0; x < pos.opts.cols; ++x) {
+      const char c = pos.rows[y][x];
+      if (c == '#')
+        walls.push_back({x, y});
+      else if (c == 'X' || c == 'O')
+        stones[c == 'O'].push_back({x, y});
+    }
+  }
+  const int n_x = stones[0].size(), n_o = stones[1].size();
+  if (n_x != n_o && n_x != n_o + 1)
+    return fail("X must have as many stones as O or one more");
+  if (pos.last.x >= 0) {
+    auto &last_stones = stones[n_x == n_o];
+    int i = 0;
+    while (i < int(last_stones.size()) && (last_stones[i].x != pos.last.x ||
+                                           last_stones[i].y != pos.last.y))
+      ++i;
+    if (i == int(last_stones.size()))
+      return fail("the last move is not a stone of the side which moved last");
+    std::swap(last_stones[i], last_stones.back());
+  }
+
+  WallsInitializer initializer(walls);
+  auto state = std::make_unique<State>(pos.opts, &initializer);
+  const int n_moves = n_x + n_o;
+  for (int i = 0; i < n_moves; ++i) {
+    if (state->get_status() == game::Status::LAST_MOVE ||
+        state->get_status() == game::Status::ENDED)
+      return fail("the game is over before the last stone");
+    const Point pt = stones[i & 1][i / 2];
+    if (game::is_dq(state->process_move(state->get_current_player(), pt.x,
+                                        pt.y)))
+      return fail("a stone cannot be placed");
+  }
+  return state;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::State;
+
+/*
+  Text format of positions, used by the solvers and their tools:
+
+    # comments and blank lines before a position are skipped
+    4 4 3 0
+    X.O.
+    .X..
+    .#O.
+    ....
+    last 1 1
+    name some position
+
+  The first line holds rows, columns, length of the winning line and the
+  limit of moves (0 for the whole field). It is followed by the rows of the
+  field: '.' is an empty cell, 'X' and 'O' are stones and '#' is a wall. The
+  rest of the lines up to a blank line are "key value" tags, `last x y` is
+  the cell of the last move. X moves first, so X has as many stones as O or
+  one more.
+*/
+struct Position {
+  State::Opts opts = {0, 0, 0, 0};
+  std::vector<std::string> rows;
+  game::Point last = {-1, -1};
+  std::vector<std::pair<std::string, std::string>> tags;
+
+  // Value of the first tag with the key or nullptr.
+  const std::string *get_tag(const std::string &key) const;
+};
+
+// Reads the next position of the stream. Returns false at the end of the
+// stream and on errors, `error` is set in the latter case.
+bool read_position(std::istream &in, Position &pos, const char **error);
+void write_position(std::ostream &out, const Position &pos);
+
+Position make_position(const State &state, game::Point last = {-1, -1});
+// Replays the stones of the position, the last move goes last, so X which
+// has just completed a line leaves the game at LAST_MOVE. Returns nullptr
+// when the position cannot be reached in a game.
+std::unique_ptr<State> make_state(const Position &pos,
+                                  const char **error = nullptr);
+
+}; // namespace ttt::engine
@@ -0,0 +1,225 @@
+#include "proof_solver.hpp"
+
+#include <algorithm>
+
+namespace ttt::engine {
+
+static const uint32_t INF = 1u << 30;
+// entries of the proofs for O are kept apart from the ones for X
+static const uint64_t ATTACKER_O_KEY = 0x9e3779b97f4a7c15ull;
+
+const char *to_string(ProofValue value) {
+  switch (value) {
+  case ProofValue::WIN:
+    return "win";
+  case ProofValue::DRAW:
+    return "draw";
+  case ProofValue::LOSS:
+    return "loss";
+  default:
+    return "unknown";
+  }
+}
+
+ProofSolver::ProofSolver(size_t table_mb) { resize(table_mb); }
+
+void ProofSolver::resize(size_t table_mb) {
+  size_t n = std::max<size_t>(1, (table_mb << 20) / sizeof(Bucket));
+  // the number of buckets is a power of two to index them by a mask
+  while (n & (n - 1))
+    n &= n - 1;
+  m_table.assign(n, Bucket());
+}
+
+void ProofSolver::clear() {
+  std::fill(m_table.begin(), m_table.end(), Bucket());
+}
+
+uint64_t ProofSolver::_key(uint64_t hash) const {
+  return m_attacker == 0 ? hash : hash ^ ATTACKER_O_KEY;
+}
+
+// Empty entries have both numbers zero, which no searched position has.
+ProofSolver::Numbers ProofSolver::_lookup(uint64_t key) const {
+  const Bucket &bucket = m_table[key & (m_table.size() - 1)];
+  for (const auto &entry : bucket.entries)
+    if (entry.key == key && (entry.phi | entry.delta) != 0)
+      return {entry.phi, entry.delta};
+  return {1, 1};
+}
+
+void ProofSolver::_store(uint64_t key, Numbers numbers, int64_t work) {
+  Bucket &bucket = m_table[key & (m_table.size() - 1)];
+  Entry *victim = &bucket.entries[0];
+  for (auto &entry : bucket.entries) {
+    if (entry.key == key || (entry.phi | entry.delta) == 0) {
+      victim = &entry;
+      break;
+    }
+    if (entry.work < victim->work)
+      victim = &entry;
+  }
+  const uint32_t new_work = uint32_t(std::min<int64_t>(work, UINT32_MAX));
+  if (victim->key != key)
+    victim->work = 0;
+  victim->key = key;
+  victim->phi = numbers.phi;
+  victim->delta = numbers.delta;
+  victim->work = std::max(victim->work, new_work);
+}
+
+bool ProofSolver::_check_limits() {
+  if (m_max_nodes > 0 && m_nodes >= m_max_nodes)
+    return true;
+  return m_has_deadline && Clock::now() >= m_deadline;
+}
+
+int ProofSolver::_terminal() const {
+  const Board &b = *m_board;
+  if (b.is_over())
+    return b.get_outcome() ==
+           (m_attacker == 0 ? Outcome::X_WINS : Outcome::O_WINS);
+  if (b.is_last_move())
+    return b.get_last_move_outcome() ==
+           (m_attacker == 0 ? Outcome::X_WINS : Outcome::O_WINS);
+  if (b.find_winning_move() >= 0)
+    return b.get_side_to_move() == m_attacker;
+  return -1;
+}
+
+void ProofSolver::_generate(int ply) {
+  Board &b = *m_board;
+  const int stm = b.get_side_to_move(), opp = 1 - stm;
+  // against a threat only blocks are left and the moves which answer it
+  // with a line: X completes own line, so O has to draw by the last reply,
+  // O makes a threat to complete its line after the one of X
+  const bool forced = b.get_threats(opp) > 0;
+  auto &children = m_children[ply];
+  children.clear();
+  for (int y = 0; y < b.get_rows(); ++y) {
+    for (int x = 0; x < b.get_cols(); ++x) {
+      const int cell = b.index(x, y);
+      if (!b.is_empty(cell))
+        continue;
+      if (forced && !b.is_winning_cell(cell, opp) &&
+          !(stm == 0 ? b.is_winning_cell(cell, 0) : b.makes_threat(cell, 1)))
+        continue;
+      children.push_back({cell, b.get_move_gain(cell, stm), 0});
+    }
+  }
+  std::stable_sort(
+      children.begin(), children.end(),
+      [](const Child &a, const Child &b) { return a.order > b.order; });
+  for (auto &child : children) {
+    b.make(child.cell);
+    child.key = _key(b.get_hash());
+    b.unmake();
+  }
+}
+
+ProofSolver::Numbers ProofSolver::_mid(uint32_t th_phi, uint32_t th_delta,
+                                       int ply) {
+  if ((++m_nodes & 1023) == 0 && _check_limits())
+    m_aborted = true;
+  Board &b = *m_board;
+  const uint64_t key = _key(b.get_hash());
+  const int terminal = _terminal();
+  if (terminal >= 0) {
+    const bool success = (b.get_side_to_move() == m_attacker) == terminal;
+    const Numbers numbers = {success ? 0 : INF, success ? INF : 0};
+    _store(key, numbers, 1);
+    return numbers;
+  }
+  Numbers numbers = _lookup(key);
+  if (m_aborted)
+    return numbers;
+
+  _generate(ply);
+  const auto &children = m_children[ply];
+  const int64_t start_nodes = m_nodes;
+  while (true) {
+    // phi is the least delta of the children, delta is the sum of their phi
+    int best = -1;
+    uint32_t best_phi = 0, delta_2 = INF;
+    uint64_t sum = 0;
+    bool disproved = false;
+    numbers.phi = INF;
+    for (int i = 0; i < int(children.size()); ++i) {
+      const Numbers child = _lookup(children[i].key);
+      sum += child.phi;
+      disproved |= child.phi >= INF;
+      if (child.delta < numbers.phi) {
+        delta_2 = numbers.phi;
+        numbers.phi = child.delta;
+        best_phi = child.phi;
+        best = i;
+      } else if (child.delta < delta_2) {
+        delta_2 = child.delta;
+      }
+    }
+    numbers.delta =
+        disproved ? INF : uint32_t(std::min<uint64_t>(sum, INF - 1));
+    if (ply == 0 && best >= 0)
+      m_best_cell = children[best].cell;
+    if (numbers.phi >= th_phi || numbers.delta >= th_delta || m_aborted)
+      break;
+    const uint32_t child_th_phi = uint32_t(
+        std::min<uint64_t>(INF, uint64_t(th_delta) + best_phi - numbers.delta));
+    const uint32_t child_th_delta = std::min(th_phi, delta_2 + 1);
+    b.make(children[best].cell);
+    _mid(child_th_phi, child_th_delta, ply + 1);
+    b.unmake();
+  }
+  _store(key, numbers, m_nodes - start_nodes + 1);
+  return numbers;
+}
+
+int ProofSolver::_prove(Board &board, int attacker) {
+  m_board = &board;
+  m_attacker = attacker;
+  m_best_cell = -1;
+  const Numbers root = _mid(INF, INF, 0);
+  m_board = nullptr;
+  if (root.phi != 0 && root.delta != 0)
+    return -1;
+  // the side to move succeeds when its proof number is zero
+  return (root.phi == 0) == (board.get_side_to_move() == attacker);
+}
+
+ProofResult ProofSolver::solve(const Board &board, const ProofLimits &limits) {
+  Board b = board;
+  const size_t max_ply = b.get_rows() * b.get_cols() + 2;
+  if (m_children.size() < max_ply)
+    m_children.resize(max_ply);
+  m_nodes = 0;
+  m_max_nodes = limits.nodes;
+  m_has_deadline = limits.time_ms > 0;
+  m_deadline = Clock::now() + std::chrono::milliseconds(limits.time_ms);
+  m_aborted = false;
+
+  ProofResult result;
+  const int stm = b.get_side_to_move();
+  const int win = _prove(b, stm);
+  if (win == 1) {
+    result.value = ProofValue::WIN;
+  } else if (win == 0) {
+    const int loss = _prove(b, 1 - stm);
+    if (loss >= 0)
+      result.value = loss == 1 ? ProofValue::LOSS : ProofValue::DRAW;
+  }
+  result.nodes = m_nodes;
+  if (result.value == ProofValue::UNKNOWN || b.is_over())
+    return result;
+
+  // at terminal positions the move is not searched
+  int cell = m_best_cell;
+  if (cell < 0)
+    cell = b.is_last_move() ? b.find_winning_cell(1) : b.find_winning_move();
+  for (int i = 0; cell < 0 && i < b.get_rows() * b.get_cols(); ++i)
+    if (b.is_empty(b.index(i % b.get_cols(), i / b.get_cols())))
+      cell = b.index(i % b.get_cols(), i / b.get_cols());
+  result.move = {b.get_x(cell), b.get_y(cell)};
+  return result;
+}
+
+}; // namespace ttt::engine
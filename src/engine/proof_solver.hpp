@@ -0,0 +1,103 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ttt::engine {
+
+// Game-theoretic value for the side to move.
+enum class ProofValue : uint8_t { UNKNOWN, WIN, DRAW, LOSS };
+
+const char *to_string(ProofValue value);
+
+// Zero values mean no limit.
+struct ProofLimits {
+  int time_ms = 0;
+  int64_t nodes = 0;
+};
+
+struct ProofResult {
+  ProofValue value = ProofValue::UNKNOWN;
+  // a move which keeps the value, any legal move for a loss
+  game::Point move = {-1, -1};
+  int64_t nodes = 0;
+};
+
+// Depth-first proof-number search (df-pn). A position is solved by two
+// proofs: whether the side to move wins and, if it does not, whether the
+// opponent wins; when neither does it is a draw. Terminal positions follow
+// the game rules, including the LAST_MOVE reply of O and the limit of moves,
+// and moves which lose at once against a threat are pruned. Proof and
+// disproof numbers live in a fixed-size table, so the memory does not grow
+// with the search: the entries with the least work under them are replaced.
+class ProofSolver {
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    uint64_t key;
+    uint32_t phi;
+    uint32_t delta;
+    uint32_t work;
+  };
+
+  struct Bucket {
+    Entry entries[4];
+  };
+
+  struct Child {
+    int cell;
+    int order;
+    uint64_t key;
+  };
+
+  struct Numbers {
+    uint32_t phi;
+    uint32_t delta;
+  };
+
+  std::vector<Bucket> m_table;
+  Board *m_board = nullptr;
+  int m_attacker = 0;
+  int m_best_cell = -1;
+  int64_t m_nodes = 0;
+  int64_t m_max_nodes = 0;
+  bool m_has_deadline = false;
+  Clock::time_point m_deadline;
+  bool m_aborted = false;
+  std::vector<std::vector<Child>> m_children;
+
+public:
+  explicit ProofSolver(size_t table_mb = 64);
+
+  // Reallocates the table, all entries are lost.
+  void resize(size_t table_mb);
+  void clear();
+  size_t get_size_bytes() const { return m_table.size() * sizeof(Bucket); }
+
+  // Entries of previous calls are kept, so solving positions of one game
+  // reuses the proofs of their common subtrees.
+  ProofResult solve(const Board &board, const ProofLimits &limits);
+  ProofResult solve(const State &state, const ProofLimits &limits) {
+    return solve(Board(state), limits);
+  }
+
+private:
+  // 1 when the attacker wins, 0 when it does not and -1 when not proven.
+  int _prove(Board &board, int attacker);
+  // Proof and disproof numbers from the point of view of the side to move
+  // are searched until one of them reaches its threshold.
+  Numbers _mid(uint32_t th_phi, uint32_t th_delta, int ply);
+  int _terminal() const;
+  void _generate(int ply);
+  uint64_t _key(uint64_t hash) const;
+  Numbers _lookup(uint64_t key) const;
+  void _store(uint64_t key, Numbers numbers, int64_t work);
+  bool _check_limits();
+};
+
+}; // namespace ttt::engine
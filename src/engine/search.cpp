@@ -0,0 +1,457 @@
+#include "search.hpp"
+
+#include "time_manager.hpp"
+
+#include <algorithm>
+
+namespace ttt::engine {
+
+static const int INF_SCORE = WIN_SCORE + 1;
+// ordering bonuses of the stored best move and of moves completing own and
+// opponent lines
+static const int TT_MOVE_BONUS = 1 << 29;
+static const int OWN_WIN_BONUS = 1 << 28;
+static const int BLOCK_BONUS = 1 << 27;
+
+// Won and lost scores are stored relative to the node instead of the root.
+static int score_to_tt(int score, int ply) {
+  if (score >= WIN_SCORE - MAX_PLY)
+    return score + ply;
+  if (score <= -WIN_SCORE + MAX_PLY)
+    return score - ply;
+  return score;
+}
+
+static int score_from_tt(int score, int ply) {
+  if (score >= WIN_SCORE - MAX_PLY)
+    return score - ply;
+  if (score <= -WIN_SCORE + MAX_PLY)
+    return score + ply;
+  return score;
+}
+
+// Depth skipping patterns of the helper searches: a helper searches `size`
+// depths in a row and then skips as many, starting at its own `phase`.
+static const int SKIP_SIZE[] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+static const int SKIP_PHASE[] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3,
+                                 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+bool Search::_skips_depth(int depth) const {
+  if (m_helper_id == 0 || depth == 1)
+    return false;
+  const int i = (m_helper_id - 1) % 20;
+  return (depth + SKIP_PHASE[i]) / SKIP_SIZE[i] % 2 != 0;
+}
+
+bool Search::_check_limits() {
+  if (m_stop.load(std::memory_order_relaxed) ||
+      (m_group_stop && m_group_stop->load(std::memory_order_relaxed)))
+    return true;
+  if (m_max_nodes > 0 && m_nodes >= m_max_nodes)
+    return true;
+  const Clock::time_point now = Clock::now();
+  if (now.time_since_epoch().count() >=
+      m_shared_deadline.load(std::memory_order_relaxed))
+    return true;
+  return m_has_deadline && now >= m_deadline;
+}
+
+void Search::_update_pv(int ply, int cell) {
+  m_pv[ply][ply] = cell;
+  for (int i = ply + 1; i < m_pv_len[ply + 1]; ++i)
+    m_pv[ply][i] = m_pv[ply + 1][i];
+  m_pv_len[ply] = std::max(m_pv_len[ply + 1], ply + 1);
+}
+
+// Detects positions with a known result: finished games, the LAST_MOVE
+// reply of O and lines which the side to move completes at once.
+bool Search::_probe_end(int ply, int &score) {
+  const Board &b = *m_board;
+  const int stm = b.get_side_to_move();
+  switch (b.get_outcome()) {
+  case Outcome::NONE:
+    break;
+  case Outcome::DRAW:
+    score = 0;
+    return true;
+  case Outcome::X_WINS:
+    score = stm == 0 ? WIN_SCORE - ply : -WIN_SCORE + ply;
+    return true;
+  case Outcome::O_WINS:
+    score = stm == 1 ? WIN_SCORE - ply : -WIN_SCORE + ply;
+    return true;
+  }
+  if (b.is_last_move()) {
+    // O draws by completing own line, otherwise X wins after any reply
+    score = b.get_last_move_outcome() == Outcome::DRAW ? 0
+                                                       : -WIN_SCORE + ply + 1;
+    return true;
+  }
+  if (b.get_threats(stm) == 0)
+    return false;
+  if (stm == 1 || b.get_move_no() + 1 >= b.get_max_moves()) {
+    score = WIN_SCORE - ply - 1;
+    return true;
+  }
+  // X completes a line and wins if the stone leaves O no line to complete
+  if (b.find_winning_move() >= 0) {
+    score = WIN_SCORE - ply - 2;
+    return true;
+  }
+  return false;
+}
+
+int Search::_generate(int ply, bool root, int tt_cell) {
+  const Board &b = *m_board;
+  const int stm = b.get_side_to_move(), opp = 1 - stm;
+  // when the opponent threatens to complete a line only blocks, own
+  // completions and, for O, own threats which lead to a draw matter
+  const bool forced = b.get_threats(opp) > 0;
+  const int prev_cell = b.get_last_cell();
+  auto &moves = m_moves[ply];
+  moves.clear();
+  list_candidates(b, m_cells);
+  for (const int cell : m_cells) {
+    if (!b.has_neighbours(cell)) {
+      // no stones on the field yet: prefer cells close to the centre
+      moves.emplace_back(centre_score(b, cell), cell);
+      continue;
+    }
+    const bool own_win = b.is_winning_cell(cell, stm);
+    const bool block = b.is_winning_cell(cell, opp);
+    if (forced && !own_win && !block &&
+        !(stm == 1 && b.makes_threat(cell, stm)))
+      continue;
+    int score = b.get_move_gain(cell, stm);
+    if (cell == tt_cell)
+      score += TT_MOVE_BONUS;
+    if (own_win)
+      score += OWN_WIN_BONUS;
+    if (block)
+      score += BLOCK_BONUS;
+    if (!own_win && !block)
+      score += m_order.get_score(stm, ply, cell, prev_cell);
+    moves.emplace_back(score, cell);
+  }
+  std::sort(moves.begin(), moves.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  if (!root && !forced && m_params.max_width > 0 &&
+      int(moves.size()) > m_params.max_width)
+    moves.resize(m_params.max_width);
+  return moves.size();
+}
+
+// The quiet moves before the one at `index` failed to cut off the node.
+void Search::_add_cutoff(int depth, int ply, int index) {
+  const Board &b = *m_board;
+  const int stm = b.get_side_to_move(), opp = 1 - stm;
+  const auto is_quiet = [&](int cell) {
+    return !b.is_winning_cell(cell, stm) && !b.is_winning_cell(cell, opp);
+  };
+  const auto &moves = m_moves[ply];
+  const int cell = moves[index].second;
+  if (!is_quiet(cell))
+    return;
+  m_order.add_cutoff(stm, ply, cell, b.get_last_cell(), depth);
+  for (int i = 0; i < index; ++i)
+    if (is_quiet(moves[i].second))
+      m_order.add_miss(stm, moves[i].second, depth);
+}
+
+int Search::_qsearch(int alpha, int beta, int ply) {
+  m_pv_len[ply] = ply;
+  ++m_stats.qnodes;
+  if ((++m_nodes & 1023) == 0 && _check_limits())
+    m_aborted = true;
+  if (m_aborted)
+    return 0;
+  int score;
+  if (_probe_end(ply, score))
+    return score;
+  Board &b = *m_board;
+  const int stm = b.get_side_to_move(), opp = 1 - stm;
+  if (b.get_threats(opp) == 0 || ply >= MAX_PLY - 1)
+    return b.evaluate() + m_params.tempo;
+  // quiet positions are evaluated statically, threats must be answered: by a
+  // block, an own line or, for O, an own threat to draw with the last reply
+  auto &moves = m_moves[ply];
+  moves.clear();
+  // the window counters list the cells completing lines, cell indices go
+  // row by row
+  for (int side : {opp, stm})
+    for (int cell : b.get_winning_cells(side))
+      moves.emplace_back(1, cell);
+  std::sort(moves.begin(), moves.end());
+  moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+  if (stm == 1) {
+    auto add_threat = [&](int cell) {
+      if (b.is_empty(cell) && !b.is_winning_cell(cell, opp) &&
+          !b.is_winning_cell(cell, stm) && b.makes_threat(cell, stm))
+        moves.emplace_back(0, cell);
+    };
+    // threats are only in the windows found by the candidate masks
+    if (b.get_masks().is_valid() && b.get_win_len() > 2) {
+      CandidateOpts opts;
+      opts.threats_only = true;
+      for_each_candidate(b.get_masks(), opts,
+                         [&](int x, int y) { add_threat(b.index(x, y)); });
+    } else {
+      for (int y = 0; y < b.get_rows(); ++y)
+        for (int x = 0; x < b.get_cols(); ++x)
+          add_threat(b.index(x, y));
+    }
+  }
+  int best = -INF_SCORE;
+  for (const auto &move : moves) {
+    b.make(move.second);
+    score = -_qsearch(-beta, -alpha, ply + 1);
+    b.unmake();
+    if (m_aborted)
+      return 0;
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        _update_pv(ply, move.second);
+        if (alpha >= beta)
+          break;
+      }
+    }
+  }
+  return best;
+}
+
+int Search::_search(int depth, int alpha, int beta, int ply) {
+  m_pv_len[ply] = ply;
+  if ((++m_nodes & 1023) == 0 && _check_limits())
+    m_aborted = true;
+  if (m_aborted)
+    return 0;
+  int score;
+  if (_probe_end(ply, score))
+    return score;
+  if (depth <= 0 || ply >= MAX_PLY - 1)
+    return _qsearch(alpha, beta, ply);
+
+  Board &b = *m_board;
+  const int alpha_orig = alpha;
+  int tt_cell = -1;
+  TTEntry entry;
+  if (m_tt)
+    ++m_stats.tt_probes;
+  if (m_tt && m_tt->probe(b.get_hash(), entry)) {
+    ++m_stats.tt_hits;
+    tt_cell = entry.cell;
+    const int tt_score = score_from_tt(entry.score, ply);
+    // bounds cut only in null-window nodes, so the PV stays complete
+    if (beta - alpha == 1 && entry.depth >= depth &&
+        (entry.bound == Bound::EXACT ||
+         (entry.bound == Bound::LOWER && tt_score >= beta) ||
+         (entry.bound == Bound::UPPER && tt_score <= alpha)))
+      return tt_score;
+  }
+
+  const bool forced = b.get_threats(1 - b.get_side_to_move()) > 0;
+  const int n_moves = _generate(ply, false, tt_cell);
+  int best = -INF_SCORE, best_cell = -1;
+  for (int i = 0; i < n_moves; ++i) {
+    const int cell = m_moves[ply][i].second;
+    b.make(cell);
+    if (i == 0) {
+      score = -_search(depth - 1, -beta, -alpha, ply + 1);
+    } else {
+      const int r =
+          !forced && i >= m_params.reduce_after && depth >= 3 ? 1 : 0;
+      score = -_search(depth - 1 - r, -alpha - 1, -alpha, ply + 1);
+      if (score > alpha && !m_aborted && (r > 0 || score < beta))
+        score = -_search(depth - 1, -beta, -alpha, ply + 1);
+    }
+    b.unmake();
+    if (m_aborted)
+      return 0;
+    if (score > best) {
+      best = score;
+      best_cell = cell;
+      if (score > alpha) {
+        alpha = score;
+        _update_pv(ply, cell);
+        if (alpha >= beta) {
+          ++m_stats.cutoffs;
+          if (i == 0)
+            ++m_stats.first_cutoffs;
+          _add_cutoff(depth, ply, i);
+          break;
+        }
+      }
+    }
+  }
+  if (n_moves == 0)
+    return b.evaluate();
+  if (m_tt) {
+    entry.cell = best_cell;
+    entry.score = score_to_tt(best, ply);
+    entry.depth = depth;
+    entry.bound = best >= beta         ? Bound::LOWER
+                  : best > alpha_orig ? Bound::EXACT
+                                      : Bound::UPPER;
+    m_tt->store(b.get_hash(), entry);
+  }
+  return best;
+}
+
+SearchResult Search::run(const Board &board, const SearchLimits &limits) {
+  const auto start = Clock::now();
+  Board b = board;
+  m_board = &b;
+  m_stop.store(false, std::memory_order_relaxed);
+  m_aborted = false;
+  m_nodes = 0;
+  m_stats = SearchStats();
+  m_max_nodes = limits.nodes;
+  m_has_deadline = limits.time_ms > 0;
+  m_deadline = start + std::chrono::milliseconds(limits.time_ms);
+
+  m_order.prepare(b);
+
+  SearchResult result;
+  m_root_moves.clear();
+  if (!b.is_over()) {
+    _generate(0, true);
+    for (const auto &move : m_moves[0])
+      m_root_moves.push_back({move.second, move.first, {}});
+  }
+  if (!m_root_moves.empty()) {
+    const int cell = m_root_moves[0].cell;
+    result.move = {b.get_x(cell), b.get_y(cell)};
+    result.pv = {result.move};
+    result.lines = {{result.move, 0, result.pv}};
+  }
+
+  int max_depth = b.get_max_moves() - b.get_move_no() + 1;
+  if (limits.depth > 0)
+    max_depth = std::min(max_depth, limits.depth);
+  max_depth = std::min(max_depth, MAX_PLY - 1);
+  const int n_lines = std::min<int>(m_multi_pv, m_root_moves.size());
+  // exact scores of the best moves of the iteration, in descending order
+  std::vector<int> top;
+  // iterations in a row which ended with the same best move
+  int stable = 0;
+  int last_best = -1;
+  for (int depth = 1; m_root_moves.size() > 1 && depth <= max_depth;
+       ++depth) {
+    if (_skips_depth(depth) && depth < max_depth)
+      continue;
+    int best = -INF_SCORE, best_cell = -1;
+    m_pv_len[0] = 0;
+    top.clear();
+    for (size_t i = 0; i < m_root_moves.size(); ++i) {
+      auto &root_move = m_root_moves[i];
+      // a move must beat the last of the best lines to become one of them
+      const int alpha =
+          int(top.size()) < n_lines ? -INF_SCORE : top[n_lines - 1];
+      b.make(root_move.cell);
+      int score;
+      if (alpha == -INF_SCORE) {
+        score = -_search(depth - 1, -INF_SCORE, INF_SCORE, 1);
+      } else {
+        score = -_search(depth - 1, -alpha - 1, -alpha, 1);
+        if (score > alpha && !m_aborted)
+          score = -_search(depth - 1, -INF_SCORE, -alpha, 1);
+      }
+      b.unmake();
+      if (m_aborted)
+        break;
+      root_move.score = score;
+      if (score > alpha) {
+        top.insert(std::upper_bound(top.begin(), top.end(), score,
+                                    std::greater<int>()),
+                   score);
+        if (n_lines > 1) {
+          root_move.pv.assign(1, root_move.cell);
+          root_move.pv.insert(root_move.pv.end(), m_pv[1] + 1,
+                              m_pv[1] + m_pv_len[1]);
+        }
+      }
+      if (score > best) {
+        best = score;
+        best_cell = root_move.cell;
+        _update_pv(0, root_move.cell);
+      }
+    }
+    if (best_cell < 0)
+      break;
+    // a move which beats the previous best in an unfinished iteration is
+    // still better than the result of the previous one
+    result.move = {b.get_x(best_cell), b.get_y(best_cell)};
+    result.score = best;
+    result.pv.clear();
+    for (int i = 0; i < m_pv_len[0]; ++i)
+      result.pv.push_back({b.get_x(m_pv[0][i]), b.get_y(m_pv[0][i])});
+    if (m_aborted)
+      break;
+    result.depth = depth;
+    m_stats.iterations.push_back(
+        {depth, best, m_nodes,
+         int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                 Clock::now() - start)
+                 .count()),
+         result.move});
+    if (m_tt) {
+      TTEntry entry;
+      entry.cell = best_cell;
+      entry.score = best;
+      entry.depth = depth;
+      entry.bound = Bound::EXACT;
+      m_tt->store(b.get_hash(), entry);
+    }
+    std::stable_sort(
+        m_root_moves.begin(), m_root_moves.end(),
+        [](const RootMove &a, const RootMove &b) { return a.score > b.score; });
+    if (n_lines > 1) {
+      result.lines.clear();
+      for (int i = 0; i < n_lines; ++i) {
+        const auto &root_move = m_root_moves[i];
+        SearchLine line;
+        line.move = {b.get_x(root_move.cell), b.get_y(root_move.cell)};
+        line.score = root_move.score;
+        for (int cell : root_move.pv)
+          line.pv.push_back({b.get_x(cell), b.get_y(cell)});
+        result.lines.push_back(std::move(line));
+      }
+    } else {
+      result.lines = {{result.move, result.score, result.pv}};
+    }
+    if (m_observer) {
+      result.nodes = m_nodes;
+      result.time_ms = m_stats.iterations.back().time_ms;
+      m_observer->on_iteration(result);
+    }
+    if (is_win_score(best))
+      break;
+    stable = best_cell == last_best ? stable + 1 : 0;
+    last_best = best_cell;
+    if (limits.soft_time_ms > 0) {
+      const double elapsed =
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count();
+      if (elapsed >= limits.soft_time_ms * stability_scale(stable))
+        break;
+    }
+    if (Clock::now().time_since_epoch().count() >=
+        m_shared_soft_deadline.load(std::memory_order_relaxed))
+      break;
+  }
+  result.nodes = m_nodes;
+  result.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       Clock::now() - start)
+                       .count();
+  m_stats.nodes = m_nodes;
+  m_stats.depth = result.depth;
+  m_stats.time_ms = result.time_ms;
+  result.stats = std::move(m_stats);
+  m_board = nullptr;
+  return result;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+#include "move_order.hpp"
+#include "search_stats.hpp"
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ttt::engine {
+
+// Scores of won positions are WIN_SCORE minus the number of plies to the end
+// of the game, so faster wins are preferred.
+const int WIN_SCORE = 1000000;
+const int MAX_PLY = 128;
+
+inline bool is_win_score(int score) {
+  return score >= WIN_SCORE - MAX_PLY || score <= -WIN_SCORE + MAX_PLY;
+}
+
+struct SearchParams {
+  // number of best ordered moves searched in inner nodes, 0 for all
+  int max_width = 20;
+  // moves after this number are searched with reduced depth first
+  int reduce_after = 4;
+  int tempo = 16;
+};
+
+// Zero values mean no limit.
+struct SearchLimits {
+  int time_ms = 0;
+  int64_t nodes = 0;
+  int depth = 0;
+  // no new iteration starts after this time, scaled by `stability_scale`
+  int soft_time_ms = 0;
+};
+
+// Root move with its exact score and principal variation.
+struct SearchLine {
+  game::Point move = {-1, -1};
+  int score = 0;
+  std::vector<game::Point> pv;
+};
+
+struct SearchResult {
+  game::Point move = {-1, -1};
+  int score = 0;
+  // last fully searched depth
+  int depth = 0;
+  int64_t nodes = 0;
+  int time_ms = 0;
+  std::vector<game::Point> pv;
+  // best root moves of the last full iteration, see `Search::set_multi_pv`
+  std::vector<SearchLine> lines;
+  SearchStats stats;
+};
+
+// Gets the result of every finished iteration, called by the thread of the
+// search.
+class IIterationObserver {
+public:
+  virtual ~IIterationObserver() = default;
+  virtual void on_iteration(const SearchResult &result) = 0;
+};
+
+// Iterative deepening principal variation search over `Board`. The object
+// keeps its buffers between calls, one object must be used by one thread at
+// a time, but `stop` can be called from any thread.
+class Search {
+public:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  struct RootMove {
+    int cell;
+    int score;
+    // cells of the principal variation of the move, with multi-PV only
+    std::vector<int> pv;
+  };
+
+  static const Clock::rep NO_DEADLINE =
+      std::numeric_limits<Clock::rep>::max();
+
+  SearchParams m_params;
+  // helpers of a parallel search skip some depths, 0 is the main search
+  int m_helper_id = 0;
+  int m_multi_pv = 1;
+  IIterationObserver *m_observer = nullptr;
+  Board *m_board = nullptr;
+  TranspositionTable *m_tt = nullptr;
+  std::atomic<bool> m_stop{false};
+  // stop flag of a group of searches, checked together with the own one
+  const std::atomic<bool> *m_group_stop = nullptr;
+  bool m_aborted = false;
+  int64_t m_nodes = 0;
+  // counted by this search only, `m_nodes` is copied at the end
+  SearchStats m_stats;
+  int64_t m_max_nodes = 0;
+  Clock::time_point m_deadline;
+  bool m_has_deadline = false;
+  // deadlines set from outside the search in clock ticks, kept between runs
+  std::atomic<Clock::rep> m_shared_deadline{NO_DEADLINE};
+  std::atomic<Clock::rep> m_shared_soft_deadline{NO_DEADLINE};
+  std::vector<RootMove> m_root_moves;
+  // ordering scores and cells of the moves of every ply
+  std::vector<std::pair<int, int>> m_moves[MAX_PLY];
+  std::vector<int> m_cells;
+  // learnt from the cutoffs of this and the previous searches
+  MoveOrder m_order{MAX_PLY};
+  int m_pv[MAX_PLY][MAX_PLY];
+  int m_pv_len[MAX_PLY];
+
+public:
+  Search(const SearchParams &params = {}) : m_params(params) {}
+
+  const SearchParams &get_params() const { return m_params; }
+  void set_params(const SearchParams &params) { m_params = params; }
+
+  // The table may be shared with other searches, the owner calls
+  // `TranspositionTable::new_search` before each move.
+  void set_table(TranspositionTable *tt) { m_tt = tt; }
+  void set_helper_id(int id) { m_helper_id = id; }
+  void set_group_stop(const std::atomic<bool> *flag) { m_group_stop = flag; }
+  // Number of best root moves which get exact scores and principal
+  // variations. Moves after the first are searched with windows down to the
+  // score of the last of them, so more lines cost more nodes.
+  void set_multi_pv(int n_lines) { m_multi_pv = std::max(n_lines, 1); }
+  int get_multi_pv() const { return m_multi_pv; }
+  void set_iteration_observer(IIterationObserver *observer) {
+    m_observer = observer;
+  }
+  // The tables are aged by every run and cleared for another field, a new
+  // game may clear them explicitly.
+  MoveOrder &get_move_order() { return m_order; }
+
+  SearchResult run(const Board &board, const SearchLimits &limits);
+  void stop() { m_stop.store(true, std::memory_order_relaxed); }
+
+  // Sets a deadline for the running and the following searches in addition
+  // to their limits, e.g. when a ponder search becomes the search of the
+  // move. Unlike `stop` it cannot be lost by a search which is just starting.
+  void set_deadline(Clock::time_point deadline) {
+    m_shared_deadline.store(deadline.time_since_epoch().count(),
+                            std::memory_order_relaxed);
+  }
+  // Like `set_deadline`, but no new iteration starts after the deadline.
+  void set_soft_deadline(Clock::time_point deadline) {
+    m_shared_soft_deadline.store(deadline.time_since_epoch().count(),
+                                 std::memory_order_relaxed);
+  }
+  void clear_deadline() {
+    m_shared_deadline.store(NO_DEADLINE, std::memory_order_relaxed);
+    m_shared_soft_deadline.store(NO_DEADLINE, std::memory_order_relaxed);
+  }
+
+private:
+  int _search(int depth, int alpha, int beta, int ply);
+  int _qsearch(int alpha, int beta, int ply);
+  bool _probe_end(int ply, int &score);
+  int _generate(int ply, bool root, int tt_cell = -1);
+  void _add_cutoff(int depth, int ply, int index);
+  bool _check_limits();
+  bool _skips_depth(int depth) const;
+  void _update_pv(int ply, int cell);
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,48 @@
+#include "search_stats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace ttt::engine {
+
+void SearchStats::add_counters(const SearchStats &other) {
+  nodes += other.nodes;
+  qnodes += other.qnodes;
+  tt_probes += other.tt_probes;
+  tt_hits += other.tt_hits;
+  cutoffs += other.cutoffs;
+  first_cutoffs += other.first_cutoffs;
+}
+
+void write_stats(std::ostream &out, const SearchStats &stats) {
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed << std::setprecision(1) << "depth " << stats.depth
+      << " time " << stats.time_ms << " ms nodes " << stats.nodes << " (q "
+      << stats.qnodes << ") knps " << stats.get_nps() / 1000 << " tt hits "
+      << stats.get_tt_hit_rate() * 100 << "% first cutoffs "
+      << stats.get_first_cutoff_rate() * 100 << '%';
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void SearchStatsLog::on_search(const SearchStats &stats) {
+  m_out << "search " << ++m_n_searches << ": ";
+  write_stats(m_out, stats);
+  m_out << '\n';
+  for (const auto &it : stats.iterations)
+    m_out << "  depth " << it.depth << " score " << it.score << " nodes "
+          << it.nodes << " time " << it.time_ms << " ms\n";
+  m_out.flush();
+}
+
+void SearchStatsTotal::on_search(const SearchStats &stats) {
+  m_total.add_counters(stats);
+  m_total.time_ms += stats.time_ms;
+  m_total.depth = std::max(m_total.depth, stats.depth);
+  m_depth_sum += stats.depth;
+  ++m_n_searches;
+}
+
+}; // namespace ttt::engine
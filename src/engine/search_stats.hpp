@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace ttt::engine {
+
+struct IterationStats {
+  int depth = 0;
+  int score = 0;
+  // counted from the start of the search
+  int64_t nodes = 0;
+  int time_ms = 0;
+  game::Point move = {-1, -1};
+};
+
+// Counters of one search. Every search thread counts into its own object
+// without synchronization, a parallel search adds them up when the helpers
+// have stopped.
+struct SearchStats {
+  // all nodes including the quiescence ones
+  int64_t nodes = 0;
+  int64_t qnodes = 0;
+  int64_t tt_probes = 0;
+  int64_t tt_hits = 0;
+  // beta cutoffs in the main search and the part of them by the first move
+  int64_t cutoffs = 0;
+  int64_t first_cutoffs = 0;
+  // last fully searched depth
+  int depth = 0;
+  int time_ms = 0;
+  // finished iterations of the main search
+  std::vector<IterationStats> iterations;
+
+  // Adds the counters of a helper, depth and iterations stay.
+  void add_counters(const SearchStats &other);
+
+  double get_nps() const {
+    return time_ms > 0 ? nodes * 1000.0 / time_ms : 0;
+  }
+  double get_tt_hit_rate() const {
+    return tt_probes > 0 ? double(tt_hits) / tt_probes : 0;
+  }
+  double get_first_cutoff_rate() const {
+    return cutoffs > 0 ? double(first_cutoffs) / cutoffs : 0;
+  }
+};
+
+// One line: depth, time, nodes, node rate, TT hits and first-move cutoffs.
+void write_stats(std::ostream &out, const SearchStats &stats);
+
+// Receives the statistics of every search of a move, in the thread of the
+// player.
+class ISearchObserver {
+public:
+  virtual ~ISearchObserver() = default;
+  virtual void on_search(const SearchStats &stats) = 0;
+};
+
+// Writes a line for every move.
+class SearchStatsLog : public ISearchObserver {
+  std::ostream &m_out;
+  int m_n_searches = 0;
+
+public:
+  explicit SearchStatsLog(std::ostream &out) : m_out(out) {}
+  void on_search(const SearchStats &stats) override;
+};
+
+// Sums the statistics of all moves.
+class SearchStatsTotal : public ISearchObserver {
+  SearchStats m_total;
+  int m_n_searches = 0;
+  int64_t m_depth_sum = 0;
+
+public:
+  void on_search(const SearchStats &stats) override;
+
+  // Counters and time are summed, depth is the maximal one.
+  const SearchStats &get_total() const { return m_total; }
+  int get_searches_num() const { return m_n_searches; }
+  double get_average_depth() const {
+    return m_n_searches > 0 ? double(m_depth_sum) / m_n_searches : 0;
+  }
+};
+
+}; // namespace ttt::engine
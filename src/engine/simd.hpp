@@ -0,0 +1,36 @@
+#pragma once
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// SSE2 is a part of x86-64, AVX2 functions are compiled with the target
+// attribute and called after a check of the CPU
+#define TTT_X86_SIMD 1
+#include <immintrin.h>
+#define TTT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace ttt::engine {
+
+// Instruction sets of the vectorised loops.
+enum class SimdIsa { SCALAR, SSE2, AVX2 };
+
+inline const char *to_string(SimdIsa isa) {
+  switch (isa) {
+  case SimdIsa::AVX2:
+    return "avx2";
+  case SimdIsa::SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+// The best instruction set the CPU supports.
+inline SimdIsa get_best_isa() {
+#ifdef TTT_X86_SIMD
+  return __builtin_cpu_supports("avx2") ? SimdIsa::AVX2 : SimdIsa::SSE2;
+#else
+  return SimdIsa::SCALAR;
+#endif
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,78 @@
+#include "suite.hpp"
+
+#include <sstream>
+
+namespace ttt::engine {
+
+bool SuiteEntry::is_solved_by(Point move) const {
+  for (const auto &pt : best)
+    if (pt.x == move.x && pt.y == move.y)
+      return true;
+  return false;
+}
+
+std::string SuiteEntry::get_name() const {
+  const std::string *name = pos.get_tag("name");
+  return name ? *name : "";
+}
+
+bool parse_moves(const std::string &text, std::vector<Point> &moves) {
+  std::istringstream in(text);
+  moves.clear();
+  Point pt;
+  while (in >> pt.x) {
+    if (!(in >> pt.y))
+      return false;
+    moves.push_back(pt);
+  }
+  return in.eof() && !moves.empty();
+}
+
+bool read_suite(std::istream &in, std::vector<SuiteEntry> &suite,
+                const char **error) {
+  auto fail = [&](const char *message) {
+    if (error)
+      *error = message;
+    return false;
+  };
+  if (error)
+    *error = nullptr;
+  Position pos;
+  while (read_position(in, pos, error)) {
+    SuiteEntry entry;
+    entry.state = make_state(pos, error);
+    if (!entry.state)
+      return false;
+    const State &state = *entry.state;
+    const std::string *best = pos.get_tag("best");
+    if (!best)
+      return fail("the position has no best moves");
+    if (!parse_moves(*best, entry.best))
+      return fail("bad best moves");
+    for (const auto &pt : entry.best)
+      if (pt.x < 0 || pt.y < 0 || pt.x >= pos.opts.cols ||
+          pt.y >= pos.opts.rows || state.get_value(pt.x, pt.y) != Sign::NONE)
+        return fail("a best move is not an empty cell");
+    if (state.get_status() == game::Status::ENDED)
+      return fail("the game of the position is over");
+    if (const std::string *side = pos.get_tag("side")) {
+      if (*side != "X" && *side != "O")
+        return fail("bad side to move");
+      const Sign sign = *side == "X" ? Sign::X : Sign::O;
+      if (sign != state.get_current_player())
+        return fail("the side to move does not match the stones");
+    }
+    if (const std::string *status = pos.get_tag("status")) {
+      if (*status != "play" && *status != "last_move")
+        return fail("bad status");
+      const bool last_move = *status == "last_move";
+      if (last_move != (state.get_status() == game::Status::LAST_MOVE))
+        return fail("the status does not match the stones");
+    }
+    entry.pos = std::move(pos);
+    suite.push_back(std::move(entry));
+  }
+  return !error || !*error;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "position.hpp"
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::Point;
+using game::Sign;
+
+/*
+  Test suites are files of positions (see position.hpp) with the tags:
+
+    best 4 1 0 1        moves which solve the position, "x y" pairs
+    side O              side to move, optional
+    status last_move    O has only the last reply to a line of X, the other
+                        status is `play`, optional
+    name open four      name of the position in the reports, optional
+
+  Side to move and status follow from the stones and the last move, the
+  optional tags are checked against them, so a suite fails to load rather
+  than test something else than its author meant.
+*/
+struct SuiteEntry {
+  Position pos;
+  std::unique_ptr<State> state;
+  std::vector<Point> best;
+
+  bool is_solved_by(Point move) const;
+  std::string get_name() const;
+};
+
+// Parses "x y" pairs of a `best` tag. Returns false if the text has anything
+// else or no moves.
+bool parse_moves(const std::string &text, std::vector<Point> &moves);
+
+// Reads all positions of a suite. On errors returns false and sets `error`,
+// the entries read so far are kept, so the bad position is the next one.
+bool read_suite(std::istream &in, std::vector<SuiteEntry> &suite,
+                const char **error = nullptr);
+
+}; // namespace ttt::engine
@@ -0,0 +1,382 @@
+#include "tablebase.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ttt::engine {
+
+using game::Sign;
+
+static int popcount(uint32_t mask) { return __builtin_popcount(mask); }
+
+bool TablebaseIndex::init(int rows, int cols, int win_len, int max_moves,
+                          uint64_t walls, const char **error) {
+  const char *bad = nullptr;
+  if (rows <= 0 || cols <= 0 || rows * cols > 64)
+    bad = "field of a tablebase has at most 64 cells";
+  else if (win_len <= 0)
+    bad = "bad length of the winning line";
+  if (bad) {
+    if (error)
+      *error = bad;
+    return false;
+  }
+  m_rows = rows;
+  m_cols = cols;
+  m_win_len = win_len;
+  m_walls = walls;
+  m_cells.clear();
+  std::vector<int> local(rows * cols, -1);
+  for (int i = 0; i < rows * cols; ++i) {
+    if ((walls >> i) & 1)
+      continue;
+    local[i] = m_cells.size();
+    m_cells.push_back(i);
+  }
+  const int n = m_cells.size();
+  if (n > TB_MAX_CELLS) {
+    if (error)
+      *error = "too many playable cells for a tablebase";
+    return false;
+  }
+  m_max_moves = max_moves <= 0 ? n : std::min(max_moves, n);
+
+  // windows of the line length which do not cross walls or edges
+  m_lines.clear();
+  const int dx[4] = {1, 0, 1, 1}, dy[4] = {0, 1, 1, -1};
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < cols; ++x) {
+      for (int d = 0; d < 4; ++d) {
+        uint32_t line = 0;
+        int k = 0;
+        for (; k < win_len; ++k) {
+          const int cx = x + k * dx[d], cy = y + k * dy[d];
+          if (cx < 0 || cx >= cols || cy < 0 || cy >= rows ||
+              local[cy * cols + cx] < 0)
+            break;
+          line |= 1u << local[cy * cols + cx];
+        }
+        if (k == win_len)
+          m_lines.push_back(line);
+      }
+    }
+  }
+
+  for (int i = 0; i <= TB_MAX_CELLS; ++i) {
+    m_binom[i][0] = 1;
+    for (int j = 1; j <= i; ++j)
+      m_binom[i][j] = m_binom[i - 1][j - 1] + (j < i ? m_binom[i - 1][j] : 0);
+  }
+  m_offsets[0] = 0;
+  for (int k = 0; k <= n; ++k)
+    m_offsets[k + 1] = (m_offsets[k] + get_group_size(k) + 3) / 4 * 4;
+  return true;
+}
+
+bool TablebaseIndex::init(const State &state, const char **error) {
+  const auto &opts = state.get_opts();
+  if (opts.rows * opts.cols > 64) {
+    if (error)
+      *error = "field of a tablebase has at most 64 cells";
+    return false;
+  }
+  uint64_t walls = 0;
+  for (int y = 0; y < opts.rows; ++y)
+    for (int x = 0; x < opts.cols; ++x)
+      if (state.get_value(x, y) == Sign::WALL)
+        walls |= 1ull << (y * opts.cols + x);
+  return init(opts.rows, opts.cols, opts.win_len, opts.max_moves, walls,
+              error);
+}
+
+uint64_t TablebaseIndex::get_group_size(int n_stones) const {
+  return m_binom[m_cells.size()][n_stones] *
+         m_binom[n_stones][(n_stones + 1) / 2];
+}
+
+// colex rank: the sum of C(p_i, i) over the elements p_1 < p_2 < ...
+uint64_t TablebaseIndex::_rank(uint32_t set) const {
+  uint64_t rank = 0;
+  for (int i = 1; set; ++i, set &= set - 1)
+    rank += m_binom[__builtin_ctz(set)][i];
+  return rank;
+}
+
+uint32_t TablebaseIndex::_unrank(uint64_t rank, int size,
+                                 int universe) const {
+  uint32_t set = 0;
+  int p = universe - 1;
+  for (int i = size; i > 0; --i) {
+    while (p >= i && m_binom[p][i] > rank)
+      --p;
+    // C(p, i) is 0 for p < i, the elements below p are the first ones
+    set |= 1u << p;
+    rank -= p >= i ? m_binom[p][i] : 0;
+    --p;
+  }
+  return set;
+}
+
+uint64_t TablebaseIndex::index(uint32_t x, uint32_t o) const {
+  const uint32_t occupied = x | o;
+  const int k = popcount(occupied);
+  // the stones of X as a subset of the occupied cells
+  uint32_t x_part = 0;
+  int j = 0;
+  for (uint32_t set = occupied; set; set &= set - 1, ++j)
+    if (x & set & -set)
+      x_part |= 1u << j;
+  return m_offsets[k] + _rank(occupied) * m_binom[k][(k + 1) / 2] +
+         _rank(x_part);
+}
+
+void TablebaseIndex::unindex(int n_stones, uint64_t rank, uint32_t &x,
+                             uint32_t &o) const {
+  const int n_x = (n_stones + 1) / 2;
+  const uint64_t n_parts = m_binom[n_stones][n_x];
+  const uint32_t occupied =
+      _unrank(rank / n_parts, n_stones, m_cells.size());
+  const uint32_t x_part = _unrank(rank % n_parts, n_x, n_stones);
+  x = 0;
+  int j = 0;
+  for (uint32_t set = occupied; set; set &= set - 1, ++j)
+    if ((x_part >> j) & 1)
+      x |= set & -set;
+  o = occupied & ~x;
+}
+
+bool TablebaseIndex::has_line(uint32_t stones) const {
+  for (uint32_t line : m_lines)
+    if ((stones & line) == line)
+      return true;
+  return false;
+}
+
+ProofValue TablebaseIndex::get_terminal(uint32_t x, uint32_t o) const {
+  const int k = popcount(x | o);
+  const bool x_line = has_line(x), o_line = has_line(o);
+  if (k % 2 == 1) {
+    // O to move
+    if (o_line)
+      return ProofValue::WIN;
+    if (x_line)
+      return k < m_max_moves ? ProofValue::UNKNOWN : ProofValue::LOSS;
+  } else {
+    // X to move: O has replied to a line of X or completed its own
+    if (x_line)
+      return o_line ? ProofValue::DRAW : ProofValue::WIN;
+    if (o_line)
+      return ProofValue::LOSS;
+  }
+  return k < m_max_moves ? ProofValue::UNKNOWN : ProofValue::DRAW;
+}
+
+bool TablebaseIndex::fits(const Board &board) const {
+  if (board.get_rows() != m_rows || board.get_cols() != m_cols ||
+      board.get_win_len() != m_win_len ||
+      board.get_max_moves() != m_max_moves)
+    return false;
+  for (int y = 0; y < m_rows; ++y)
+    for (int x = 0; x < m_cols; ++x)
+      if ((board.at(board.index(x, y)) == WALL) !=
+          bool((m_walls >> (y * m_cols + x)) & 1))
+        return false;
+  return true;
+}
+
+void TablebaseIndex::get_stones(const Board &board, uint32_t &x,
+                                uint32_t &o) const {
+  x = o = 0;
+  for (size_t i = 0; i < m_cells.size(); ++i) {
+    const int cell = board.index(m_cells[i] % m_cols, m_cells[i] / m_cols);
+    if (board.at(cell) == X_STONE)
+      x |= 1u << i;
+    else if (board.at(cell) == O_STONE)
+      o |= 1u << i;
+  }
+}
+
+bool TablebaseBuilder::init(const State &state, const char **error) {
+  if (!m_index.init(state, error))
+    return false;
+  m_values.assign((m_index.get_entries_num() + 3) / 4, 0);
+  return true;
+}
+
+// The moves lead to the next group, which is solved.
+void TablebaseBuilder::_solve(int n_stones, uint64_t begin, uint64_t end) {
+  const int n = m_index.get_cells_num();
+  const uint64_t group = m_index.get_group_begin(n_stones);
+  const uint32_t all = (1u << n) - 1;
+  for (uint64_t rank = begin; rank < end; ++rank) {
+    uint32_t x, o;
+    m_index.unindex(n_stones, rank, x, o);
+    ProofValue value = m_index.get_terminal(x, o);
+    if (value == ProofValue::UNKNOWN) {
+      value = ProofValue::LOSS;
+      for (uint32_t free = all & ~(x | o); free; free &= free - 1) {
+        const uint32_t stone = free & -free;
+        const ProofValue reply = get_value(
+            n_stones % 2 ? m_index.index(x, o | stone)
+                         : m_index.index(x | stone, o));
+        if (reply == ProofValue::LOSS) {
+          value = ProofValue::WIN;
+          break;
+        }
+        if (reply == ProofValue::DRAW)
+          value = ProofValue::DRAW;
+      }
+    }
+    const uint64_t entry = group + rank;
+    m_values[entry / 4] |= uint8_t(value) << (2 * (entry % 4));
+  }
+}
+
+void TablebaseBuilder::generate(int n_threads) {
+  std::fill(m_values.begin(), m_values.end(), 0);
+  // groups start at whole bytes, so chunks of a multiple of four entries
+  // never share a byte
+  const uint64_t chunk = 1 << 12;
+  for (int k = m_index.get_max_moves(); k >= 0; --k) {
+    const uint64_t size = m_index.get_group_size(k);
+    std::atomic<uint64_t> next{0};
+    auto worker = [&]() {
+      for (uint64_t begin = next.fetch_add(chunk); begin < size;
+           begin = next.fetch_add(chunk))
+        _solve(k, begin, std::min(size, begin + chunk));
+    };
+    const int n = int(std::min<uint64_t>(std::max(1, n_threads),
+                                         (size + chunk - 1) / chunk));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < n; ++i)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+      thread.join();
+  }
+}
+
+bool TablebaseBuilder::save(const char *path) const {
+  TablebaseHeader hdr{};
+  std::memcpy(hdr.magic, TB_MAGIC, sizeof(hdr.magic));
+  hdr.version = TB_VERSION;
+  hdr.rows = m_index.get_rows();
+  hdr.cols = m_index.get_cols();
+  hdr.win_len = m_index.get_win_len();
+  hdr.max_moves = m_index.get_max_moves();
+  hdr.walls = m_index.get_walls();
+  hdr.n_entries = m_index.get_entries_num();
+  std::FILE *file = std::fopen(path, "wb");
+  if (!file)
+    return false;
+  bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+  ok = ok && std::fwrite(m_values.data(), 1, m_values.size(), file) ==
+                 m_values.size();
+  return std::fclose(file) == 0 && ok;
+}
+
+Tablebase::~Tablebase() { close(); }
+
+bool Tablebase::open(const char *path, const char **error) {
+  close();
+  const char *bad = nullptr;
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    if (error)
+      *error = "cannot open tablebase";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(TablebaseHeader)) {
+    ::close(fd);
+    if (error)
+      *error = "tablebase is too small";
+    return false;
+  }
+  m_size = st.st_size;
+  void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    if (error)
+      *error = "cannot map tablebase";
+    return false;
+  }
+  m_data = static_cast<const char *>(data);
+  const auto *hdr = reinterpret_cast<const TablebaseHeader *>(m_data);
+  if (std::memcmp(hdr->magic, TB_MAGIC, sizeof(TB_MAGIC)) != 0)
+    bad = "bad tablebase magic";
+  else if (hdr->version != TB_VERSION)
+    bad = "unsupported tablebase version";
+  else if (m_index.init(hdr->rows, hdr->cols, hdr->win_len, hdr->max_moves,
+                        hdr->walls, &bad) &&
+           (hdr->n_entries != m_index.get_entries_num() ||
+            m_size != sizeof(TablebaseHeader) + (hdr->n_entries + 3) / 4))
+    bad = "tablebase size does not match its field";
+  if (bad) {
+    close();
+    if (error)
+      *error = bad;
+    return false;
+  }
+  m_values = reinterpret_cast<const uint8_t *>(hdr + 1);
+  return true;
+}
+
+void Tablebase::close() {
+  if (m_data)
+    munmap(const_cast<char *>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+  m_values = nullptr;
+}
+
+ProofValue Tablebase::_get(uint32_t x, uint32_t o) const {
+  const uint64_t entry = m_index.index(x, o);
+  return ProofValue((m_values[entry / 4] >> (2 * (entry % 4))) & 3);
+}
+
+ProofValue Tablebase::probe(const Board &board) const {
+  if (!fits(board))
+    return ProofValue::UNKNOWN;
+  uint32_t x, o;
+  m_index.get_stones(board, x, o);
+  return _get(x, o);
+}
+
+bool Tablebase::find_move(const Board &board, Point &move) const {
+  if (!fits(board) || board.is_over())
+    return false;
+  uint32_t x, o;
+  m_index.get_stones(board, x, o);
+  const int side = board.get_side_to_move();
+  int best = -1, best_cell = -1;
+  for (int i = 0; i < m_index.get_cells_num(); ++i) {
+    const uint32_t stone = 1u << i;
+    if ((x | o) & stone)
+      continue;
+    const ProofValue reply = side == 0 ? _get(x | stone, o)
+                                       : _get(x, o | stone);
+    // the value of the reply is that of the opponent
+    const int score = reply == ProofValue::LOSS   ? 2
+                      : reply == ProofValue::DRAW ? 1
+                                                  : 0;
+    if (score > best) {
+      best = score;
+      best_cell = m_index.get_cell(i);
+    }
+  }
+  if (best_cell < 0)
+    return false;
+  move = {best_cell % m_index.get_cols(), best_cell / m_index.get_cols()};
+  return true;
+}
+
+}; // namespace ttt::engine
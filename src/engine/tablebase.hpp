@@ -0,0 +1,156 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+#include "proof_solver.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ttt::engine {
+
+using game::Point;
+using game::State;
+
+/*
+  Tablebase file layout (all integers are little-endian):
+
+    TablebaseHeader
+    uint8_t values[(n_entries + 3) / 4]
+
+  A tablebase holds the values of all positions of one field: its size,
+  walls, length of the winning line and limit of moves. The playable cells
+  are numbered row by row. Positions are grouped by the number of stones k,
+  every group starts at a multiple of four entries. Inside a group the index
+  of a position is rank(occupied cells) * C(k, ceil(k / 2)) + rank(cells of
+  X among the occupied ones), where ranks are those of the combinatorial
+  number system. An entry takes two bits of `ProofValue` for the side to
+  move, entry i is in bits 2 * (i % 4) of byte i / 4. Positions which cannot
+  be reached in a game may hold any value.
+*/
+
+static const char TB_MAGIC[8] = {'T', 'T', 'T', 'T', 'B', 'A', 'S', '1'};
+static const uint32_t TB_VERSION = 1;
+// positions of 20 cells take 177 MB
+const int TB_MAX_CELLS = 20;
+
+struct TablebaseHeader {
+  char magic[8];
+  uint32_t version;
+  uint8_t rows;
+  uint8_t cols;
+  uint8_t win_len;
+  uint8_t max_moves;
+  // bit y * cols + x is set for a wall
+  uint64_t walls;
+  uint64_t n_entries;
+};
+
+// Numbering of the positions of a field and the game rules on it. Positions
+// are pairs of masks of the stones of X and O over the playable cells.
+class TablebaseIndex {
+  int m_rows = 0;
+  int m_cols = 0;
+  int m_win_len = 0;
+  int m_max_moves = 0;
+  uint64_t m_walls = 0;
+  // field cells y * cols + x of the playable cells
+  std::vector<int> m_cells;
+  std::vector<uint32_t> m_lines;
+  uint64_t m_binom[TB_MAX_CELLS + 1][TB_MAX_CELLS + 1] = {};
+  uint64_t m_offsets[TB_MAX_CELLS + 2] = {};
+
+public:
+  // Fields of at most 64 cells with at most TB_MAX_CELLS playable ones.
+  bool init(int rows, int cols, int win_len, int max_moves, uint64_t walls,
+            const char **error = nullptr);
+  // Field of the state, its stones are ignored.
+  bool init(const State &state, const char **error = nullptr);
+
+  int get_rows() const { return m_rows; }
+  int get_cols() const { return m_cols; }
+  int get_win_len() const { return m_win_len; }
+  int get_max_moves() const { return m_max_moves; }
+  uint64_t get_walls() const { return m_walls; }
+  int get_cells_num() const { return m_cells.size(); }
+  int get_cell(int i) const { return m_cells[i]; }
+  uint64_t get_entries_num() const { return m_offsets[m_cells.size() + 1]; }
+  // Entries of the positions with `n_stones` stones.
+  uint64_t get_group_begin(int n_stones) const { return m_offsets[n_stones]; }
+  uint64_t get_group_size(int n_stones) const;
+
+  uint64_t index(uint32_t x, uint32_t o) const;
+  // Position of the entry `rank` of the group of `n_stones` stones.
+  void unindex(int n_stones, uint64_t rank, uint32_t &x, uint32_t &o) const;
+  // Value of a finished game for the side to move, UNKNOWN while it goes
+  // on. X who has completed a line before the limit of moves leaves O the
+  // last reply.
+  ProofValue get_terminal(uint32_t x, uint32_t o) const;
+  bool has_line(uint32_t stones) const;
+
+  // Whether the board has the field of the tablebase and its stones.
+  bool fits(const Board &board) const;
+  void get_stones(const Board &board, uint32_t &x, uint32_t &o) const;
+
+private:
+  uint64_t _rank(uint32_t set) const;
+  uint32_t _unrank(uint64_t rank, int size, int universe) const;
+};
+
+// Solves all positions of a field by retrograde analysis: the groups of
+// positions are solved from the full field down to the empty one, every
+// position by the values of the positions after its moves. The positions of
+// a group are split between threads.
+class TablebaseBuilder {
+  TablebaseIndex m_index;
+  std::vector<uint8_t> m_values;
+
+public:
+  bool init(const State &state, const char **error = nullptr);
+  void generate(int n_threads = 1);
+  bool save(const char *path) const;
+
+  const TablebaseIndex &get_index() const { return m_index; }
+  ProofValue get_value(uint64_t entry) const {
+    return ProofValue((m_values[entry / 4] >> (2 * (entry % 4))) & 3);
+  }
+
+private:
+  void _solve(int n_stones, uint64_t begin, uint64_t end);
+};
+
+// Memory-mapped tablebase.
+class Tablebase {
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  const uint8_t *m_values = nullptr;
+  TablebaseIndex m_index;
+
+public:
+  Tablebase() = default;
+  Tablebase(const Tablebase &) = delete;
+  Tablebase &operator=(const Tablebase &) = delete;
+  ~Tablebase();
+
+  bool open(const char *path, const char **error = nullptr);
+  void close();
+
+  bool is_open() const { return m_data != nullptr; }
+  const TablebaseIndex &get_index() const { return m_index; }
+  bool fits(const Board &board) const {
+    return is_open() && m_index.fits(board);
+  }
+
+  // Value for the side to move, UNKNOWN for other fields.
+  ProofValue probe(const Board &board) const;
+  ProofValue probe(const State &state) const { return probe(Board(state)); }
+  // A move which keeps the value of the position, any move of a lost one.
+  // Returns false for other fields and finished games.
+  bool find_move(const Board &board, Point &move) const;
+
+private:
+  ProofValue _get(uint32_t x, uint32_t o) const;
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,225 @@
+#include "threat_solver.hpp"
+
+#include <algorithm>
+
+namespace ttt::engine {
+
+static const int MAX_DEPTH = 63;
+
+bool ThreatSolver::_check_limits() {
+  if (m_max_nodes > 0 && m_nodes >= m_max_nodes)
+    return true;
+  return m_has_deadline && Clock::now() >= m_deadline;
+}
+
+void ThreatSolver::_attacking_moves(int ply) {
+  const Board &b = *m_board;
+  const int att = m_attacker, def = 1 - att;
+  const int fours_at = b.get_win_len() - 2, threes_at = b.get_win_len() - 3;
+  const bool threes = m_mode == ThreatMode::VCT && threes_at > 0;
+  auto &moves = m_moves[ply];
+  moves.clear();
+  if (b.get_threats(def) > 0) {
+    // the attacker has to block, which only goes on if it threatens too
+    const int cell = b.find_winning_cell(def);
+    if (b.get_winning_windows(cell, def) != b.get_threats(def))
+      return;
+    if (b.count_windows(cell, att, fours_at) > 0 ||
+        (threes && b.count_windows(cell, att, threes_at) >= 2))
+      moves.emplace_back(0, cell);
+    return;
+  }
+  for (int y = 0; y < b.get_rows(); ++y) {
+    for (int x = 0; x < b.get_cols(); ++x) {
+      const int cell = b.index(x, y);
+      if (!b.is_empty(cell))
+        continue;
+      const int n_fours = b.count_windows(cell, att, fours_at);
+      const int n_threes = threes ? b.count_windows(cell, att, threes_at) : 0;
+      // fours go first, a three must be made in two windows at once
+      if (n_fours > 0)
+        moves.emplace_back(1000 * n_fours + n_threes, cell);
+      else if (n_threes >= 2)
+        moves.emplace_back(n_threes, cell);
+    }
+  }
+  std::sort(moves.begin(), moves.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+}
+
+void ThreatSolver::_defending_moves(int ply) {
+  const Board &b = *m_board;
+  const int att = m_attacker, def = 1 - att;
+  // a four has to be blocked, a three can be blocked at any of its cells;
+  // counter fours of the defender are an answer to both
+  const bool four = b.get_threats(att) > 0;
+  const int three_at = b.get_win_len() - 2;
+  auto &moves = m_moves[ply];
+  moves.clear();
+  for (int y = 0; y < b.get_rows(); ++y) {
+    for (int x = 0; x < b.get_cols(); ++x) {
+      const int cell = b.index(x, y);
+      if (!b.is_empty(cell))
+        continue;
+      const bool block = four ? b.is_winning_cell(cell, att)
+                              : b.count_windows(cell, att, three_at) > 0;
+      if (block)
+        moves.emplace_back(1, cell);
+      else if (b.makes_threat(cell, def))
+        moves.emplace_back(0, cell);
+    }
+  }
+  std::stable_sort(
+      moves.begin(), moves.end(),
+      [](const auto &a, const auto &b) { return a.first > b.first; });
+}
+
+bool ThreatSolver::_attack(int depth, int ply) {
+  if ((++m_nodes & 255) == 0 && _check_limits())
+    m_aborted = true;
+  if (m_aborted)
+    return false;
+  Board &b = *m_board;
+  const uint64_t hash = b.get_hash();
+  const int win = b.find_winning_move();
+  if (win >= 0) {
+    m_wins[hash] = win;
+    return true;
+  }
+  if (depth == 0 || b.is_over() || b.is_last_move())
+    return false;
+  const auto it = m_fails.find(hash);
+  if (it != m_fails.end() && it->second >= depth)
+    return false;
+  _attacking_moves(ply);
+  for (const auto &move : m_moves[ply]) {
+    b.make(move.second);
+    const bool wins = _defend(depth - 1, ply + 1);
+    b.unmake();
+    if (m_aborted)
+      return false;
+    if (wins) {
+      m_wins[hash] = move.second;
+      return true;
+    }
+  }
+  int &failed = m_fails[hash];
+  failed = std::max(failed, depth);
+  return false;
+}
+
+bool ThreatSolver::_defend(int depth, int ply) {
+  if ((++m_nodes & 255) == 0 && _check_limits())
+    m_aborted = true;
+  if (m_aborted)
+    return false;
+  Board &b = *m_board;
+  const int att = m_attacker, def = 1 - att;
+  switch (b.get_outcome()) {
+  case Outcome::NONE:
+    break;
+  case Outcome::X_WINS:
+    return att == 0;
+  case Outcome::O_WINS:
+    return att == 1;
+  case Outcome::DRAW:
+    return false;
+  }
+  // the attacker has completed a line of X and O has the last reply
+  if (b.is_last_move())
+    return b.get_last_move_outcome() == Outcome::X_WINS;
+  // a line of the defender wins or at least draws by the last reply
+  if (b.get_threats(def) > 0)
+    return false;
+  _defending_moves(ply);
+  if (m_moves[ply].empty())
+    return false;
+  for (const auto &move : m_moves[ply]) {
+    b.make(move.second);
+    const bool wins = _attack(depth, ply + 1);
+    b.unmake();
+    if (m_aborted || !wins)
+      return false;
+  }
+  return true;
+}
+
+ThreatResult ThreatSolver::solve(const Board &board, ThreatMode mode,
+                                 const ThreatLimits &limits) {
+  Board b = board;
+  m_board = &b;
+  m_mode = mode;
+  m_attacker = b.get_side_to_move();
+  m_nodes = 0;
+  m_max_nodes = limits.nodes;
+  m_has_deadline = limits.time_ms > 0;
+  m_deadline = Clock::now() + std::chrono::milliseconds(limits.time_ms);
+  m_aborted = false;
+  m_wins.clear();
+  m_fails.clear();
+
+  ThreatResult result;
+  const int max_depth = std::min(limits.depth, MAX_DEPTH);
+  for (int depth = 1; !b.is_over() && depth <= max_depth; ++depth) {
+    if (_attack(depth, 0)) {
+      result.win = true;
+      break;
+    }
+    if (m_aborted)
+      break;
+  }
+  result.nodes = m_nodes;
+  result.aborted = m_aborted;
+  if (!result.win) {
+    m_board = nullptr;
+    return result;
+  }
+
+  // replay the proof: moves of the attacker are stored, the defender plays
+  // the first reply after which the attack is proven
+  int n_made = 0;
+  for (int ply = 0; ply < 2 * max_depth + 2; ply += 2) {
+    const auto it = m_wins.find(b.get_hash());
+    if (it == m_wins.end())
+      break;
+    result.sequence.push_back({b.get_x(it->second), b.get_y(it->second)});
+    b.make(it->second);
+    ++n_made;
+    if (b.is_over() || b.is_last_move() || b.get_threats(1 - m_attacker) > 0)
+      break;
+    _defending_moves(ply + 1);
+    int reply = -1;
+    for (const auto &move : m_moves[ply + 1]) {
+      b.make(move.second);
+      if (m_wins.count(b.get_hash())) {
+        reply = move.second;
+        break;
+      }
+      b.unmake();
+    }
+    if (reply < 0)
+      break;
+    ++n_made;
+    result.sequence.push_back({b.get_x(reply), b.get_y(reply)});
+  }
+  for (int i = 0; i < n_made; ++i)
+    b.unmake();
+  m_board = nullptr;
+  return result;
+}
+
+ThreatResult ThreatSolver::find_win(const Board &board,
+                                    const ThreatLimits &limits) {
+  ThreatLimits half = limits;
+  half.time_ms = limits.time_ms > 0 ? std::max(1, limits.time_ms / 2) : 0;
+  half.nodes = limits.nodes / 2;
+  ThreatResult result = solve(board, ThreatMode::VCF, half);
+  if (result.win)
+    return result;
+  const int64_t nodes = result.nodes;
+  result = solve(board, ThreatMode::VCT, half);
+  result.nodes += nodes;
+  return result;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "board.hpp"
+#include "core/game.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ttt::engine {
+
+enum class ThreatMode {
+  // victory by continuous fours: every attacking move threatens a line
+  VCF,
+  // victory by continuous threats: moves which make two windows one stone
+  // short of a four are allowed too. The defender only tries blocks and
+  // counter fours, not counter threes or quiet moves, so a VCT win is a
+  // strong hint rather than a proof.
+  VCT,
+};
+
+// Zero values mean no limit.
+struct ThreatLimits {
+  int time_ms = 0;
+  int64_t nodes = 0;
+  // number of attacking moves
+  int depth = 12;
+};
+
+struct ThreatResult {
+  // whether the side to move wins against the replies tried by the solver:
+  // a forced win in the VCF mode, only a hint in the VCT one
+  bool win = false;
+  // moves of the attacker and the defender in turn, starting with the
+  // attacker, up to the winning move
+  std::vector<game::Point> sequence;
+  int64_t nodes = 0;
+  // the budget ran out before the search of the depth limit was done
+  bool aborted = false;
+};
+
+// Threat-space search: proves that the side to move wins by a sequence of
+// forcing moves, each of which leaves the defender only a few replies:
+// blocks of the threatened lines and own counter threats. Windows never cross
+// walls and edges of the field, so blocked lines are not threats. The
+// LAST_MOVE rule is followed: a line of X only wins when O cannot complete a
+// line with the reply.
+class ThreatSolver {
+  using Clock = std::chrono::steady_clock;
+
+  Board *m_board = nullptr;
+  ThreatMode m_mode = ThreatMode::VCF;
+  int m_attacker = 0;
+  int64_t m_nodes = 0;
+  int64_t m_max_nodes = 0;
+  bool m_has_deadline = false;
+  Clock::time_point m_deadline;
+  bool m_aborted = false;
+  // moves of proven attacking positions and the depths at which positions
+  // have no win
+  std::unordered_map<uint64_t, int> m_wins;
+  std::unordered_map<uint64_t, int> m_fails;
+  std::vector<std::pair<int, int>> m_moves[2 * 64];
+
+public:
+  ThreatResult solve(const Board &board, ThreatMode mode,
+                     const ThreatLimits &limits);
+  // VCF and then VCT, each with half of the budget, for analysis; players
+  // only play VCF wins without their main search.
+  ThreatResult find_win(const Board &board, const ThreatLimits &limits);
+
+private:
+  bool _attack(int depth, int ply);
+  bool _defend(int depth, int ply);
+  void _attacking_moves(int ply);
+  void _defending_moves(int ply);
+  bool _check_limits();
+};
+
+}; // namespace ttt::engine
@@ -0,0 +1,39 @@
+#include "time_manager.hpp"
+
+#include <algorithm>
+
+namespace ttt::engine {
+
+void TimeManager::add_round_trip(double ms) {
+  m_round_trips[m_next_sample] = ms;
+  m_next_sample = (m_next_sample + 1) % N_SAMPLES;
+  m_n_samples = std::min(m_n_samples + 1, int(N_SAMPLES));
+}
+
+double TimeManager::get_round_trip_ms() const {
+  if (m_n_samples == 0)
+    return 0;
+  return *std::min_element(m_round_trips, m_round_trips + m_n_samples);
+}
+
+int TimeManager::get_margin_ms() const {
+  return m_params.safety_ms + int(m_params.safety_part * m_limit_ms) +
+         int(get_round_trip_ms() + 0.999);
+}
+
+MoveTime TimeManager::start_move(const Board &board,
+                                 Clock::time_point start) const {
+  MoveTime time;
+  time.start = start;
+  time.hard_ms = std::max(1, m_limit_ms - get_margin_ms());
+  double part = m_params.soft_part;
+  if (board.get_threats(0) > 0 || board.get_threats(1) > 0 ||
+      board.is_last_move())
+    part = 1;
+  else if (board.get_move_no() < m_params.opening_moves)
+    part *= m_params.opening_scale;
+  time.soft_ms = std::clamp(int(time.hard_ms * part), 1, time.hard_ms);
+  return time;
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <chrono>
+
+namespace ttt::engine {
+
+struct TimeParams {
+  // margin kept for building the board and answering, in addition to the
+  // measured round trip to the server
+  int safety_ms = 5;
+  double safety_part = 0.05;
+  // soft deadline as a part of the time up to the hard one
+  double soft_part = 0.6;
+  // the first moves of the game get a shorter soft deadline
+  int opening_moves = 4;
+  double opening_scale = 0.5;
+};
+
+// Deadlines of one move. A search must stop by the hard deadline and should
+// not start a new iteration after the soft one.
+struct MoveTime {
+  std::chrono::steady_clock::time_point start;
+  int soft_ms = 0;
+  int hard_ms = 0;
+};
+
+// Scale of the soft deadline after `stable` iterations in a row which ended
+// with the same best move: a changed move gets more time, a move which has
+// held for several iterations less.
+inline double stability_scale(int stable) {
+  if (stable == 0)
+    return 1.5;
+  return stable >= 3 ? 0.7 : 1.0;
+}
+
+// Splits the time limit of one move into soft and hard deadlines. The server
+// counts the limit from sending the request until it gets the move, so the
+// hard deadline leaves the round trip and a safety margin; the shortest of
+// the recent round trips is taken, as others include the time of the
+// opponent. The soft deadline depends on the game phase: it is shorter in
+// the opening and equal to the hard one when a side has threats.
+//
+// Unused time of a move is lost, the soft deadline leaves it to pondering.
+class TimeManager {
+public:
+  using Clock = std::chrono::steady_clock;
+  static const int N_SAMPLES = 16;
+
+private:
+  TimeParams m_params;
+  int m_limit_ms;
+  double m_round_trips[N_SAMPLES];
+  int m_n_samples = 0;
+  int m_next_sample = 0;
+
+public:
+  explicit TimeManager(int limit_ms = 300, const TimeParams &params = {})
+      : m_params(params), m_limit_ms(limit_ms) {}
+
+  void set_limit(int limit_ms) { m_limit_ms = limit_ms; }
+  int get_limit() const { return m_limit_ms; }
+  const TimeParams &get_params() const { return m_params; }
+  void set_params(const TimeParams &params) { m_params = params; }
+
+  // A round trip to the server measured by the client.
+  void add_round_trip(double ms);
+  // Shortest recent round trip, 0 without measurements.
+  double get_round_trip_ms() const;
+  int get_margin_ms() const;
+
+  // Deadlines of the move in the position, counted from `start`.
+  MoveTime start_move(const Board &board,
+                      Clock::time_point start = Clock::now()) const;
+};
+
+}; // namespace ttt::engine
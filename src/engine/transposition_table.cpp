@@ -0,0 +1,148 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace ttt::engine {
+
+// data layout: cell + 1 (16 bits), score (32), depth (8), bound (2), age (6)
+static uint64_t pack(const TTEntry &entry, uint8_t age) {
+  const uint64_t depth = std::min(std::max(entry.depth, 0), 255);
+  return uint64_t(uint16_t(entry.cell + 1)) |
+         uint64_t(uint32_t(entry.score)) << 16 | depth << 48 |
+         uint64_t(entry.bound) << 56 | uint64_t(age & 63) << 58;
+}
+
+static TTEntry unpack(uint64_t data) {
+  TTEntry entry;
+  entry.cell = int(data & 0xffff) - 1;
+  entry.score = int32_t(uint32_t(data >> 16));
+  entry.depth = int((data >> 48) & 0xff);
+  entry.bound = Bound((data >> 56) & 3);
+  return entry;
+}
+
+static int age_of(uint64_t data) { return int(data >> 58); }
+
+TranspositionTable::TranspositionTable(size_t size_mb) { resize(size_mb); }
+
+void TranspositionTable::resize(size_t size_mb) {
+  m_memory.release();
+  size_t n = std::max<size_t>(1, (size_mb << 20) / sizeof(Bucket));
+  // the number of buckets is a power of two to index them by a mask
+  while (n & (n - 1))
+    n &= n - 1;
+  m_n_buckets = n;
+  // the memory is zeroed, which is an empty table
+  m_memory.allocate(n * sizeof(Bucket));
+  m_buckets = static_cast<Bucket *>(m_memory.get_data());
+  m_age.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+  std::memset(static_cast<void *>(m_buckets), 0,
+              m_n_buckets * sizeof(Bucket));
+  m_age.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::new_search() {
+  m_age.store((m_age.load(std::memory_order_relaxed) + 1) & 63,
+              std::memory_order_relaxed);
+}
+
+TranspositionTable::Counters &TranspositionTable::_counters() {
+  static std::atomic<int> next_thread{0};
+  thread_local const int index =
+      next_thread.fetch_add(1, std::memory_order_relaxed) % N_COUNTERS;
+  return m_counters[index];
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) {
+  Counters &counters = _counters();
+  counters.probes.fetch_add(1, std::memory_order_relaxed);
+  bool full = true;
+  for (Slot &slot : _bucket(key).slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t stored_key = slot.key.load(std::memory_order_relaxed);
+    if (data == 0) {
+      full = false;
+      continue;
+    }
+    if ((stored_key ^ data) == key) {
+      entry = unpack(data);
+      counters.hits.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  if (full)
+    counters.collisions.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void TranspositionTable::store(uint64_t key, const TTEntry &entry) {
+  const int age = m_age.load(std::memory_order_relaxed);
+  Bucket &bucket = _bucket(key);
+  Slot *target = nullptr;
+  int worst = INT_MAX;
+  TTEntry value = entry;
+  for (Slot &slot : bucket.slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t stored_key = slot.key.load(std::memory_order_relaxed);
+    if (data != 0 && (stored_key ^ data) == key) {
+      const TTEntry old = unpack(data);
+      // a shallow bound does not replace a deep result of this search
+      if (value.bound != Bound::EXACT && value.depth + 2 < old.depth &&
+          age_of(data) == age)
+        return;
+      if (value.cell < 0)
+        value.cell = old.cell;
+      target = &slot;
+      break;
+    }
+    // empty slots first, then stale and shallow entries
+    const int rank = data == 0 ? INT_MIN
+                               : int((data >> 48) & 0xff) -
+                                     8 * ((age - age_of(data)) & 63);
+    if (rank < worst) {
+      worst = rank;
+      target = &slot;
+    }
+  }
+  const uint64_t data = pack(value, age);
+  target->data.store(data, std::memory_order_relaxed);
+  target->key.store(key ^ data, std::memory_order_relaxed);
+  _counters().stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+TTStats TranspositionTable::get_stats() const {
+  TTStats stats;
+  for (const auto &counters : m_counters) {
+    stats.probes += counters.probes.load(std::memory_order_relaxed);
+    stats.hits += counters.hits.load(std::memory_order_relaxed);
+    stats.collisions += counters.collisions.load(std::memory_order_relaxed);
+    stats.stores += counters.stores.load(std::memory_order_relaxed);
+  }
+  const size_t n_sample = std::min<size_t>(m_n_buckets, 1000);
+  const int age = m_age.load(std::memory_order_relaxed);
+  size_t used = 0;
+  for (size_t i = 0; i < n_sample; ++i) {
+    for (const Slot &slot : m_buckets[i].slots) {
+      const uint64_t data = slot.data.load(std::memory_order_relaxed);
+      used += data != 0 && age_of(data) == age;
+    }
+  }
+  stats.fill_permille = int(used * 1000 / (n_sample * 4));
+  return stats;
+}
+
+void TranspositionTable::reset_stats() {
+  for (auto &counters : m_counters) {
+    counters.probes.store(0, std::memory_order_relaxed);
+    counters.hits.store(0, std::memory_order_relaxed);
+    counters.collisions.store(0, std::memory_order_relaxed);
+    counters.stores.store(0, std::memory_order_relaxed);
+  }
+}
+
+}; // namespace ttt::engine
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "large_pages.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ttt::engine {
+
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+struct TTEntry {
+  // board cell of the best move or -1
+  int cell = -1;
+  int score = 0;
+  int depth = 0;
+  Bound bound = Bound::NONE;
+};
+
+struct TTStats {
+  uint64_t probes = 0;
+  uint64_t hits = 0;
+  // probes which found the bucket full of entries of other positions
+  uint64_t collisions = 0;
+  uint64_t stores = 0;
+  // entries of the current search per thousand, estimated by a sample
+  int fill_permille = 0;
+};
+
+// Fixed-size hash table of search results shared by any number of threads
+// and games. Buckets of four entries fill one cache line. Entries are written
+// without locks: the key is stored XOR-ed with the data, so an entry torn by
+// concurrent writes fails verification and reads as a miss. Deeper results
+// and results of the current search are kept on replacement.
+class TranspositionTable {
+  struct Slot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
+  };
+
+  struct alignas(64) Bucket {
+    Slot slots[4];
+  };
+
+  struct alignas(64) Counters {
+    std::atomic<uint64_t> probes{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> collisions{0};
+    std::atomic<uint64_t> stores{0};
+  };
+
+  static const int N_COUNTERS = 16;
+
+  PageMemory m_memory;
+  Bucket *m_buckets = nullptr;
+  size_t m_n_buckets = 0;
+  std::atomic<uint8_t> m_age{0};
+  // counters are spread over threads to keep them off shared cache lines
+  Counters m_counters[N_COUNTERS];
+
+public:
+  explicit TranspositionTable(size_t size_mb = 16);
+  TranspositionTable(const TranspositionTable &) = delete;
+  TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+  // Reallocates the table with pages of the current page policy, all
+  // entries are lost.
+  void resize(size_t size_mb);
+  void clear();
+  size_t get_size_bytes() const { return m_n_buckets * sizeof(Bucket); }
+  PageMode get_page_mode() const { return m_memory.get_mode(); }
+
+  // Marks entries of previous searches as candidates for replacement.
+  void new_search();
+
+  bool probe(uint64_t key, TTEntry &entry);
+  void store(uint64_t key, const TTEntry &entry);
+
+  TTStats get_stats() const;
+  void reset_stats();
+
+private:
+  Bucket &_bucket(uint64_t key) const {
+    return m_buckets[key & (m_n_buckets - 1)];
+  }
+  Counters &_counters();
+};
+
+}; // namespace ttt::engine
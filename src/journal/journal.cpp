@@ -0,0 +1,292 @@
+#include "journal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ttt::journal {
+
+using game::EventType;
+
+static size_t record_size(size_t n_walls, size_t n_moves, size_t names_len) {
+  size_t size = sizeof(RecordHeader) + (n_walls + n_moves) * sizeof(Cell) +
+                names_len;
+  return (size + 7) / 8 * 8;
+}
+
+State::Opts GameView::get_opts() const {
+  State::Opts opts;
+  opts.rows = m_hdr->rows;
+  opts.cols = m_hdr->cols;
+  opts.win_len = m_hdr->win_len;
+  opts.max_moves = m_hdr->max_moves;
+  return opts;
+}
+
+const Cell *GameView::get_walls() const {
+  return reinterpret_cast<const Cell *>(m_hdr + 1);
+}
+
+const Cell *GameView::get_moves() const {
+  return get_walls() + m_hdr->n_walls;
+}
+
+std::string GameView::get_name(Sign sign) const {
+  const char *names =
+      reinterpret_cast<const char *>(get_moves() + m_hdr->n_moves);
+  if (sign == Sign::X)
+    return std::string(names, m_hdr->x_name_len);
+  if (sign == Sign::O)
+    return std::string(names + m_hdr->x_name_len, m_hdr->o_name_len);
+  return "";
+}
+
+JournalWriter::JournalWriter(const char *path, uint64_t first_game_id)
+    : m_file_buf(1 << 20), m_next_id(first_game_id) {
+  m_file = std::fopen(path, "ab");
+  if (!m_file)
+    return;
+  std::setvbuf(m_file, m_file_buf.data(), _IOFBF, m_file_buf.size());
+  std::fseek(m_file, 0, SEEK_END);
+  if (std::ftell(m_file) == 0) {
+    FileHeader hdr{};
+    std::memcpy(hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic));
+    hdr.version = 1;
+    std::fwrite(&hdr, sizeof(hdr), 1, m_file);
+  }
+}
+
+JournalWriter::~JournalWriter() {
+  if (m_file)
+    std::fclose(m_file);
+}
+
+void JournalWriter::flush() {
+  if (m_file)
+    std::fflush(m_file);
+}
+
+void JournalWriter::handle_event(const State &state, const Event &event) {
+  switch (event.type) {
+  case EventType::PLAYER_JOINED: {
+    const int i = event.data.player_joined.player_sign == Sign::X ? 0 : 1;
+    m_names[i] = event.data.player_joined.player_name_id;
+    return;
+  }
+  case EventType::GAME_STARTED: {
+    m_opts = state.get_opts();
+    m_walls.clear();
+    m_moves.clear();
+    for (int y = 0; y < m_opts.rows; ++y)
+      for (int x = 0; x < m_opts.cols; ++x)
+        if (state.get_value(x, y) == Sign::WALL)
+          m_walls.push_back(Cell{uint16_t(x), uint16_t(y)});
+    m_in_game = true;
+    return;
+  }
+  case EventType::MOVE:
+    m_moves.push_back(
+        Cell{uint16_t(event.data.move.x), uint16_t(event.data.move.y)});
+    return;
+  case EventType::WIN:
+    _write_game(MoveResult::WIN, event.data.win.player);
+    return;
+  case EventType::DRAW:
+    _write_game(MoveResult::DRAW, Sign::NONE);
+    return;
+  case EventType::DQ:
+    _write_game(event.data.dq.reason,
+                event.data.dq.player == Sign::X ? Sign::O : Sign::X);
+    return;
+  default:
+    return;
+  }
+}
+
+void JournalWriter::_write_game(MoveResult result, Sign winner) {
+  if (!m_file || !m_in_game)
+    return;
+  m_in_game = false;
+  const char *x_name = game::get_name(m_names[0]);
+  const char *o_name = game::get_name(m_names[1]);
+  const size_t x_name_len = strnlen(x_name, 255);
+  const size_t o_name_len = strnlen(o_name, 255);
+  const size_t names_len = x_name_len + o_name_len;
+  RecordHeader hdr{};
+  hdr.size = record_size(m_walls.size(), m_moves.size(), names_len);
+  hdr.n_walls = m_walls.size();
+  hdr.game_id = m_next_id++;
+  hdr.rows = m_opts.rows;
+  hdr.cols = m_opts.cols;
+  hdr.win_len = m_opts.win_len;
+  hdr.max_moves = m_opts.max_moves;
+  hdr.n_moves = m_moves.size();
+  hdr.result = uint8_t(result);
+  hdr.winner = uint8_t(winner);
+  hdr.x_name_len = x_name_len;
+  hdr.o_name_len = o_name_len;
+  std::fwrite(&hdr, sizeof(hdr), 1, m_file);
+  std::fwrite(m_walls.data(), sizeof(Cell), m_walls.size(), m_file);
+  std::fwrite(m_moves.data(), sizeof(Cell), m_moves.size(), m_file);
+  std::fwrite(x_name, 1, x_name_len, m_file);
+  std::fwrite(o_name, 1, o_name_len, m_file);
+  static const char padding[8] = {};
+  const size_t written = sizeof(hdr) +
+                         (m_walls.size() + m_moves.size()) * sizeof(Cell) +
+                         names_len;
+  std::fwrite(padding, 1, hdr.size - written, m_file);
+}
+
+Journal::~Journal() { close(); }
+
+bool Journal::open(const char *path, bool write_index) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    m_error = "cannot open journal";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(FileHeader)) {
+    ::close(fd);
+    m_error = "journal is too small";
+    return false;
+  }
+  m_size = st.st_size;
+  void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    m_error = "cannot map journal";
+    return false;
+  }
+  m_data = static_cast<const char *>(data);
+  if (std::memcmp(m_data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+    close();
+    m_error = "bad journal magic";
+    return false;
+  }
+  const std::string index_path = std::string(path) + ".idx";
+  if (_load_index(index_path))
+    return true;
+  if (m_error) {
+    const char *error = m_error;
+    close();
+    m_error = error;
+    return false;
+  }
+  if (!_build_index()) {
+    close();
+    return false;
+  }
+  if (write_index)
+    _save_index(index_path);
+  return true;
+}
+
+void Journal::close() {
+  if (m_data)
+    munmap(const_cast<char *>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+  m_index.clear();
+  m_error = nullptr;
+}
+
+GameView Journal::get_game(size_t i) const {
+  if (i >= m_index.size())
+    return GameView();
+  return GameView(
+      reinterpret_cast<const RecordHeader *>(m_data + m_index[i].offset));
+}
+
+GameView Journal::find_game(uint64_t game_id) const {
+  auto it = std::lower_bound(
+      m_index.begin(), m_index.end(), game_id,
+      [](const IndexEntry &e, uint64_t id) { return e.game_id < id; });
+  if (it == m_index.end() || it->game_id != game_id)
+    return GameView();
+  return GameView(reinterpret_cast<const RecordHeader *>(m_data + it->offset));
+}
+
+bool Journal::_build_index() {
+  m_index.clear();
+  size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(RecordHeader) <= m_size) {
+    auto hdr = reinterpret_cast<const RecordHeader *>(m_data + offset);
+    // a truncated tail is left by interrupted writers, keep what we have
+    if (!_is_valid_record(offset))
+      break;
+    m_index.push_back(IndexEntry{hdr->game_id, offset});
+    offset += hdr->size;
+  }
+  std::stable_sort(m_index.begin(), m_index.end(),
+                   [](const IndexEntry &a, const IndexEntry &b) {
+                     return a.game_id < b.game_id;
+                   });
+  return true;
+}
+
+bool Journal::_load_index(const std::string &path) {
+  std::FILE *f = std::fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  IndexHeader hdr;
+  bool ok = std::fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+            std::memcmp(hdr.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+            hdr.journal_size == m_size;
+  // every record takes at least a header
+  if (ok && hdr.n_games > m_size / sizeof(RecordHeader)) {
+    ok = false;
+    m_error = "bad journal index: too many games";
+  }
+  if (ok) {
+    m_index.resize(hdr.n_games);
+    ok = std::fread(m_index.data(), sizeof(IndexEntry), hdr.n_games, f) ==
+         hdr.n_games;
+  }
+  std::fclose(f);
+  for (size_t i = 0; ok && i < m_index.size(); ++i) {
+    const IndexEntry &e = m_index[i];
+    if (!_is_valid_record(e.offset) ||
+        reinterpret_cast<const RecordHeader *>(m_data + e.offset)->game_id !=
+            e.game_id ||
+        (i > 0 && m_index[i - 1].game_id > e.game_id)) {
+      ok = false;
+      m_error = "bad journal index: entry does not match the journal";
+    }
+  }
+  if (!ok)
+    m_index.clear();
+  return ok;
+}
+
+bool Journal::_is_valid_record(uint64_t offset) const {
+  if (offset < sizeof(FileHeader) || offset % 8 != 0 || offset > m_size ||
+      m_size - offset < sizeof(RecordHeader))
+    return false;
+  auto hdr = reinterpret_cast<const RecordHeader *>(m_data + offset);
+  return hdr->size == record_size(hdr->n_walls, hdr->n_moves,
+                                  hdr->x_name_len + hdr->o_name_len) &&
+         hdr->size <= m_size - offset;
+}
+
+bool Journal::_save_index(const std::string &path) const {
+  std::FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  IndexHeader hdr;
+  std::memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+  hdr.n_games = m_index.size();
+  hdr.journal_size = m_size;
+  bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+            std::fwrite(m_index.data(), sizeof(IndexEntry), m_index.size(),
+                        f) == m_index.size();
+  std::fclose(f);
+  return ok;
+}
+
+}; // namespace ttt::journal
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ttt::journal {
+
+using game::Event;
+using game::IObserver;
+using game::MoveResult;
+using game::Sign;
+using game::State;
+
+/*
+  Journal file layout (all integers are in the byte order of the machine
+  which wrote the journal, the files are not portable between little- and
+  big-endian machines):
+
+    FileHeader
+    GameRecord #0
+    GameRecord #1
+    ...
+
+  Every game record starts with RecordHeader and is followed by `n_walls`
+  wall cells, `n_moves` move cells and both player names (without trailing
+  zero). Records are padded to 8 bytes, so the headers can be read right from
+  the mapped memory.
+
+  The index is stored in a separate `<journal>.idx` file: IndexHeader followed
+  by IndexEntry array sorted by game id. Entries which point outside of the
+  journal or to a broken record make `Journal::open` fail.
+*/
+
+static const char JOURNAL_MAGIC[8] = {'T', 'T', 'T', 'J', 'R', 'N', 'L', '1'};
+static const char INDEX_MAGIC[8] = {'T', 'T', 'T', 'J', 'I', 'D', 'X', '1'};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct Cell {
+  uint16_t x;
+  uint16_t y;
+};
+
+struct RecordHeader {
+  uint32_t size; // full record size in bytes, including this header
+  uint32_t n_walls;
+  uint64_t game_id;
+  uint16_t rows;
+  uint16_t cols;
+  uint16_t win_len;
+  uint16_t max_moves;
+  uint32_t n_moves;
+  uint8_t result; // MoveResult of the last move
+  uint8_t winner; // Sign
+  uint8_t x_name_len;
+  uint8_t o_name_len;
+};
+
+struct IndexHeader {
+  char magic[8];
+  uint64_t n_games;
+  uint64_t journal_size;
+};
+
+struct IndexEntry {
+  uint64_t game_id;
+  uint64_t offset;
+};
+
+// Read-only view of one game inside a mapped journal.
+class GameView {
+  const RecordHeader *m_hdr = nullptr;
+
+public:
+  GameView() = default;
+  explicit GameView(const RecordHeader *hdr) : m_hdr(hdr) {}
+
+  bool is_valid() const { return m_hdr != nullptr; }
+  uint64_t get_id() const { return m_hdr->game_id; }
+  State::Opts get_opts() const;
+  int get_walls_num() const { return m_hdr->n_walls; }
+  int get_moves_num() const { return m_hdr->n_moves; }
+  const Cell *get_walls() const;
+  const Cell *get_moves() const;
+  MoveResult get_result() const { return MoveResult(m_hdr->result); }
+  Sign get_winner() const { return Sign(m_hdr->winner); }
+  std::string get_name(Sign sign) const;
+};
+
+// Observer which writes every finished game to a journal file.
+class JournalWriter : public IObserver {
+  std::FILE *m_file = nullptr;
+  std::vector<char> m_file_buf;
+  uint64_t m_next_id;
+  game::NameId m_names[2] = {};
+  State::Opts m_opts;
+  std::vector<Cell> m_walls;
+  std::vector<Cell> m_moves;
+  bool m_in_game = false;
+
+public:
+  JournalWriter(const char *path, uint64_t first_game_id = 0);
+  JournalWriter(const JournalWriter &) = delete;
+  JournalWriter &operator=(const JournalWriter &) = delete;
+  ~JournalWriter();
+
+  bool is_open() const { return m_file != nullptr; }
+  uint64_t get_next_game_id() const { return m_next_id; }
+  void flush();
+
+  void handle_event(const State &state, const Event &event) override;
+
+private:
+  void _write_game(MoveResult result, Sign winner);
+};
+
+// Memory-mapped journal with random access to games by their ids.
+class Journal {
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+  const char *m_error = nullptr;
+  std::vector<IndexEntry> m_index;
+
+public:
+  Journal() = default;
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+  ~Journal();
+
+  // Maps the journal and loads `<path>.idx` or rebuilds it when it is
+  // missing or stale. With `write_index` the rebuilt index is saved.
+  bool open(const char *path, bool write_index = true);
+  void close();
+
+  const char *get_error() const { return m_error; }
+  size_t get_games_num() const { return m_index.size(); }
+
+  // Games in the order of their ids.
+  GameView get_game(size_t i) const;
+  GameView find_game(uint64_t game_id) const;
+
+private:
+  bool _build_index();
+  // Returns false and leaves the error unset for a missing or stale index,
+  // the error is set for a corrupt one.
+  bool _load_index(const std::string &path);
+  // Whether a whole record with consistent sizes starts at the offset.
+  bool _is_valid_record(uint64_t offset) const;
+  bool _save_index(const std::string &path) const;
+};
+
+}; // namespace ttt::journal
@@ -0,0 +1,101 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace ttt::journal {
+
+void WallsInitializer::initialize(game::FieldBitmap &field) {
+  for (const auto &cell : m_walls) {
+    if (field.is_valid(cell.x, cell.y))
+      field.set(cell.x, cell.y, Sign::WALL);
+  }
+}
+
+State rebuild_state(const GameView &game, int move_no) {
+  WallsInitializer initializer(game.get_walls(), game.get_walls_num());
+  State state(game.get_opts(), &initializer);
+  const int n_moves = game.get_moves_num();
+  if (move_no < 0 || move_no > n_moves)
+    move_no = n_moves;
+  const Cell *moves = game.get_moves();
+  for (int i = 0; i < move_no; ++i) {
+    state.process_move(state.get_current_player(), moves[i].x, moves[i].y);
+  }
+  return state;
+}
+
+MoveResult replay_game(const GameView &game, IObserver &observer,
+                       int pace_ms) {
+  WallsInitializer initializer(game.get_walls(), game.get_walls_num());
+  State state(game.get_opts(), &initializer);
+  const auto x_name = game::intern_name(game.get_name(Sign::X).c_str());
+  const auto o_name = game::intern_name(game.get_name(Sign::O).c_str());
+  observer.handle_event(state,
+                        Event::make_player_joined_event(Sign::X, x_name));
+  observer.handle_event(state,
+                        Event::make_player_joined_event(Sign::O, o_name));
+  observer.handle_event(state, Event::make_game_started_event());
+
+  MoveResult result = MoveResult::OK;
+  const Cell *moves = game.get_moves();
+  for (int i = 0; i < game.get_moves_num(); ++i) {
+    if (pace_ms > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(pace_ms));
+    const Sign sign = state.get_current_player();
+    result = state.process_move(sign, moves[i].x, moves[i].y);
+    observer.handle_event(state,
+                          Event::make_move_event(moves[i].x, moves[i].y, sign));
+    switch (result) {
+    case MoveResult::WIN:
+      observer.handle_event(state, Event::make_win_event(state.get_winner()));
+      return result;
+    case MoveResult::DRAW:
+      observer.handle_event(state, Event::make_draw_event());
+      return result;
+    case MoveResult::DQ_OUT_OF_ORDER:
+    case MoveResult::DQ_PLACE_OCCUPIED:
+    case MoveResult::DQ_OUT_OF_FIELD:
+      observer.handle_event(state, Event::make_dq_event(sign, result));
+      return result;
+    default:
+      break;
+    }
+  }
+  return result;
+}
+
+int get_threads_num(int requested) {
+  if (requested > 0)
+    return requested;
+  const int hw = std::thread::hardware_concurrency();
+  return hw > 0 ? hw : 1;
+}
+
+void for_each_game_parallel(const Journal &journal, int n_threads,
+                            const GameVisitor &fn) {
+  static const size_t chunk = 256;
+  n_threads = get_threads_num(n_threads);
+  const size_t n_games = journal.get_games_num();
+  std::atomic<size_t> next{0};
+  auto worker = [&](int thread_no) {
+    for (;;) {
+      const size_t begin = next.fetch_add(chunk);
+      if (begin >= n_games)
+        return;
+      const size_t end = std::min(begin + chunk, n_games);
+      for (size_t i = begin; i < end; ++i)
+        fn(journal.get_game(i), thread_no);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n_threads; ++i)
+    threads.emplace_back(worker, i);
+  worker(0);
+  for (auto &t : threads)
+    t.join();
+}
+
+}; // namespace ttt::journal
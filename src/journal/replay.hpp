@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core/field.hpp"
+#include "journal.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace ttt::journal {
+
+// Places walls recorded in a journal instead of generating new ones.
+class WallsInitializer : public game::IFieldInitializer {
+  std::vector<Cell> m_walls;
+
+public:
+  WallsInitializer(const Cell *walls, int n_walls)
+      : m_walls(walls, walls + n_walls) {}
+  void initialize(game::FieldBitmap &field) override;
+  game::IFieldInitializer *clone() const override {
+    return new WallsInitializer(*this);
+  }
+};
+
+// Rebuilds the state of the game after `move_no` moves (all moves when
+// `move_no` is negative) without running players.
+State rebuild_state(const GameView &game, int move_no = -1);
+
+// Re-emits events of the recorded game to the observer in the same order as
+// `Game::process` does. `pace_ms` is a delay between moves, 0 means replay
+// at full speed.
+MoveResult replay_game(const GameView &game, IObserver &observer,
+                       int pace_ms = 0);
+
+// Calls `fn` for every game of the journal from `n_threads` threads
+// (all hardware threads when `n_threads` <= 0). `fn` gets the number of the
+// calling thread, so it can accumulate results without locking.
+using GameVisitor = std::function<void(const GameView &game, int thread_no)>;
+void for_each_game_parallel(const Journal &journal, int n_threads,
+                            const GameVisitor &fn);
+
+int get_threads_num(int requested);
+
+}; // namespace ttt::journal
@@ -0,0 +1,62 @@
+#include "analysis_writer.hpp"
+
+namespace ttt::my_player {
+
+static void write_score(std::ostream &out, int score) {
+  if (!engine::is_win_score(score)) {
+    out << score;
+    return;
+  }
+  const int plies = engine::WIN_SCORE - (score > 0 ? score : -score);
+  out << (score > 0 ? "win" : "loss") << " in " << plies;
+}
+
+AnalysisWriter::AnalysisWriter(std::ostream &out, int n_lines,
+                               const engine::SearchLimits &limits,
+                               engine::TranspositionTable *tt)
+    : m_out(out), m_analyzer(tt), m_limits(limits), m_n_lines(n_lines) {}
+
+void AnalysisWriter::handle_event(const State &state, const Event &event) {
+  switch (event.type) {
+  case game::EventType::GAME_STARTED:
+  case game::EventType::MOVE:
+    m_analyzer.stop();
+    m_move_no = state.get_move_no();
+    if (state.get_current_player() != m_own_sign)
+      m_analyzer.start(state, m_limits, m_n_lines, this);
+    break;
+  case game::EventType::PLAYER_JOINED:
+    break;
+  default:
+    m_analyzer.stop();
+    break;
+  }
+}
+
+void AnalysisWriter::on_iteration(const engine::SearchResult &result) {
+  std::lock_guard<std::mutex> lock(m_out_mutex);
+  m_out << "analysis move " << m_move_no << " depth " << result.depth
+        << " nodes " << result.nodes << " time " << result.time_ms << " ms\n";
+  for (size_t i = 0; i < result.lines.size(); ++i) {
+    const auto &line = result.lines[i];
+    m_out << "  " << i + 1 << ". ";
+    write_score(m_out, line.score);
+    m_out << ':';
+    for (const auto &p : line.pv)
+      m_out << " (" << p.x << ", " << p.y << ")";
+    m_out << '\n';
+  }
+  m_out.flush();
+}
+
+void AnalysedPlayer::set_sign(Sign sign) {
+  m_writer.set_own_sign(sign);
+  m_base.set_sign(sign);
+}
+
+Point AnalysedPlayer::make_move(const State &state) {
+  m_writer.pause();
+  return m_base.make_move(state);
+}
+
+}; // namespace ttt::my_player
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "engine/analyzer.hpp"
+
+#include <mutex>
+#include <ostream>
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IObserver;
+using game::IPlayer;
+using game::Point;
+using game::Sign;
+using game::State;
+
+// Analyses every position of the observed game on a background thread and
+// writes the best lines after every iteration, so spectators see the live
+// evaluation. Events only restart the analysis and never wait for it.
+class AnalysisWriter : public IObserver, public engine::IIterationObserver {
+  std::ostream &m_out;
+  std::mutex m_out_mutex;
+  engine::Analyzer m_analyzer;
+  engine::SearchLimits m_limits;
+  int m_n_lines;
+  int m_move_no = 0;
+  Sign m_own_sign = Sign::NONE;
+
+public:
+  // Shares the table `tt` of a player if it is given.
+  AnalysisWriter(std::ostream &out, int n_lines,
+                 const engine::SearchLimits &limits,
+                 engine::TranspositionTable *tt = nullptr);
+  ~AnalysisWriter() { m_analyzer.stop(); }
+
+  // Positions in which this side is to move are not analysed: a player of
+  // the same process thinks on them and the analysis would take its CPU.
+  void set_own_sign(Sign sign) { m_own_sign = sign; }
+  // Stops the analysis until the next event.
+  void pause() { m_analyzer.stop(); }
+
+  void handle_event(const State &state, const Event &event) override;
+  void on_iteration(const engine::SearchResult &result) override;
+};
+
+// Player wrapper which keeps the analysis off the time of the player: the
+// positions of its moves are skipped and the analysis is stopped before
+// every move.
+class AnalysedPlayer : public IPlayer {
+  IPlayer &m_base;
+  AnalysisWriter &m_writer;
+
+public:
+  AnalysedPlayer(IPlayer &base, AnalysisWriter &writer)
+      : m_base(base), m_writer(writer) {}
+
+  void set_sign(Sign sign) override;
+  Point make_move(const State &state) override;
+  const char *get_name() const override { return m_base.get_name(); }
+  void handle_event(const State &state, const Event &event) override {
+    m_base.handle_event(state, event);
+  }
+};
+
+}; // namespace ttt::my_player
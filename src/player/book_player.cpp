@@ -0,0 +1,15 @@
+#include "book_player.hpp"
+
+namespace ttt::my_player {
+
+Point BookPlayer::make_move(const State &state) {
+  Point move;
+  if (m_book && state.get_move_no() < m_max_moves &&
+      m_book->find_move(state, move, m_min_games)) {
+    ++m_book_moves;
+    return move;
+  }
+  return m_player.make_move(state);
+}
+
+}; // namespace ttt::my_player
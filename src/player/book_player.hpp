@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "engine/opening_book.hpp"
+
+#include <memory>
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IPlayer;
+using game::Point;
+using game::Sign;
+using game::State;
+
+// Player which plays book moves in the first moves of the game and asks the
+// wrapped player otherwise. Events go to the wrapped player in any case, so
+// it can follow the game.
+class BookPlayer : public IPlayer {
+  IPlayer &m_player;
+  std::shared_ptr<const engine::OpeningBook> m_book;
+  int m_max_moves;
+  uint32_t m_min_games = 1;
+  int m_book_moves = 0;
+
+public:
+  // Book moves are played while the move number is below `max_moves`.
+  BookPlayer(IPlayer &player, std::shared_ptr<const engine::OpeningBook> book,
+             int max_moves = 12)
+      : m_player(player), m_book(std::move(book)), m_max_moves(max_moves) {}
+
+  void set_sign(Sign sign) override { m_player.set_sign(sign); }
+  Point make_move(const State &state) override;
+  const char *get_name() const override { return m_player.get_name(); }
+  void handle_event(const State &state, const Event &event) override {
+    m_player.handle_event(state, event);
+  }
+
+  // Moves played fewer times are ignored.
+  void set_min_games(uint32_t min_games) { m_min_games = min_games; }
+  int get_book_moves() const { return m_book_moves; }
+};
+
+}; // namespace ttt::my_player
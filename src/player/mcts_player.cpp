@@ -0,0 +1,74 @@
+#include "mcts_player.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ttt::my_player {
+
+MctsPlayer::MctsPlayer(const char *name, int timelimit_ms,
+                       const engine::MctsParams &params)
+    : m_name(name), m_time(timelimit_ms), m_mcts(params) {}
+
+void MctsPlayer::set_sign(Sign sign) { m_sign = sign; }
+
+const char *MctsPlayer::get_name() const { return m_name; }
+
+void MctsPlayer::handle_event(const State &state, const Event &event) {
+  switch (event.type) {
+  case game::EventType::GAME_STARTED:
+    m_mcts.reset(engine::Board(state));
+    break;
+  case game::EventType::MOVE:
+    m_mcts.advance({event.data.move.x, event.data.move.y});
+    break;
+  default:
+    break;
+  }
+}
+
+Point MctsPlayer::make_move(const State &state) {
+  const auto start = std::chrono::steady_clock::now();
+  const engine::Board board(state);
+  engine::MctsLimits limits;
+  // the tree has no iterations to stop between, it runs to the hard deadline
+  limits.time_ms = m_time.start_move(board, start).hard_ms;
+  if (m_playout_limit > 0) {
+    limits.time_ms = 0;
+    limits.playouts = m_playout_limit;
+  }
+  if (m_threat_search) {
+    engine::ThreatLimits threat_limits;
+    if (m_playout_limit > 0)
+      threat_limits.nodes = std::max<int64_t>(1, m_playout_limit / 8);
+    else
+      threat_limits.time_ms = std::max(1, limits.time_ms / 8);
+    // only wins by fours are proofs, the tree finds the others
+    const auto threat =
+        m_threat_solver.solve(board, engine::ThreatMode::VCF, threat_limits);
+    if (threat.win) {
+      m_last_result = engine::MctsResult();
+      m_last_result.move = threat.sequence[0];
+      m_last_result.win_rate = 1;
+      return m_last_result.move;
+    }
+    if (m_playout_limit == 0) {
+      const auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start);
+      limits.time_ms = std::max(1, limits.time_ms - int(elapsed.count()));
+    }
+  }
+  // the player may have missed events, e.g. when it joined a started game
+  if (!m_mcts.is_synced(board))
+    m_mcts.reset(board);
+  m_last_result = m_mcts.run(limits);
+  if (m_last_result.move.x >= 0)
+    return m_last_result.move;
+  for (int y = 0; y < state.get_opts().rows; ++y)
+    for (int x = 0; x < state.get_opts().cols; ++x)
+      if (state.get_value(x, y) == Sign::NONE)
+        return {x, y};
+  return {0, 0};
+}
+
+}; // namespace ttt::my_player
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "engine/mcts.hpp"
+#include "engine/threat_solver.hpp"
+#include "engine/time_manager.hpp"
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IPlayer;
+using game::Point;
+using game::Sign;
+using game::State;
+
+// Player which chooses moves by Monte Carlo tree search. The tree follows
+// the game through MOVE events, so the search of the previous moves is kept
+// for the reply, and its node arena is emptied when a new game starts. A
+// forced win by a chain of fours is played without the tree search.
+class MctsPlayer : public IPlayer {
+  Sign m_sign = Sign::NONE;
+  const char *m_name;
+  engine::TimeManager m_time;
+  engine::Mcts m_mcts;
+  engine::MctsResult m_last_result;
+  engine::ThreatSolver m_threat_solver;
+  bool m_threat_search = true;
+  int64_t m_playout_limit = 0;
+
+public:
+  // `timelimit_ms` is the time limit of the game server for one move.
+  MctsPlayer(const char *name, int timelimit_ms = 300,
+             const engine::MctsParams &params = {});
+
+  void set_sign(Sign sign) override;
+  Point make_move(const State &state) override;
+  const char *get_name() const override;
+  void handle_event(const State &state, const Event &event) override;
+
+  void set_timelimit(int timelimit_ms) { m_time.set_limit(timelimit_ms); }
+  int get_timelimit() const { return m_time.get_limit(); }
+  // Deadlines of the moves, a remote client adds round trips to it.
+  engine::TimeManager &get_time_manager() { return m_time; }
+  // Runs this number of playouts for every move instead of the time limit,
+  // so that tests do not depend on the speed of the machine; 0 for the time
+  // limit.
+  void set_playout_limit(int64_t playouts) { m_playout_limit = playouts; }
+  int64_t get_playout_limit() const { return m_playout_limit; }
+  const engine::MctsResult &get_last_result() const { return m_last_result; }
+  engine::PageMode get_page_mode() const { return m_mcts.get_page_mode(); }
+  void set_threat_search(bool threat_search) {
+    m_threat_search = threat_search;
+  }
+};
+
+}; // namespace ttt::my_player
@@ -1,5 +1,6 @@
 #include "my_observer.hpp"
-#include <iomanip>
+#include <cstdio>
+#include <string>
 
 #include <iostream>
 
@@ -11,24 +12,28 @@ using game::Sign;
 void ConsoleWriter::print_game_state(const State &state) {
   const int cols = state.get_opts().cols;
   const int rows = state.get_opts().rows;
+  // the whole field is formatted first and written to the stream at once
+  std::string frame;
+  frame.reserve((rows + 3) * (2 * cols + 5));
+  char buf[16];
 
   // print column indices
-  std::cout << "   "; // extra space for column index
+  frame += "   "; // extra space for column index
   for (int x = 0; x < cols; ++x) {
-    std::cout << std::setw(2) << x % 10;
+    std::snprintf(buf, sizeof(buf), "%2d", x % 10);
+    frame += buf;
   }
-  std::cout << "\n";
+  frame += "\n";
 
   // line separator
-  std::cout << "   +";
-  for (int x = 0; x < cols; ++x) {
-    std::cout << "--";
-  }
-  std::cout << "\n";
+  frame += "   +";
+  frame.append(2 * cols, '-');
+  frame += "\n";
 
   // print board with row indices
   for (int y = 0; y < rows; ++y) {
-    std::cout << std::setw(2) << y << " |";
+    std::snprintf(buf, sizeof(buf), "%2d |", y);
+    frame += buf;
     for (int x = 0; x < cols; ++x) {
       char c = '.';
       switch (state.get_value(x, y)) {
@@ -44,11 +49,13 @@ void ConsoleWriter::print_game_state(const State &state) {
       default:
         break;
       }
-      std::cout << c << " ";
+      frame += c;
+      frame += ' ';
     }
-    std::cout << "\n";
+    frame += "\n";
   }
-  std::cout << "\n";
+  frame += "\n";
+  std::cout << frame;
 }
 
 static const char *print_sign(Sign sign) {
@@ -87,7 +94,8 @@ void ConsoleWriter::handle_event(const State &state, const Event &event) {
               << std::endl;
     return;
   case EventType::PLAYER_JOINED:
-    std::cout << "Player " << event.data.player_joined.player_name
+    std::cout << "Player "
+              << game::get_name(event.data.player_joined.player_name_id)
               << " joined as "
               << print_sign(event.data.player_joined.player_sign) << std::endl;
     return;
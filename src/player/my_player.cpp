@@ -1,4 +1,5 @@
 #include "my_player.hpp"
+#include "engine/candidates.hpp"
 #include <cstdlib>
 
 namespace ttt::my_player {
@@ -7,32 +8,24 @@ void MyPlayer::set_sign(Sign sign) { m_sign = sign; }
 const char *MyPlayer::get_name() const { return m_name; }
 
 Point MyPlayer::make_move(const State &state) {
-  Point result;
-  for (int n_attempt = 0; n_attempt < 50; ++n_attempt) {
-    result.x = std::rand() % state.get_opts().cols;
-    result.y = std::rand() % state.get_opts().rows;
-    if (state.get_value(result.x, result.y) != Sign::NONE) {
-      --n_attempt;
-      continue;
-    }
-    bool has_neighbors = false;
-    for (int dx = -1; dx <= 1; ++dx) {
-      for (int dy = -1; dy <= 1; ++dy) {
-        if (dx == 0 && dy == 0)
-          continue;
-        const Sign val = state.get_value(result.x + dx, result.y + dy);
-        if (val == Sign::X || val == Sign::O) {
-          has_neighbors = true;
-          break;
-        }
-      }
-      if (has_neighbors)
-        break;
-    }
-    if (has_neighbors)
-      break;
+  // a random empty cell next to a stone or any empty cell when no empty
+  // cell is next to a stone or the field is too large for masks; there are
+  // no moves only on a full field
+  engine::FieldMasks masks;
+  std::vector<Point> moves;
+  if (masks.init(state)) {
+    engine::CandidateOpts opts;
+    opts.radius = 1;
+    engine::list_candidates(masks, opts, moves);
+  } else {
+    for (int y = 0; y < state.get_opts().rows; ++y)
+      for (int x = 0; x < state.get_opts().cols; ++x)
+        if (state.get_value(x, y) == Sign::NONE)
+          moves.push_back({x, y});
   }
-  return result;
+  if (moves.empty())
+    return {0, 0};
+  return moves[std::rand() % moves.size()];
 }
 
 }; // namespace ttt::my_player
@@ -0,0 +1,199 @@
+#include "ndjson_writer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ttt::my_player {
+
+using game::EventType;
+using game::MoveResult;
+using game::Sign;
+
+static const char *sign_str(Sign sign) {
+  switch (sign) {
+  case Sign::X:
+    return "\"X\"";
+  case Sign::O:
+    return "\"O\"";
+  default:
+    return "null";
+  }
+}
+
+static const char *dq_str(MoveResult rc) {
+  switch (rc) {
+  case MoveResult::DQ_OUT_OF_FIELD:
+    return "\"out_of_field\"";
+  case MoveResult::DQ_PLACE_OCCUPIED:
+    return "\"place_occupied\"";
+  case MoveResult::DQ_OUT_OF_ORDER:
+    return "\"out_of_order\"";
+  default:
+    return "null";
+  }
+}
+
+static void append_int(std::string &buf, long value) {
+  char tmp[24];
+  const int n = std::snprintf(tmp, sizeof(tmp), "%ld", value);
+  buf.append(tmp, n);
+}
+
+static void append_json_str(std::string &buf, const char *str) {
+  buf += '"';
+  for (; str && *str; ++str) {
+    const unsigned char c = *str;
+    switch (c) {
+    case '"':
+      buf += "\\\"";
+      break;
+    case '\\':
+      buf += "\\\\";
+      break;
+    case '\n':
+      buf += "\\n";
+      break;
+    default:
+      if (c < 0x20) {
+        char tmp[8];
+        std::snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+        buf += tmp;
+      } else {
+        buf += c;
+      }
+    }
+  }
+  buf += '"';
+}
+
+NdjsonWriter::NdjsonWriter(const char *path, size_t buffer_size)
+    : m_buffer_size(buffer_size) {
+  if (std::strcmp(path, "-") == 0) {
+    m_fd = STDOUT_FILENO;
+  } else {
+    m_fd = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    m_own_fd = m_fd >= 0;
+  }
+  m_buf.reserve(m_buffer_size + 4096);
+}
+
+NdjsonWriter::~NdjsonWriter() {
+  flush();
+  if (m_own_fd)
+    ::close(m_fd);
+}
+
+void NdjsonWriter::flush() {
+  const char *data = m_buf.data();
+  size_t left = m_buf.size();
+  while (m_fd >= 0 && left > 0) {
+    const ssize_t n = ::write(m_fd, data, left);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    data += n;
+    left -= n;
+  }
+  m_buf.clear();
+}
+
+void NdjsonWriter::_begin(const char *type) {
+  m_buf += "{\"game\":";
+  append_int(m_buf, m_game_no);
+  m_buf += ",\"type\":\"";
+  m_buf += type;
+  m_buf += '"';
+}
+
+void NdjsonWriter::_end() {
+  m_buf += "}\n";
+  if (m_buf.size() >= m_buffer_size)
+    flush();
+}
+
+void NdjsonWriter::handle_event(const State &state, const Event &event) {
+  switch (event.type) {
+  case EventType::PLAYER_JOINED:
+    _begin("player_joined");
+    m_buf += ",\"sign\":";
+    m_buf += sign_str(event.data.player_joined.player_sign);
+    m_buf += ",\"name\":";
+    append_json_str(m_buf,
+                    game::get_name(event.data.player_joined.player_name_id));
+    _end();
+    return;
+  case EventType::GAME_STARTED: {
+    const auto &opts = state.get_opts();
+    _begin("game_started");
+    m_buf += ",\"rows\":";
+    append_int(m_buf, opts.rows);
+    m_buf += ",\"cols\":";
+    append_int(m_buf, opts.cols);
+    m_buf += ",\"win_len\":";
+    append_int(m_buf, opts.win_len);
+    m_buf += ",\"max_moves\":";
+    append_int(m_buf, opts.max_moves);
+    m_buf += ",\"walls\":[";
+    bool first = true;
+    for (int x = 0; x < opts.cols; ++x) {
+      for (int y = 0; y < opts.rows; ++y) {
+        if (state.get_value(x, y) != Sign::WALL)
+          continue;
+        if (!first)
+          m_buf += ',';
+        first = false;
+        m_buf += '[';
+        append_int(m_buf, x);
+        m_buf += ',';
+        append_int(m_buf, y);
+        m_buf += ']';
+      }
+    }
+    m_buf += ']';
+    _end();
+    return;
+  }
+  case EventType::MOVE:
+    _begin("move");
+    m_buf += ",\"move_no\":";
+    append_int(m_buf, state.get_move_no());
+    m_buf += ",\"sign\":";
+    m_buf += sign_str(event.data.move.player);
+    m_buf += ",\"x\":";
+    append_int(m_buf, event.data.move.x);
+    m_buf += ",\"y\":";
+    append_int(m_buf, event.data.move.y);
+    _end();
+    return;
+  case EventType::WIN:
+    _begin("win");
+    m_buf += ",\"sign\":";
+    m_buf += sign_str(event.data.win.player);
+    _end();
+    break;
+  case EventType::DRAW:
+    _begin("draw");
+    _end();
+    break;
+  case EventType::DQ:
+    _begin("dq");
+    m_buf += ",\"sign\":";
+    m_buf += sign_str(event.data.dq.player);
+    m_buf += ",\"reason\":";
+    m_buf += dq_str(event.data.dq.reason);
+    _end();
+    break;
+  default:
+    return;
+  }
+  // the game is over
+  ++m_game_no;
+  flush();
+}
+
+}; // namespace ttt::my_player
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <string>
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IObserver;
+using game::State;
+
+// Exports every game event as one JSON object per line. Lines are collected
+// in a userspace buffer which is written out when a game ends or when the
+// buffer grows over `buffer_size` bytes.
+class NdjsonWriter : public IObserver {
+  int m_fd = -1;
+  bool m_own_fd = false;
+  size_t m_buffer_size;
+  std::string m_buf;
+  long m_game_no = 0;
+
+public:
+  // "-" writes to standard output, other paths are opened for appending.
+  NdjsonWriter(const char *path, size_t buffer_size = 1 << 22);
+  NdjsonWriter(const NdjsonWriter &) = delete;
+  NdjsonWriter &operator=(const NdjsonWriter &) = delete;
+  ~NdjsonWriter();
+
+  bool is_open() const { return m_fd >= 0; }
+  void flush();
+
+  void handle_event(const State &state, const Event &event) override;
+
+private:
+  void _begin(const char *type);
+  void _end();
+};
+
+}; // namespace ttt::my_player
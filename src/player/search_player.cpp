@@ -0,0 +1,182 @@
+#include "search_player.hpp"
+
+#include <algorithm>
+
+namespace ttt::my_player {
+
+SearchPlayer::SearchPlayer(const char *name, int timelimit_ms, size_t hash_mb)
+    : m_name(name), m_time(timelimit_ms),
+      m_tt(std::make_shared<engine::TranspositionTable>(hash_mb)) {
+  m_search.set_table(m_tt.get());
+}
+
+SearchPlayer::~SearchPlayer() { _stop_ponder(); }
+
+void SearchPlayer::set_table(std::shared_ptr<engine::TranspositionTable> tt) {
+  _stop_ponder();
+  m_tt = std::move(tt);
+  m_search.set_table(m_tt.get());
+}
+
+void SearchPlayer::set_ponder(bool ponder) {
+  if (!ponder)
+    _stop_ponder();
+  m_ponder = ponder;
+}
+
+// A new game starts, move ordering learnt in the previous one is dropped.
+void SearchPlayer::set_sign(Sign sign) {
+  _stop_ponder();
+  m_sign = sign;
+  m_search.clear_move_order();
+}
+
+const char *SearchPlayer::get_name() const { return m_name; }
+
+void SearchPlayer::handle_event(const State &, const Event &event) {
+  switch (event.type) {
+  case game::EventType::MOVE:
+    if (event.data.move.player == m_sign || !m_ponder_thread.joinable())
+      break;
+    if (event.data.move.x == m_ponder_reply.x &&
+        event.data.move.y == m_ponder_reply.y) {
+      m_ponder_hit = true;
+    } else {
+      // free the cores for the opponent, the table keeps the results
+      _stop_ponder();
+      ++m_ponder_misses;
+    }
+    break;
+  case game::EventType::PLAYER_JOINED:
+    break;
+  default:
+    _stop_ponder();
+    break;
+  }
+}
+
+void SearchPlayer::_stop_ponder() {
+  if (!m_ponder_thread.joinable())
+    return;
+  m_search.set_deadline(engine::Search::Clock::now());
+  m_ponder_thread.join();
+  m_ponder_hit = false;
+}
+
+void SearchPlayer::_start_ponder(const engine::Board &board) {
+  const auto &pv = m_last_result.pv;
+  if (pv.size() < 2)
+    return;
+  engine::Board next = board;
+  next.make(next.index(pv[0].x, pv[0].y));
+  const int reply = next.index(pv[1].x, pv[1].y);
+  if (next.is_over() || !next.is_empty(reply))
+    return;
+  next.make(reply);
+  if (next.is_over())
+    return;
+  m_ponder_reply = pv[1];
+  m_ponder_hash = next.get_hash();
+  m_ponder_move_no = next.get_move_no();
+  m_ponder_hit = false;
+  m_search.clear_deadline();
+  m_tt->new_search();
+  // the time of the move is known only at the hit, it sets the deadlines
+  engine::SearchLimits limits;
+  limits.nodes = m_node_limit;
+  m_ponder_thread = std::thread([this, next, limits]() {
+    m_ponder_result = m_search.run(next, limits);
+  });
+}
+
+Point SearchPlayer::make_move(const State &state) {
+  const auto start = engine::Search::Clock::now();
+  engine::Board board(state, m_weights);
+  if (m_net)
+    board.set_network(m_net);
+  const engine::MoveTime time = m_time.start_move(board, start);
+  engine::SearchLimits limits;
+  limits.time_ms = time.hard_ms;
+  limits.soft_time_ms = time.soft_ms;
+  if (m_node_limit > 0) {
+    limits = engine::SearchLimits();
+    limits.nodes = m_node_limit;
+  }
+  bool searched = false;
+  if (m_ponder_thread.joinable()) {
+    if (m_ponder_hit && board.get_hash() == m_ponder_hash &&
+        board.get_move_no() == m_ponder_move_no) {
+      // the ponder search becomes the search of this move, a node limit was
+      // given to it at the start
+      if (limits.soft_time_ms > 0)
+        m_search.set_soft_deadline(
+            start + std::chrono::milliseconds(limits.soft_time_ms));
+      if (limits.time_ms > 0)
+        m_search.set_deadline(start +
+                              std::chrono::milliseconds(limits.time_ms));
+      m_ponder_thread.join();
+      m_ponder_hit = false;
+      m_last_result = m_ponder_result;
+      searched = m_last_result.move.x >= 0;
+      ++m_ponder_hits;
+    } else {
+      _stop_ponder();
+      ++m_ponder_misses;
+    }
+  }
+  if (!searched && m_tablebase) {
+    Point move;
+    if (m_tablebase->find_move(board, move)) {
+      // the tablebase knows the result but not the distance to it
+      const int win = engine::WIN_SCORE - engine::MAX_PLY;
+      const auto value = m_tablebase->probe(board);
+      m_last_result = engine::SearchResult();
+      m_last_result.move = move;
+      m_last_result.score = value == engine::ProofValue::WIN    ? win
+                            : value == engine::ProofValue::LOSS ? -win
+                                                                : 0;
+      m_last_result.pv = {move};
+      searched = true;
+    }
+  }
+  if (!searched && m_threat_search) {
+    engine::ThreatLimits threat_limits;
+    if (m_node_limit > 0)
+      threat_limits.nodes = std::max<int64_t>(1, m_node_limit / 8);
+    else
+      threat_limits.time_ms = std::max(1, limits.time_ms / 8);
+    // only wins by fours are proofs, the search finds the others
+    const auto threat =
+        m_threat_solver.solve(board, engine::ThreatMode::VCF, threat_limits);
+    if (threat.win) {
+      m_last_result = engine::SearchResult();
+      m_last_result.move = threat.sequence[0];
+      m_last_result.score = engine::WIN_SCORE - int(threat.sequence.size());
+      m_last_result.nodes = threat.nodes;
+      m_last_result.pv = threat.sequence;
+      m_last_result.stats.nodes = threat.nodes;
+      searched = true;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        engine::Search::Clock::now() - start);
+    if (threat.win)
+      m_last_result.time_ms = m_last_result.stats.time_ms = elapsed.count();
+    if (m_node_limit == 0) {
+      limits.time_ms = std::max(1, limits.time_ms - int(elapsed.count()));
+      limits.soft_time_ms =
+          std::max(1, limits.soft_time_ms - int(elapsed.count()));
+    }
+  }
+  if (!searched) {
+    m_search.clear_deadline();
+    m_tt->new_search();
+    m_last_result = m_search.run(board, limits);
+  }
+  if (m_stats_observer)
+    m_stats_observer->on_search(m_last_result.stats);
+  if (m_ponder)
+    _start_ponder(board);
+  return m_last_result.move;
+}
+
+}; // namespace ttt::my_player
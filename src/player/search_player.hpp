@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "engine/nnue.hpp"
+#include "engine/parallel_search.hpp"
+#include "engine/tablebase.hpp"
+#include "engine/threat_solver.hpp"
+#include "engine/time_manager.hpp"
+#include "engine/transposition_table.hpp"
+
+#include <memory>
+#include <thread>
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IPlayer;
+using game::Point;
+using game::Sign;
+using game::State;
+
+// Player which searches the game tree with iterative deepening alpha-beta
+// until the move deadline and plays the best move of the deepest search.
+// With several threads the search runs in Lazy SMP mode. Before the search
+// a threat-space solver looks for a forced win by a chain of fours.
+//
+// With pondering on, after each move the player searches on a background
+// thread the position after the reply it expects. If the opponent plays that
+// reply, the ponder search goes on as the search of the next move, otherwise
+// it is stopped at the MOVE event and only its table entries are left.
+class SearchPlayer : public IPlayer {
+  Sign m_sign = Sign::NONE;
+  const char *m_name;
+  engine::TimeManager m_time;
+  int64_t m_node_limit = 0;
+  engine::EvalWeights m_weights;
+  std::shared_ptr<const engine::Network> m_net;
+  std::shared_ptr<engine::TranspositionTable> m_tt;
+  engine::ParallelSearch m_search;
+  engine::SearchResult m_last_result;
+  engine::ThreatSolver m_threat_solver;
+  bool m_threat_search = true;
+  std::shared_ptr<const engine::Tablebase> m_tablebase;
+  engine::ISearchObserver *m_stats_observer = nullptr;
+
+  bool m_ponder = false;
+  std::thread m_ponder_thread;
+  engine::SearchResult m_ponder_result;
+  // expected reply and the position after it
+  Point m_ponder_reply = {-1, -1};
+  uint64_t m_ponder_hash = 0;
+  int m_ponder_move_no = 0;
+  bool m_ponder_hit = false;
+  int m_ponder_hits = 0;
+  int m_ponder_misses = 0;
+
+public:
+  // `timelimit_ms` is the time limit of the game server for one move.
+  SearchPlayer(const char *name, int timelimit_ms = 300, size_t hash_mb = 16);
+  ~SearchPlayer();
+
+  void set_sign(Sign sign) override;
+  Point make_move(const State &state) override;
+  const char *get_name() const override;
+  void handle_event(const State &state, const Event &event) override;
+
+  void set_timelimit(int timelimit_ms) { m_time.set_limit(timelimit_ms); }
+  int get_timelimit() const { return m_time.get_limit(); }
+  // Deadlines of the moves, a remote client adds round trips to it.
+  engine::TimeManager &get_time_manager() { return m_time; }
+  // Searches every move to this number of nodes instead of the time limit,
+  // so that tests with one thread are reproducible; 0 for the time limit.
+  void set_node_limit(int64_t nodes) { m_node_limit = nodes; }
+  int64_t get_node_limit() const { return m_node_limit; }
+  void set_weights(const engine::EvalWeights &weights) { m_weights = weights; }
+  // Evaluates positions by the network on fields it was trained for.
+  void set_network(std::shared_ptr<const engine::Network> net) {
+    _stop_ponder();
+    m_net = std::move(net);
+  }
+  void set_params(const engine::SearchParams &params) {
+    _stop_ponder();
+    m_search.set_params(params);
+  }
+  void set_threads(int n_threads) {
+    _stop_ponder();
+    m_search.set_threads(n_threads);
+  }
+  int get_threads() const { return m_search.get_threads(); }
+  const engine::SearchResult &get_last_result() const { return m_last_result; }
+  // Gets the statistics of the search of every move, of the threat search
+  // or of the ponder search which became the search of the move.
+  void set_stats_observer(engine::ISearchObserver *observer) {
+    m_stats_observer = observer;
+  }
+
+  // Replaces the own transposition table, for example with a table shared
+  // by several players of one process.
+  void set_table(std::shared_ptr<engine::TranspositionTable> tt);
+  engine::TranspositionTable &get_table() { return *m_tt; }
+
+  void set_threat_search(bool threat_search) {
+    m_threat_search = threat_search;
+  }
+  // Positions of the field of the tablebase are played by it.
+  void set_tablebase(std::shared_ptr<const engine::Tablebase> tablebase) {
+    m_tablebase = std::move(tablebase);
+  }
+
+  void set_ponder(bool ponder);
+  int get_ponder_hits() const { return m_ponder_hits; }
+  int get_ponder_misses() const { return m_ponder_misses; }
+
+private:
+  void _start_ponder(const engine::Board &board);
+  void _stop_ponder();
+};
+
+}; // namespace ttt::my_player
@@ -0,0 +1,150 @@
+#include "terminal_renderer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <unistd.h>
+
+namespace ttt::my_player {
+
+using game::EventType;
+
+// field rows start after the column indices and the separator line
+static const int FIELD_TOP = 3;
+// "yy |" prefix before the first cell
+static const int FIELD_LEFT = 5;
+
+static char sign_char(Sign sign) {
+  switch (sign) {
+  case Sign::X:
+    return 'X';
+  case Sign::O:
+    return 'O';
+  case Sign::WALL:
+    return '#';
+  default:
+    return '.';
+  }
+}
+
+void TerminalRenderer::handle_event(const State &state, const Event &event) {
+  const auto &opts = state.get_opts();
+  if (event.type == EventType::PLAYER_JOINED) {
+    const int i = event.data.player_joined.player_sign == Sign::X ? 0 : 1;
+    m_names[i] = event.data.player_joined.player_name_id;
+    return;
+  }
+  if (event.type == EventType::GAME_STARTED || opts.rows != m_rows ||
+      opts.cols != m_cols) {
+    m_last_x = m_last_y = -1;
+    _draw_full(state);
+  }
+  char status[256];
+  switch (event.type) {
+  case EventType::GAME_STARTED:
+    std::snprintf(status, sizeof(status), "X: %s, O: %s",
+                  game::get_name(m_names[0]), game::get_name(m_names[1]));
+    break;
+  case EventType::MOVE: {
+    const int x = event.data.move.x, y = event.data.move.y;
+    if (m_last_x >= 0)
+      _draw_cell(state, m_last_x, m_last_y, false);
+    if (x >= 0 && x < m_cols && y >= 0 && y < m_rows) {
+      _draw_cell(state, x, y, true);
+      m_last_x = x;
+      m_last_y = y;
+    }
+    std::snprintf(status, sizeof(status), "move %d: %c played (%d, %d)",
+                  state.get_move_no(), sign_char(event.data.move.player), x,
+                  y);
+    break;
+  }
+  case EventType::WIN:
+    std::snprintf(status, sizeof(status), "player %c won!",
+                  sign_char(event.data.win.player));
+    break;
+  case EventType::DRAW:
+    std::snprintf(status, sizeof(status), "draw!");
+    break;
+  case EventType::DQ:
+    std::snprintf(status, sizeof(status), "player %c was disqualified",
+                  sign_char(event.data.dq.player));
+    break;
+  default:
+    return;
+  }
+  _draw_status(status);
+  _flush();
+}
+
+void TerminalRenderer::_draw_full(const State &state) {
+  const auto &opts = state.get_opts();
+  m_rows = opts.rows;
+  m_cols = opts.cols;
+  m_frame += "\x1b[2J\x1b[H   ";
+  char buf[16];
+  for (int x = 0; x < m_cols; ++x) {
+    std::snprintf(buf, sizeof(buf), "%2d", x % 10);
+    m_frame += buf;
+  }
+  m_frame += "\n   +";
+  m_frame.append(2 * m_cols, '-');
+  m_frame += '\n';
+  for (int y = 0; y < m_rows; ++y) {
+    std::snprintf(buf, sizeof(buf), "%2d |", y);
+    m_frame += buf;
+    for (int x = 0; x < m_cols; ++x) {
+      m_frame += sign_char(state.get_value(x, y));
+      m_frame += ' ';
+    }
+    m_frame += '\n';
+  }
+}
+
+void TerminalRenderer::_draw_cell(const State &state, int x, int y,
+                                  bool highlight) {
+  const char c = sign_char(state.get_value(x, y));
+  _move_cursor(FIELD_TOP + y, FIELD_LEFT + 2 * x);
+  if (highlight)
+    m_frame += "\x1b[7m";
+  m_frame += c;
+  if (highlight)
+    m_frame += "\x1b[0m";
+}
+
+void TerminalRenderer::_draw_status(const char *text) {
+  _move_cursor(FIELD_TOP + m_rows + 1, 1);
+  m_frame += "\x1b[2K";
+  m_frame += text;
+  // park the cursor below the field, so other output does not break it
+  _move_cursor(FIELD_TOP + m_rows + 2, 1);
+}
+
+void TerminalRenderer::_move_cursor(int row, int col) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "\x1b[%d;%dH", row, col);
+  m_frame += buf;
+}
+
+void TerminalRenderer::_flush() {
+  if (m_out) {
+    m_out->write(m_frame.data(), m_frame.size());
+    m_out->flush();
+    m_frame.clear();
+    return;
+  }
+  const char *data = m_frame.data();
+  size_t left = m_frame.size();
+  while (left > 0) {
+    const ssize_t n = ::write(m_fd, data, left);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    data += n;
+    left -= n;
+  }
+  m_frame.clear();
+}
+
+}; // namespace ttt::my_player
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/game.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace ttt::my_player {
+
+using game::Event;
+using game::IObserver;
+using game::Sign;
+using game::State;
+
+// Draws the field in an ANSI terminal. The whole field is drawn only when a
+// game starts, after that a move redraws just its cell, the cell of the
+// previous move and the status line using cursor positioning. Each event
+// produces one frame which is written with a single `write` call.
+class TerminalRenderer : public IObserver {
+  int m_fd;
+  std::ostream *m_out = nullptr;
+  int m_rows = 0;
+  int m_cols = 0;
+  int m_last_x = -1;
+  int m_last_y = -1;
+  game::NameId m_names[2] = {};
+  std::string m_frame;
+
+public:
+  TerminalRenderer(int fd = 1) : m_fd(fd) {}
+  // Writes the frames to a stream instead of a file descriptor.
+  TerminalRenderer(std::ostream &out) : m_fd(-1), m_out(&out) {}
+
+  void handle_event(const State &state, const Event &event) override;
+
+  // Redraws the whole screen on the next frame.
+  void invalidate() { m_rows = m_cols = 0; }
+
+private:
+  void _draw_full(const State &state);
+  void _draw_cell(const State &state, int x, int y, bool highlight);
+  void _draw_status(const char *text);
+  void _move_cursor(int row, int col);
+  void _flush();
+};
+
+}; // namespace ttt::my_player
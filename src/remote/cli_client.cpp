@@ -2,17 +2,29 @@
 #include "client.hpp"
 #include "core/event.hpp"
 #include "core/game.hpp"
+#include "player/analysis_writer.hpp"
+#include "player/book_player.hpp"
+#include "player/mcts_player.hpp"
 #include "player/my_observer.hpp"
 #include "player/my_player.hpp"
+#include "player/ndjson_writer.hpp"
+#include "player/search_player.hpp"
+#include "player/terminal_renderer.hpp"
 
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <thread>
+#include <unistd.h>
 
 using ttt::game::EventType;
 using ttt::my_player::ConsoleWriter;
 using ttt::my_player::MyPlayer;
+using ttt::my_player::SearchPlayer;
+using ttt::my_player::TerminalRenderer;
 using ttt::remote::Client;
 using ttt::remote::ClientContext;
 
@@ -65,6 +77,32 @@ int main(int argc, char *argv[]) {
       {"observer", 'o', 0, "connect with observer"},
       {"no-player", 'N', 0, "connect without player"},
       {"retry", 'r', 0, "retry if connection fails"},
+      {"engine", 'e', 1, "player to connect: my, search or mcts", "my"},
+      {"threads", 't', 1, "number of threads of the search player", "1"},
+      {"ponder", 0, 0, "let the search player think on the opponent's time"},
+      {"pages", 0, 1,
+       "pages of the search tables: normal, transparent or huge, huge pages "
+       "fall back to transparent ones",
+       "transparent"},
+      {"nnue", 0, 1, "network weights for the evaluation of the search player"},
+      {"tablebase", 0, 1,
+       "tablebase of the small field for the search player, see cli_tablebase"},
+      {"book", 'b', 1, "opening book for the first moves of the player"},
+      {"book-moves", 0, 1, "number of first moves of the game from the book",
+       "12"},
+      {"plain", 0, 0,
+       "print the whole field after every move instead of redrawing "
+       "changed cells"},
+      {"ndjson", 0, 1, "append game events as NDJSON to file, - for stdout"},
+      {"search-stats", 0, 1,
+       "append statistics of every search of the search player to file, - "
+       "for stderr"},
+      {"analysis", 0, 1,
+       "append live analysis of the positions of the game to file, - for "
+       "stderr; with a player only the positions of the opponent's moves"},
+      {"analysis-lines", 0, 1, "number of best moves of the analysis", "3"},
+      {"analysis-time", 0, 1, "time of the analysis of one position, ms",
+       "2000"},
       {"help", 'h', 0, "show this message"},
   }};
   const char *usage = "usage: cli_client [opts] {player_name}";
@@ -88,18 +126,160 @@ int main(int argc, char *argv[]) {
     return 1;
   }
   bool retry = args.has_flag("retry");
+  const char *engine = cli.get_default("engine");
+  if (const char *const *kw = args.get_keyword("engine", 0))
+    engine = *kw;
+  // the tables are allocated and their pages mapped with the players
+  const char *pages = cli.get_default("pages");
+  if (const char *const *kw = args.get_keyword("pages", 0))
+    pages = *kw;
+  ttt::engine::PageMode page_policy;
+  if (!ttt::engine::parse_page_mode(pages, page_policy)) {
+    std::cerr << "error: unknown pages " << pages << ", see --help\n";
+    return 1;
+  }
+  ttt::engine::set_page_policy(page_policy);
   MyPlayer p1(name);
+  // the search and the tree arena of the players are only allocated when
+  // they play
+  std::unique_ptr<SearchPlayer> search_player;
+  std::unique_ptr<ttt::my_player::MctsPlayer> mcts_player;
+  ttt::game::IPlayer *player = &p1;
+  if (std::strcmp(engine, "search") == 0) {
+    search_player = std::make_unique<SearchPlayer>(name);
+    player = search_player.get();
+  } else if (std::strcmp(engine, "mcts") == 0) {
+    mcts_player = std::make_unique<ttt::my_player::MctsPlayer>(name);
+    player = mcts_player.get();
+    std::cout << "node arena: "
+              << ttt::engine::to_string(mcts_player->get_page_mode())
+              << " pages\n";
+  } else if (std::strcmp(engine, "my") != 0) {
+    std::cerr << "error: unknown engine " << engine << ", see --help\n";
+    return 1;
+  }
+  std::ofstream stats_file;
+  std::unique_ptr<ttt::engine::SearchStatsLog> stats_log;
+  if (search_player) {
+    std::cout << "transposition table: "
+              << search_player->get_table().get_size_bytes() / (1 << 20)
+              << " MB, "
+              << ttt::engine::to_string(
+                     search_player->get_table().get_page_mode())
+              << " pages\n";
+    const char *threads = cli.get_default("threads");
+    if (const char *const *kw = args.get_keyword("threads", 0))
+      threads = *kw;
+    search_player->set_threads(std::atoi(threads));
+    search_player->set_ponder(args.has_flag("ponder"));
+    if (const char *const *kw = args.get_keyword("nnue", 0)) {
+      auto net = std::make_shared<ttt::engine::Network>();
+      const char *error = nullptr;
+      if (!net->open(*kw, &error)) {
+        std::cerr << "error: " << *kw << ": " << error << '\n';
+        return 1;
+      }
+      search_player->set_network(net);
+    }
+    if (const char *const *kw = args.get_keyword("tablebase", 0)) {
+      auto tablebase = std::make_shared<ttt::engine::Tablebase>();
+      const char *error = nullptr;
+      if (!tablebase->open(*kw, &error)) {
+        std::cerr << "error: " << *kw << ": " << error << '\n';
+        return 1;
+      }
+      search_player->set_tablebase(tablebase);
+    }
+    if (const char *const *kw = args.get_keyword("search-stats", 0)) {
+      if (std::strcmp(*kw, "-") != 0) {
+        stats_file.open(*kw, std::ios::app);
+        if (!stats_file) {
+          std::cerr << "error: cannot open " << *kw << '\n';
+          return 1;
+        }
+      }
+      stats_log = std::make_unique<ttt::engine::SearchStatsLog>(
+          stats_file.is_open() ? static_cast<std::ostream &>(stats_file)
+                               : std::cerr);
+      search_player->set_stats_observer(stats_log.get());
+    }
+  }
+  std::unique_ptr<ttt::my_player::BookPlayer> book_player;
+  if (const char *const *kw = args.get_keyword("book", 0)) {
+    auto book = std::make_shared<ttt::engine::OpeningBook>();
+    const char *error = nullptr;
+    if (!book->open(*kw, &error)) {
+      std::cerr << "error: " << *kw << ": " << error << '\n';
+      return 1;
+    }
+    const char *book_moves = cli.get_default("book-moves");
+    if (const char *const *moves = args.get_keyword("book-moves", 0))
+      book_moves = *moves;
+    book_player = std::make_unique<ttt::my_player::BookPlayer>(
+        *player, book, std::atoi(book_moves));
+    player = book_player.get();
+  }
   ttt::game::ComposedObserver obs;
   FieldPrinter printer;
   ConsoleWriter writer;
-  obs.add_observer(&printer);
-  obs.add_observer(&writer);
-  ClientBuilder builder(cli, args);
+  TerminalRenderer renderer;
+  if (args.has_flag("plain") || !isatty(STDOUT_FILENO)) {
+    obs.add_observer(&printer);
+    obs.add_observer(&writer);
+  } else {
+    obs.add_observer(&renderer);
+  }
+  ttt::game::ComposedObserver all_obs;
   if (args.has_flag("no-player") || args.has_flag("observer")) {
-    builder.observer = &obs;
+    all_obs.add_observer(&obs);
+  }
+  std::unique_ptr<ttt::my_player::NdjsonWriter> ndjson;
+  if (const char *const *kw = args.get_keyword("ndjson", 0)) {
+    ndjson = std::make_unique<ttt::my_player::NdjsonWriter>(*kw);
+    if (!ndjson->is_open()) {
+      std::cerr << "cannot open " << *kw << '\n';
+      return 1;
+    }
+    all_obs.add_observer(ndjson.get());
+  }
+  // the analysis shares the table of the search player if it plays, else it
+  // allocates its own; it runs only while the opponent thinks, but then it
+  // takes a core from the pondering
+  std::ofstream analysis_file;
+  std::unique_ptr<ttt::my_player::AnalysisWriter> analysis;
+  std::unique_ptr<ttt::my_player::AnalysedPlayer> analysed_player;
+  if (const char *const *kw = args.get_keyword("analysis", 0)) {
+    if (std::strcmp(*kw, "-") != 0) {
+      analysis_file.open(*kw, std::ios::app);
+      if (!analysis_file) {
+        std::cerr << "error: cannot open " << *kw << '\n';
+        return 1;
+      }
+    }
+    const char *lines = cli.get_default("analysis-lines");
+    if (const char *const *n = args.get_keyword("analysis-lines", 0))
+      lines = *n;
+    ttt::engine::SearchLimits limits;
+    limits.time_ms = std::atoi(cli.get_default("analysis-time"));
+    if (const char *const *ms = args.get_keyword("analysis-time", 0))
+      limits.time_ms = std::atoi(*ms);
+    analysis = std::make_unique<ttt::my_player::AnalysisWriter>(
+        analysis_file.is_open() ? static_cast<std::ostream &>(analysis_file)
+                                : std::cerr,
+        std::atoi(lines), limits,
+        search_player ? &search_player->get_table() : nullptr);
+    all_obs.add_observer(analysis.get());
+    analysed_player =
+        std::make_unique<ttt::my_player::AnalysedPlayer>(*player, *analysis);
+    player = analysed_player.get();
+  }
+  ClientBuilder builder(cli, args);
+  if (args.has_flag("no-player") || args.has_flag("observer") || ndjson ||
+      analysis) {
+    builder.observer = &all_obs;
   }
   if (!args.has_flag("no-player")) {
-    builder.player = &p1;
+    builder.player = player;
   }
 
   ClientContext ctx;
@@ -117,6 +297,10 @@ int main(int argc, char *argv[]) {
       retry_timeout *= 1.2;
     } else {
       std::cout << "connected to server\n";
+      if (search_player)
+        client.set_time_manager(&search_player->get_time_manager());
+      else if (mcts_player)
+        client.set_time_manager(&mcts_player->get_time_manager());
       if (client.get_token().empty())
         std::cout << "server has not sent any identity token\n";
       else
@@ -1,4 +1,5 @@
 #include "cli_utils.hpp"
+#include "player/ndjson_writer.hpp"
 #include "server.hpp"
 
 #include <cstdlib>
@@ -26,6 +27,7 @@ int main(int argc, char *argv[]) {
       {"obstacle-max-len", 0, 1, "defines size of each obstacles series", "50"},
       {"obstacle-gap", 0, 1, "defines space between obstacles", "1"},
       {"non-interactive", 'N', 0, "run one game with two first players"},
+      {"ndjson", 0, 1, "append game events as NDJSON to file, - for stdout"},
       {"help", 'h', 0, "show this message"},
   }};
   const char *usage = "usage: cli_server [opts]";
@@ -113,6 +115,15 @@ int main(int argc, char *argv[]) {
     server.set_initializer(std::make_unique<ttt::game::RandomObstaclesFI>(
         playable_part, obstacle_len, gap));
   }
+  std::unique_ptr<ttt::my_player::NdjsonWriter> ndjson;
+  if ((kw = args.get_keyword("ndjson", 0))) {
+    ndjson = std::make_unique<ttt::my_player::NdjsonWriter>(*kw);
+    if (!ndjson->is_open()) {
+      std::cerr << "cannot open " << *kw << '\n';
+      return 1;
+    }
+    server.add_observer(ndjson.get());
+  }
   server.bind(addr);
   if (!server.is_running()) {
     std::cerr << "cannot connect to " << addr << '\n';
@@ -70,6 +70,11 @@ bool Client::handle_one_update(int timelimit_ms) {
     return true;
   if (!wait_for_input(m_sock, timelimit_ms))
     return false;
+  if (m_time && m_sent)
+    m_time->add_round_trip(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - m_sent_at)
+                               .count());
+  m_sent = false;
   ttt_dto::Update update;
   if (!recv_dto(m_sock, update)) {
     std::cerr << "bad message, disconnecting...\n";
@@ -147,10 +152,18 @@ void Client::handle_all_updates() {
   }
 }
 
+void Client::set_time_manager(engine::TimeManager *time) {
+  m_time = time;
+  if (m_time && m_timelimit_ms > 0)
+    m_time->set_limit(m_timelimit_ms);
+}
+
 void Client::send_ready() {
   ttt_dto::ClientResponse resp;
   resp.set_type(ttt_dto::ClientResponseType::READY);
   send_dto(m_sock, resp);
+  m_sent_at = std::chrono::steady_clock::now();
+  m_sent = true;
 }
 
 void Client::send_move(int x, int y) {
@@ -159,6 +172,8 @@ void Client::send_move(int x, int y) {
   resp.set_move_x(x);
   resp.set_move_y(y);
   send_dto(m_sock, resp);
+  m_sent_at = std::chrono::steady_clock::now();
+  m_sent = true;
 }
 
 void Client::disconnect(const char *reason, bool should_retry) {
@@ -1,6 +1,8 @@
 #pragma once
 #include "core/game.hpp"
+#include "engine/time_manager.hpp"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <zmq.hpp>
@@ -22,6 +24,10 @@ class Client {
   std::unique_ptr<State> m_state;
   int m_timelimit_ms;
   bool m_should_retry = false;
+  engine::TimeManager *m_time = nullptr;
+  // when the last response was sent, the next update completes a round trip
+  std::chrono::steady_clock::time_point m_sent_at;
+  bool m_sent = false;
 
 public:
   Client();
@@ -36,6 +42,10 @@ public:
   void handle_all_updates();
   void close() { m_sock.close(); }
   bool should_retry() const { return m_should_retry; }
+  // Time limit for one move sent by the server or -1.
+  int get_timelimit_ms() const { return m_timelimit_ms; }
+  // Gets the time limit of the server and the measured round trips.
+  void set_time_manager(engine::TimeManager *time);
 
 private:
   void send_ready();
@@ -41,7 +41,7 @@ Event translate_event(const ttt_dto::Event &ev) {
   if (ev.has_player_joined()) {
     return Event::make_player_joined_event(
         translate_sign(ev.player_joined().sign()),
-        ev.player_joined().name().c_str());
+        game::intern_name(ev.player_joined().name().c_str()));
   }
   throw "unknown error";
 }
@@ -93,7 +93,8 @@ ttt_dto::Event translate_event(const Event &ev, const State &state) {
   case EventType::PLAYER_JOINED:
     result.mutable_player_joined()->set_sign(
         translate_sign(ev.data.player_joined.player_sign));
-    result.mutable_player_joined()->set_name(ev.data.player_joined.player_name);
+    result.mutable_player_joined()->set_name(
+        game::get_name(ev.data.player_joined.player_name_id));
     break;
   }
   return result;
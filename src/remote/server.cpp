@@ -70,7 +70,8 @@ bool send_to_client(zmq::socket_t &sock, const DtoType &dto,
 
 RemotePlayer::RemotePlayer(zmq::socket_t &sock, const ClientIdentity &id,
                            std::string name, int timelimit_ms)
-    : m_sock(sock), m_fallback(), m_id(id), m_name(name),
+    : m_sock(sock), m_fallback(), m_id(id),
+      m_name(game::intern_name(name.c_str())),
       m_timelimit_ms(timelimit_ms) {}
 
 void RemotePlayer::set_fallback(IFallbackServerAction *fallback) {
@@ -132,7 +133,7 @@ void RemotePlayer::handle_event(const State &game, const game::Event &event) {
   }
 }
 
-const char *RemotePlayer::get_name() const { return m_name.c_str(); }
+const char *RemotePlayer::get_name() const { return game::get_name(m_name); }
 
 void RemotePlayer::set_opts(const State::Opts &opts) { m_opts = opts; }
 
@@ -165,6 +166,10 @@ void BasicServer::set_initializer(std::unique_ptr<game::IFieldInitializer>&& new
   m_initializer = std::move(new_init);
 }
 
+void BasicServer::add_observer(game::IObserver *observer) {
+  m_local_observers.push_back(observer);
+}
+
 bool BasicServer::is_running() const { return m_error == 0; }
 
 const char *BasicServer::get_error_msg() const { return m_error; }
@@ -271,6 +276,8 @@ void BasicServer::run_game(const State::Opts &opts, IPlayer *x_player,
   RemoteObserver obs(m_observers, m_sock, *this, m_timelimit_ms);
   obs.set_opts(opts);
   game_instance.add_observer(&obs);
+  for (auto *local : m_local_observers)
+    game_instance.add_observer(local);
   while (game::MoveResult::OK == game_instance.process())
     ;
   // game_instance.remove_observer(&obs);
@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <zmq.hpp>
 
 namespace ttt::remote {
@@ -29,7 +30,7 @@ class RemotePlayer : public IPlayer {
   zmq::socket_t &m_sock;
   std::unique_ptr<IFallbackServerAction> m_fallback;
   State::Opts m_opts;
-  std::string m_name;
+  game::NameId m_name;
   ClientIdentity m_id;
   int m_timelimit_ms;
 
@@ -81,6 +82,7 @@ class BasicServer {
   std::list<RemotePlayer> m_players;
   std::unordered_map<ClientIdentity, PendingClientInfo> m_pending;
   std::unique_ptr<game::IFieldInitializer> m_initializer;
+  std::vector<game::IObserver *> m_local_observers;
 
 public:
   BasicServer(zmq::context_t &ctx, int timelimit_ms);
@@ -92,6 +94,8 @@ public:
   void accept_observers(bool accept);
 
   void set_initializer(std::unique_ptr<game::IFieldInitializer>&& new_init);
+  // Observers running in the server process, they see every game.
+  void add_observer(game::IObserver *observer);
 
   bool is_running() const;
   const char *get_error_msg() const;
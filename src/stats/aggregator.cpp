@@ -0,0 +1,210 @@
+#include "aggregator.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+namespace ttt::stats {
+
+static int threads_num(int requested) {
+  if (requested > 0)
+    return requested;
+  const int hw = std::thread::hardware_concurrency();
+  return hw > 0 ? hw : 1;
+}
+
+// Splits rows into contiguous ranges and calls `fn(begin, end, thread_no)`.
+template <class Fn> static void parallel_rows(size_t n_rows, int n, Fn fn) {
+  std::vector<std::thread> threads;
+  const size_t step = (n_rows + n - 1) / n;
+  for (int i = 1; i < n; ++i) {
+    const size_t begin = std::min(n_rows, step * i);
+    const size_t end = std::min(n_rows, begin + step);
+    threads.emplace_back(fn, begin, end, i);
+  }
+  fn(size_t(0), std::min(n_rows, step), 0);
+  for (auto &t : threads)
+    t.join();
+}
+
+static bool matches(const ColumnStore &store, const Query &query, size_t i) {
+  if (query.player >= 0 && store.moves.player[i] != query.player)
+    return false;
+  if (query.sign != 0 && store.moves.sign[i] != query.sign)
+    return false;
+  return true;
+}
+
+std::vector<Heatmap> compute_heatmaps(const ColumnStore &store,
+                                      const Query &query) {
+  // field size of every game, games with the same size share a heatmap
+  std::vector<Heatmap> result;
+  std::unordered_map<uint32_t, int> size_no;
+  std::unordered_map<uint64_t, int> game_size;
+  for (size_t i = 0; i < store.get_games_num(); ++i) {
+    const int rows = store.games.rows[i], cols = store.games.cols[i];
+    const uint32_t key = uint32_t(rows) << 16 | cols;
+    auto it = size_no.find(key);
+    if (it == size_no.end()) {
+      it = size_no.emplace(key, result.size()).first;
+      result.emplace_back();
+      result.back().rows = rows;
+      result.back().cols = cols;
+    }
+    game_size[store.games.game_id[i]] = it->second;
+  }
+  const int n = threads_num(query.n_threads);
+  const int n_sizes = result.size();
+  // moves and wins of every size for every thread
+  std::vector<std::vector<std::vector<long>>> moves(n), wins(n);
+  parallel_rows(store.get_moves_num(), n,
+                [&](size_t begin, size_t end, int thread_no) {
+                  auto &m = moves[thread_no];
+                  auto &w = wins[thread_no];
+                  m.resize(n_sizes);
+                  w.resize(n_sizes);
+                  for (size_t i = begin; i < end; ++i) {
+                    const auto it = game_size.find(store.moves.game_id[i]);
+                    if (it == game_size.end() || !matches(store, query, i))
+                      continue;
+                    const Heatmap &h = result[it->second];
+                    const int x = store.moves.x[i], y = store.moves.y[i];
+                    if (x >= h.cols || y >= h.rows)
+                      continue;
+                    if (m[it->second].empty()) {
+                      m[it->second].assign(h.rows * h.cols, 0);
+                      w[it->second].assign(h.rows * h.cols, 0);
+                    }
+                    ++m[it->second][y * h.cols + x];
+                    w[it->second][y * h.cols + x] +=
+                        store.moves.outcome[i] == uint8_t(Outcome::WIN);
+                  }
+                });
+  std::vector<long> totals(n_sizes, 0);
+  for (int s = 0; s < n_sizes; ++s) {
+    Heatmap &h = result[s];
+    h.moves.assign(h.rows * h.cols, 0);
+    h.wins.assign(h.rows * h.cols, 0);
+    for (int t = 0; t < n; ++t) {
+      if (moves[t][s].empty())
+        continue;
+      for (size_t c = 0; c < h.moves.size(); ++c) {
+        h.moves[c] += moves[t][s][c];
+        h.wins[c] += wins[t][s][c];
+        totals[s] += moves[t][s][c];
+      }
+    }
+  }
+  std::vector<int> order;
+  for (int s = 0; s < n_sizes; ++s)
+    if (totals[s] > 0)
+      order.push_back(s);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return totals[a] > totals[b]; });
+  std::vector<Heatmap> sorted;
+  for (const int s : order)
+    sorted.push_back(std::move(result[s]));
+  return sorted;
+}
+
+MoveNumberStats compute_move_number_stats(const ColumnStore &store,
+                                          const Query &query) {
+  const int n = threads_num(query.n_threads);
+  std::vector<MoveNumberStats> partial(n);
+  parallel_rows(store.get_moves_num(), n,
+                [&](size_t begin, size_t end, int thread_no) {
+                  auto &p = partial[thread_no];
+                  for (size_t i = begin; i < end; ++i) {
+                    if (!matches(store, query, i))
+                      continue;
+                    const size_t move_no = store.moves.move_no[i];
+                    if (move_no >= p.moves.size()) {
+                      p.moves.resize(move_no + 1, 0);
+                      p.wins.resize(move_no + 1, 0);
+                      p.draws.resize(move_no + 1, 0);
+                    }
+                    ++p.moves[move_no];
+                    p.wins[move_no] +=
+                        store.moves.outcome[i] == uint8_t(Outcome::WIN);
+                    p.draws[move_no] +=
+                        store.moves.outcome[i] == uint8_t(Outcome::DRAW);
+                  }
+                });
+  MoveNumberStats result;
+  for (const auto &p : partial) {
+    if (p.moves.size() > result.moves.size()) {
+      result.moves.resize(p.moves.size(), 0);
+      result.wins.resize(p.moves.size(), 0);
+      result.draws.resize(p.moves.size(), 0);
+    }
+    for (size_t i = 0; i < p.moves.size(); ++i) {
+      result.moves[i] += p.moves[i];
+      result.wins[i] += p.wins[i];
+      result.draws[i] += p.draws[i];
+    }
+  }
+  return result;
+}
+
+LatencyHistogram compute_latency(const ColumnStore &store,
+                                 const Query &query) {
+  const int n = threads_num(query.n_threads);
+  std::vector<LatencyHistogram> partial(n);
+  parallel_rows(store.get_moves_num(), n,
+                [&](size_t begin, size_t end, int thread_no) {
+                  auto &h = partial[thread_no];
+                  for (size_t i = begin; i < end; ++i)
+                    if (matches(store, query, i))
+                      h.add(store.moves.think_us[i]);
+                });
+  LatencyHistogram result;
+  for (const auto &h : partial)
+    result.merge(h);
+  return result;
+}
+
+int LatencyHistogram::bucket(uint32_t value) {
+  if (value < SUB_BUCKETS)
+    return value;
+  int exp = 31 - __builtin_clz(value);
+  const int sub = (value >> (exp - 4)) & (SUB_BUCKETS - 1);
+  return (exp - 3) * SUB_BUCKETS + sub;
+}
+
+uint32_t LatencyHistogram::bucket_value(int bucket) {
+  if (bucket < SUB_BUCKETS)
+    return bucket;
+  const int exp = bucket / SUB_BUCKETS + 3;
+  const uint64_t low = uint64_t(SUB_BUCKETS + bucket % SUB_BUCKETS)
+                       << (exp - 4);
+  return low + (uint64_t(1) << (exp - 4)) / 2;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  for (int i = 0; i < N_BUCKETS; ++i)
+    m_counts[i] += other.m_counts[i];
+}
+
+long LatencyHistogram::_total() const {
+  long total = 0;
+  for (long c : m_counts)
+    total += c;
+  return total;
+}
+
+uint32_t LatencyHistogram::percentile(double p) const {
+  const long total = _total();
+  if (total == 0)
+    return 0;
+  long rank = long(p / 100. * total + 0.5);
+  rank = std::max(1L, std::min(rank, total));
+  long seen = 0;
+  for (int i = 0; i < N_BUCKETS; ++i) {
+    seen += m_counts[i];
+    if (seen >= rank)
+      return bucket_value(i);
+  }
+  return bucket_value(N_BUCKETS - 1);
+}
+
+}; // namespace ttt::stats
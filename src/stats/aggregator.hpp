@@ -0,0 +1,64 @@
+#pragma once
+
+#include "column_store.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace ttt::stats {
+
+struct Query {
+  int player = -1;   // player id or -1 for all players
+  int sign = 0;      // game::Sign as int, 0 (NONE) for both signs
+  int n_threads = 0; // 0 for all hardware threads
+};
+
+// Moves of the games of one field size.
+struct Heatmap {
+  int rows = 0;
+  int cols = 0;
+  std::vector<long> moves; // row-major, rows * cols
+  std::vector<long> wins;
+
+  long get_moves(int x, int y) const { return moves[y * cols + x]; }
+  long get_wins(int x, int y) const { return wins[y * cols + x]; }
+};
+
+struct MoveNumberStats {
+  // indexed by move number, from the point of view of the moving player
+  std::vector<long> moves;
+  std::vector<long> wins;
+  std::vector<long> draws;
+};
+
+// Log-linear histogram of think times: values up to 2^32 us with relative
+// error below 1/16.
+class LatencyHistogram {
+public:
+  static const int SUB_BUCKETS = 16;
+  static const int N_BUCKETS = 33 * SUB_BUCKETS;
+
+  LatencyHistogram() : m_counts(N_BUCKETS, 0) {}
+  void add(uint32_t value_us) { ++m_counts[bucket(value_us)]; }
+  void merge(const LatencyHistogram &other);
+  long get_count() const { return _total(); }
+  // `p` in [0; 100]
+  uint32_t percentile(double p) const;
+
+  static int bucket(uint32_t value);
+  static uint32_t bucket_value(int bucket);
+
+private:
+  std::vector<long> m_counts;
+  long _total() const;
+};
+
+// One heatmap for every field size with matching moves, the sizes with more
+// moves go first.
+std::vector<Heatmap> compute_heatmaps(const ColumnStore &store,
+                                      const Query &query);
+MoveNumberStats compute_move_number_stats(const ColumnStore &store,
+                                          const Query &query);
+LatencyHistogram compute_latency(const ColumnStore &store, const Query &query);
+
+}; // namespace ttt::stats
@@ -0,0 +1,223 @@
+#include "column_store.hpp"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ttt::stats {
+
+static const char *COLUMN_NAMES[] = {
+    "games.game_id",  "games.layout_id", "games.rows",    "games.cols",
+    "games.x_player", "games.o_player",  "games.winner",  "games.result",
+    "games.n_moves",  "moves.game_id",   "moves.move_no", "moves.player",
+    "moves.sign",     "moves.outcome",   "moves.x",       "moves.y",
+    "moves.think_us",
+};
+
+enum ColumnNo {
+  G_GAME_ID,
+  G_LAYOUT_ID,
+  G_ROWS,
+  G_COLS,
+  G_X_PLAYER,
+  G_O_PLAYER,
+  G_WINNER,
+  G_RESULT,
+  G_N_MOVES,
+  M_GAME_ID,
+  M_MOVE_NO,
+  M_PLAYER,
+  M_SIGN,
+  M_OUTCOME,
+  M_X,
+  M_Y,
+  M_THINK_US,
+  N_COLUMNS,
+};
+
+static std::vector<std::string> read_players(const std::string &dir) {
+  std::vector<std::string> result;
+  std::ifstream in(dir + "/players.txt");
+  std::string line;
+  while (std::getline(in, line))
+    result.push_back(line);
+  return result;
+}
+
+ColumnWriter::ColumnWriter(const char *dir) : m_dir(dir) {
+  ::mkdir(dir, 0755);
+  std::ifstream ids(m_dir + "/" + COLUMN_NAMES[G_GAME_ID], std::ios::binary);
+  for (uint64_t id; ids.read(reinterpret_cast<char *>(&id), sizeof(id));)
+    m_next_game_id = std::max(m_next_game_id, id + 1);
+  m_players = read_players(m_dir);
+  for (size_t i = 0; i < m_players.size(); ++i)
+    m_player_ids[m_players[i]] = i;
+  m_players_file = std::fopen((m_dir + "/players.txt").c_str(), "a");
+  if (!m_players_file)
+    m_ok = false;
+  m_columns.resize(N_COLUMNS);
+  for (int i = 0; i < N_COLUMNS; ++i)
+    _open_column(i);
+}
+
+ColumnWriter::~ColumnWriter() {
+  for (auto &col : m_columns)
+    if (col.file)
+      std::fclose(col.file);
+  if (m_players_file)
+    std::fclose(m_players_file);
+}
+
+void ColumnWriter::_open_column(int i) {
+  Column &column = m_columns[i];
+  column.file = std::fopen((m_dir + "/" + COLUMN_NAMES[i]).c_str(), "ab");
+  if (!column.file) {
+    m_ok = false;
+    return;
+  }
+  column.buf.resize(1 << 16);
+  std::setvbuf(column.file, column.buf.data(), _IOFBF, column.buf.size());
+}
+
+uint16_t ColumnWriter::get_player_id(const std::string &name) {
+  auto it = m_player_ids.find(name);
+  if (it != m_player_ids.end())
+    return it->second;
+  const uint16_t id = m_players.size();
+  m_players.push_back(name);
+  m_player_ids[name] = id;
+  if (m_players_file) {
+    std::fprintf(m_players_file, "%s\n", name.c_str());
+    std::fflush(m_players_file);
+  }
+  return id;
+}
+
+void ColumnWriter::append_game(const GameRecord &game, const MoveRecord *moves,
+                               int n_moves) {
+  if (!m_ok)
+    return;
+  m_next_game_id = std::max(m_next_game_id, game.game_id + 1);
+  _put(G_GAME_ID, game.game_id);
+  _put(G_LAYOUT_ID, game.layout_id);
+  _put(G_ROWS, game.rows);
+  _put(G_COLS, game.cols);
+  _put(G_X_PLAYER, game.x_player);
+  _put(G_O_PLAYER, game.o_player);
+  _put(G_WINNER, game.winner);
+  _put(G_RESULT, game.result);
+  _put(G_N_MOVES, game.n_moves);
+  for (int i = 0; i < n_moves; ++i) {
+    const MoveRecord &mv = moves[i];
+    _put(M_GAME_ID, mv.game_id);
+    _put(M_MOVE_NO, mv.move_no);
+    _put(M_PLAYER, mv.player);
+    _put(M_SIGN, mv.sign);
+    _put(M_OUTCOME, mv.outcome);
+    _put(M_X, mv.x);
+    _put(M_Y, mv.y);
+    _put(M_THINK_US, mv.think_us);
+  }
+}
+
+void ColumnWriter::flush() {
+  for (auto &col : m_columns)
+    if (col.file)
+      std::fflush(col.file);
+}
+
+ColumnStore::~ColumnStore() { close(); }
+
+void ColumnStore::close() {
+  for (auto &m : m_mappings)
+    munmap(m.data, m.size);
+  m_mappings.clear();
+  m_players.clear();
+  games = GameColumns();
+  moves = MoveColumns();
+  m_games_num = m_moves_num = 0;
+  m_error = nullptr;
+}
+
+template <class T>
+bool ColumnStore::_map(const std::string &dir, const char *name,
+                       ColumnView<T> &view) {
+  const std::string path = dir + "/" + name;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    m_error = "cannot open column file";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    m_error = "cannot stat column file";
+    return false;
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    view = ColumnView<T>();
+    return true;
+  }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    m_error = "cannot map column file";
+    return false;
+  }
+  m_mappings.push_back(Mapping{data, size_t(st.st_size)});
+  view = ColumnView<T>(data, st.st_size);
+  return true;
+}
+
+bool ColumnStore::open(const char *dir_cstr) {
+  close();
+  const std::string dir(dir_cstr);
+  bool ok = _map(dir, COLUMN_NAMES[G_GAME_ID], games.game_id) &&
+            _map(dir, COLUMN_NAMES[G_LAYOUT_ID], games.layout_id) &&
+            _map(dir, COLUMN_NAMES[G_ROWS], games.rows) &&
+            _map(dir, COLUMN_NAMES[G_COLS], games.cols) &&
+            _map(dir, COLUMN_NAMES[G_X_PLAYER], games.x_player) &&
+            _map(dir, COLUMN_NAMES[G_O_PLAYER], games.o_player) &&
+            _map(dir, COLUMN_NAMES[G_WINNER], games.winner) &&
+            _map(dir, COLUMN_NAMES[G_RESULT], games.result) &&
+            _map(dir, COLUMN_NAMES[G_N_MOVES], games.n_moves) &&
+            _map(dir, COLUMN_NAMES[M_GAME_ID], moves.game_id) &&
+            _map(dir, COLUMN_NAMES[M_MOVE_NO], moves.move_no) &&
+            _map(dir, COLUMN_NAMES[M_PLAYER], moves.player) &&
+            _map(dir, COLUMN_NAMES[M_SIGN], moves.sign) &&
+            _map(dir, COLUMN_NAMES[M_OUTCOME], moves.outcome) &&
+            _map(dir, COLUMN_NAMES[M_X], moves.x) &&
+            _map(dir, COLUMN_NAMES[M_Y], moves.y) &&
+            _map(dir, COLUMN_NAMES[M_THINK_US], moves.think_us);
+  if (!ok) {
+    const char *error = m_error;
+    close();
+    m_error = error;
+    return false;
+  }
+  m_players = read_players(dir);
+  // an interrupted writer may leave columns of different length
+  m_games_num = std::min({games.game_id.size(), games.layout_id.size(),
+                          games.rows.size(), games.cols.size(),
+                          games.x_player.size(), games.o_player.size(),
+                          games.winner.size(), games.result.size(),
+                          games.n_moves.size()});
+  m_moves_num = std::min({moves.game_id.size(), moves.move_no.size(),
+                          moves.player.size(), moves.sign.size(),
+                          moves.outcome.size(), moves.x.size(), moves.y.size(),
+                          moves.think_us.size()});
+  return true;
+}
+
+int ColumnStore::find_player(const std::string &name) const {
+  for (size_t i = 0; i < m_players.size(); ++i)
+    if (m_players[i] == name)
+      return i;
+  return -1;
+}
+
+}; // namespace ttt::stats
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ttt::stats {
+
+/*
+  Statistics are stored column by column: every field of a table lives in its
+  own file `<dir>/<table>.<field>` as a plain array of fixed-width integers.
+  Player names are kept once in `<dir>/players.txt`, one name per line, and
+  tables refer to them by line number.
+*/
+
+// Result of the game from the point of view of the player who made the move.
+enum class Outcome : uint8_t { LOSS, DRAW, WIN };
+
+struct GameRecord {
+  uint64_t game_id;
+  uint64_t layout_id; // hash of field size and walls
+  uint16_t rows;
+  uint16_t cols;
+  uint16_t x_player;
+  uint16_t o_player;
+  uint8_t winner; // game::Sign
+  uint8_t result; // game::MoveResult of the last move
+  uint16_t n_moves;
+};
+
+struct MoveRecord {
+  uint64_t game_id;
+  uint16_t move_no;
+  uint16_t player;
+  uint8_t sign; // game::Sign
+  uint8_t outcome;
+  uint16_t x;
+  uint16_t y;
+  uint32_t think_us;
+};
+
+class ColumnWriter {
+  struct Column {
+    std::FILE *file = nullptr;
+    std::vector<char> buf;
+  };
+
+  std::string m_dir;
+  std::vector<Column> m_columns;
+  std::vector<std::string> m_players;
+  std::unordered_map<std::string, uint16_t> m_player_ids;
+  std::FILE *m_players_file = nullptr;
+  uint64_t m_next_game_id = 0;
+  bool m_ok = true;
+
+public:
+  ColumnWriter(const char *dir);
+  ColumnWriter(const ColumnWriter &) = delete;
+  ColumnWriter &operator=(const ColumnWriter &) = delete;
+  ~ColumnWriter();
+
+  bool is_open() const { return m_ok; }
+  uint16_t get_player_id(const std::string &name);
+  // Id after the largest one of the games in the store, so that appended
+  // games get new ids.
+  uint64_t get_next_game_id() const { return m_next_game_id; }
+
+  // Moves of one game are appended together with the game row.
+  void append_game(const GameRecord &game, const MoveRecord *moves,
+                   int n_moves);
+  void flush();
+
+private:
+  void _open_column(int i);
+  template <class T> void _put(int column, T value) {
+    std::fwrite(&value, sizeof(T), 1, m_columns[column].file);
+  }
+};
+
+template <class T> class ColumnView {
+  const T *m_data = nullptr;
+  size_t m_size = 0;
+
+public:
+  ColumnView() = default;
+  ColumnView(const void *data, size_t bytes)
+      : m_data(static_cast<const T *>(data)), m_size(bytes / sizeof(T)) {}
+  const T &operator[](size_t i) const { return m_data[i]; }
+  const T *data() const { return m_data; }
+  size_t size() const { return m_size; }
+};
+
+// Read-only memory-mapped columns.
+class ColumnStore {
+  struct Mapping {
+    void *data;
+    size_t size;
+  };
+  std::vector<Mapping> m_mappings;
+  std::vector<std::string> m_players;
+  size_t m_games_num = 0;
+  size_t m_moves_num = 0;
+  const char *m_error = nullptr;
+
+public:
+  struct GameColumns {
+    ColumnView<uint64_t> game_id;
+    ColumnView<uint64_t> layout_id;
+    ColumnView<uint16_t> rows;
+    ColumnView<uint16_t> cols;
+    ColumnView<uint16_t> x_player;
+    ColumnView<uint16_t> o_player;
+    ColumnView<uint8_t> winner;
+    ColumnView<uint8_t> result;
+    ColumnView<uint16_t> n_moves;
+  } games;
+
+  struct MoveColumns {
+    ColumnView<uint64_t> game_id;
+    ColumnView<uint16_t> move_no;
+    ColumnView<uint16_t> player;
+    ColumnView<uint8_t> sign;
+    ColumnView<uint8_t> outcome;
+    ColumnView<uint16_t> x;
+    ColumnView<uint16_t> y;
+    ColumnView<uint32_t> think_us;
+  } moves;
+
+  ColumnStore() = default;
+  ColumnStore(const ColumnStore &) = delete;
+  ColumnStore &operator=(const ColumnStore &) = delete;
+  ~ColumnStore();
+
+  bool open(const char *dir);
+  void close();
+  const char *get_error() const { return m_error; }
+
+  size_t get_games_num() const { return m_games_num; }
+  size_t get_moves_num() const { return m_moves_num; }
+  const std::vector<std::string> &get_players() const { return m_players; }
+  int find_player(const std::string &name) const;
+
+private:
+  template <class T>
+  bool _map(const std::string &dir, const char *name, ColumnView<T> &view);
+};
+
+}; // namespace ttt::stats
@@ -0,0 +1,117 @@
+#include "recorder.hpp"
+
+#include <chrono>
+
+namespace ttt::stats {
+
+using game::EventType;
+using game::MoveResult;
+
+uint64_t get_layout_id(const State &state) {
+  // FNV-1a over field size and wall cells
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ull;
+  };
+  const auto &opts = state.get_opts();
+  mix(opts.rows);
+  mix(opts.cols);
+  for (int y = 0; y < opts.rows; ++y)
+    for (int x = 0; x < opts.cols; ++x)
+      if (state.get_value(x, y) == Sign::WALL)
+        mix(uint64_t(y) * opts.cols + x);
+  return hash;
+}
+
+void StatsRecorder::set_think_time(Sign sign, uint32_t think_us) {
+  if (sign == Sign::X || sign == Sign::O)
+    m_think_us[sign == Sign::X ? 0 : 1] = think_us;
+}
+
+void StatsRecorder::handle_event(const State &state, const Event &event) {
+  switch (event.type) {
+  case EventType::PLAYER_JOINED: {
+    const int i = event.data.player_joined.player_sign == Sign::X ? 0 : 1;
+    m_players[i] = m_writer.get_player_id(
+        game::get_name(event.data.player_joined.player_name_id));
+    return;
+  }
+  case EventType::GAME_STARTED:
+    m_layout_id = get_layout_id(state);
+    m_opts = state.get_opts();
+    m_moves.clear();
+    m_think_us[0] = m_think_us[1] = 0;
+    m_in_game = true;
+    return;
+  case EventType::MOVE: {
+    const Sign sign = event.data.move.player;
+    const int i = sign == Sign::X ? 0 : 1;
+    MoveRecord mv{};
+    mv.game_id = m_next_id;
+    mv.move_no = m_moves.size();
+    mv.player = m_players[i];
+    mv.sign = uint8_t(sign);
+    mv.x = event.data.move.x;
+    mv.y = event.data.move.y;
+    mv.think_us = m_think_us[i];
+    m_think_us[i] = 0;
+    m_moves.push_back(mv);
+    return;
+  }
+  case EventType::WIN:
+    _finish_game(MoveResult::WIN, event.data.win.player);
+    return;
+  case EventType::DRAW:
+    _finish_game(MoveResult::DRAW, Sign::NONE);
+    return;
+  case EventType::DQ:
+    _finish_game(event.data.dq.reason,
+                 event.data.dq.player == Sign::X ? Sign::O : Sign::X);
+    return;
+  default:
+    return;
+  }
+}
+
+void StatsRecorder::_finish_game(MoveResult result, Sign winner) {
+  if (!m_in_game)
+    return;
+  m_in_game = false;
+  for (auto &mv : m_moves) {
+    if (winner == Sign::NONE)
+      mv.outcome = uint8_t(Outcome::DRAW);
+    else if (Sign(mv.sign) == winner)
+      mv.outcome = uint8_t(Outcome::WIN);
+    else
+      mv.outcome = uint8_t(Outcome::LOSS);
+  }
+  GameRecord game{};
+  game.game_id = m_next_id++;
+  game.layout_id = m_layout_id;
+  game.rows = m_opts.rows;
+  game.cols = m_opts.cols;
+  game.x_player = m_players[0];
+  game.o_player = m_players[1];
+  game.winner = uint8_t(winner);
+  game.result = uint8_t(result);
+  game.n_moves = m_moves.size();
+  m_writer.append_game(game, m_moves.data(), m_moves.size());
+}
+
+void ThinkTimer::set_sign(Sign sign) {
+  m_sign = sign;
+  m_base.set_sign(sign);
+}
+
+Point ThinkTimer::make_move(const State &state) {
+  auto start = std::chrono::steady_clock::now();
+  Point result = m_base.make_move(state);
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  m_recorder.set_think_time(m_sign, us);
+  return result;
+}
+
+}; // namespace ttt::stats
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "column_store.hpp"
+#include "core/game.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ttt::stats {
+
+using game::Event;
+using game::IObserver;
+using game::IPlayer;
+using game::Point;
+using game::Sign;
+using game::State;
+
+uint64_t get_layout_id(const State &state);
+
+// Observer which appends every finished game to the column store.
+class StatsRecorder : public IObserver {
+  ColumnWriter &m_writer;
+  uint64_t m_next_id;
+  uint16_t m_players[2] = {0, 0};
+  uint32_t m_think_us[2] = {0, 0};
+  uint64_t m_layout_id = 0;
+  State::Opts m_opts = {0, 0, 0, 0};
+  std::vector<MoveRecord> m_moves;
+  bool m_in_game = false;
+
+public:
+  // Numbers the games after those already in the store.
+  explicit StatsRecorder(ColumnWriter &writer)
+      : m_writer(writer), m_next_id(writer.get_next_game_id()) {}
+  StatsRecorder(ColumnWriter &writer, uint64_t first_game_id)
+      : m_writer(writer), m_next_id(first_game_id) {}
+
+  // Think time of the next move of the player, reported by ThinkTimer.
+  void set_think_time(Sign sign, uint32_t think_us);
+  void handle_event(const State &state, const Event &event) override;
+
+private:
+  void _finish_game(game::MoveResult result, Sign winner);
+};
+
+// Player wrapper which measures the wall time of every move for the recorder.
+class ThinkTimer : public IPlayer {
+  IPlayer &m_base;
+  StatsRecorder &m_recorder;
+  Sign m_sign = Sign::NONE;
+
+public:
+  ThinkTimer(IPlayer &base, StatsRecorder &recorder)
+      : m_base(base), m_recorder(recorder) {}
+
+  void set_sign(Sign sign) override;
+  Point make_move(const State &state) override;
+  const char *get_name() const override { return m_base.get_name(); }
+  void handle_event(const State &state, const Event &event) override {
+    m_base.handle_event(state, event);
+  }
+};
+
+}; // namespace ttt::stats
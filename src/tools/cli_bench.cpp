@@ -0,0 +1,193 @@
+#include "core/state.hpp"
+#include "engine/board.hpp"
+#include "engine/parallel_search.hpp"
+#include "engine/transposition_table.hpp"
+#include "player/my_player.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ttt::game::State;
+
+struct BenchOpts {
+  int size;
+  int win_len;
+  int n_positions;
+  int n_moves;
+  int time_ms;
+  int depth;
+  size_t hash_mb;
+};
+
+// Positions after a few random moves around the first stone in the centre.
+static std::vector<State> make_positions(const BenchOpts &opts) {
+  State::Opts state_opts;
+  state_opts.rows = state_opts.cols = opts.size;
+  state_opts.win_len = opts.win_len;
+  state_opts.max_moves = 0;
+  ttt::my_player::MyPlayer random_player("random");
+  std::vector<State> positions;
+  while (int(positions.size()) < opts.n_positions) {
+    State state(state_opts);
+    state.process_move(state.get_current_player(), opts.size / 2,
+                       opts.size / 2);
+    for (int i = 1; i < opts.n_moves; ++i) {
+      const auto pt = random_player.make_move(state);
+      state.process_move(state.get_current_player(), pt.x, pt.y);
+    }
+    if (state.get_status() == ttt::game::Status::ACTIVE)
+      positions.push_back(state);
+  }
+  return positions;
+}
+
+struct BenchResult {
+  int64_t nodes = 0;
+  double time_ms = 0;
+  int depth_sum = 0;
+  ttt::engine::PageMode pages = ttt::engine::PageMode::NORMAL;
+};
+
+static BenchResult run_bench(const std::vector<State> &positions,
+                             const BenchOpts &opts, int n_threads) {
+  ttt::engine::TranspositionTable tt(opts.hash_mb);
+  ttt::engine::ParallelSearch search(n_threads);
+  search.set_table(&tt);
+  ttt::engine::SearchLimits limits;
+  limits.time_ms = opts.depth > 0 ? 0 : opts.time_ms;
+  limits.depth = opts.depth;
+  BenchResult bench;
+  bench.pages = tt.get_page_mode();
+  for (const auto &state : positions) {
+    // every position starts with an empty table to compare thread counts
+    tt.clear();
+    const ttt::engine::Board board(state);
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = search.run(board, limits);
+    bench.time_ms += std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    bench.nodes += result.nodes;
+    bench.depth_sum += result.depth;
+  }
+  return bench;
+}
+
+static std::vector<int> parse_threads(const char *arg) {
+  std::vector<int> threads;
+  if (arg == nullptr || *arg == 0) {
+    const int n_cores = std::max(1u, std::thread::hardware_concurrency());
+    for (int n = 1; n < n_cores; n *= 2)
+      threads.push_back(n);
+    threads.push_back(n_cores);
+    return threads;
+  }
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    threads.push_back(std::max(1, std::stoi(item)));
+  return threads;
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"threads", 'j', 1,
+       "comma separated thread counts, powers of two up to all cores by "
+       "default"},
+      {"positions", 'n', 1, "number of positions", "8"},
+      {"moves", 'm', 1, "number of random moves in every position", "12"},
+      {"size", 's', 1, "size of the field", "20"},
+      {"win", 'w', 1, "length of the winning line", "5"},
+      {"time", 't', 1, "time per position (ms)", "300"},
+      {"depth", 'd', 1,
+       "search every position to this depth instead of by time, 0 to use "
+       "time",
+       "0"},
+      {"hash", 'H', 1, "size of the transposition table (MB)", "64"},
+      {"pages", 0, 1,
+       "pages of the transposition table: normal, transparent or huge",
+       "transparent"},
+      {"seed", 0, 1, "seed of the random positions", "1"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_bench [opts]";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_bench: node rate and speedup of the parallel search.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoi(value);
+  };
+  BenchOpts opts;
+  opts.size = get_int("size");
+  opts.win_len = get_int("win");
+  opts.n_positions = get_int("positions");
+  opts.n_moves = std::max(1, get_int("moves"));
+  opts.time_ms = get_int("time");
+  opts.depth = get_int("depth");
+  opts.hash_mb = get_int("hash");
+  const char *pages = cli.get_default("pages");
+  if (const char *const *kw = args.get_keyword("pages", 0))
+    pages = *kw;
+  ttt::engine::PageMode page_policy;
+  if (!ttt::engine::parse_page_mode(pages, page_policy)) {
+    std::cerr << "error: unknown pages " << pages << ", see --help\n";
+    return 1;
+  }
+  ttt::engine::set_page_policy(page_policy);
+  std::srand(get_int("seed"));
+  const char *const *threads_kw = args.get_keyword("threads", 0);
+  const auto threads = parse_threads(threads_kw ? *threads_kw : nullptr);
+
+  const auto positions = make_positions(opts);
+  std::cout << positions.size() << " positions " << opts.size << "x"
+            << opts.size << ", win " << opts.win_len << ", "
+            << (opts.depth > 0 ? "depth " + std::to_string(opts.depth)
+                               : std::to_string(opts.time_ms) + " ms")
+            << " per position\n\n";
+  // by depth the speedup is the ratio of times, by time it is the ratio of
+  // node rates, and the reached depth shows what it gives
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "nodes"
+            << std::setw(12) << "knodes/s" << std::setw(10) << "depth"
+            << std::setw(12) << "time (ms)" << std::setw(10) << "speedup"
+            << '\n';
+  double base = 0;
+  auto page_mode = ttt::engine::PageMode::NORMAL;
+  for (int n_threads : threads) {
+    const auto bench = run_bench(positions, opts, n_threads);
+    const double nps = bench.nodes / std::max(bench.time_ms, 1.) * 1000;
+    const double value = opts.depth > 0 ? 1 / std::max(bench.time_ms, 1.) : nps;
+    if (base == 0)
+      base = value;
+    std::cout << std::setw(8) << n_threads << std::setw(14) << bench.nodes
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << nps / 1000 << std::setw(10)
+              << double(bench.depth_sum) / positions.size() << std::setw(12)
+              << std::setprecision(0) << bench.time_ms << std::setw(10)
+              << std::setprecision(2) << value / base << '\n';
+    std::cout.unsetf(std::ios::fixed);
+    page_mode = bench.pages;
+  }
+  std::cout << "\ntransposition table: " << opts.hash_mb << " MB, "
+            << ttt::engine::to_string(page_mode) << " pages\n";
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "engine/opening_book.hpp"
+#include "journal/journal.hpp"
+#include "journal/replay.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using ttt::engine::BookBuilder;
+using ttt::game::Sign;
+using ttt::game::State;
+
+// Adds the first moves of the game which stay inside the book window.
+static void add_game(const ttt::journal::GameView &game, int n_moves,
+                     BookBuilder &builder) {
+  ttt::journal::WallsInitializer initializer(game.get_walls(),
+                                             game.get_walls_num());
+  State state(game.get_opts(), &initializer);
+  const auto *moves = game.get_moves();
+  const int n = std::min(n_moves, game.get_moves_num());
+  for (int i = 0; i < n; ++i) {
+    if (state.get_status() == ttt::game::Status::ENDED)
+      return;
+    const Sign side = state.get_current_player();
+    const double result = game.get_winner() == side         ? 1
+                          : game.get_winner() == Sign::NONE ? 0.5
+                                                            : 0;
+    if (!builder.add_move(state, {moves[i].x, moves[i].y}, result))
+      return;
+    state.process_move(side, moves[i].x, moves[i].y);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"out", 'o', 1, "file of the book", "book.bin"},
+      {"moves", 'm', 1, "number of first moves of every game to add", "12"},
+      {"radius", 'r', 1,
+       "book positions have stones only at this distance from the centre",
+       "3"},
+      {"min-games", 0, 1, "moves played fewer times are left out", "2"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_book [opts] {journal...}";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_book: builds an opening book from the results of the "
+                 "games of journals,\nfor example of self-play by "
+                 "`cli_train --selfplay`. The book is used by\n`cli_client "
+                 "--book`.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoi(value);
+  };
+  if (!args.get_positional(0)) {
+    std::cerr << "error: journal is required, see --help\n";
+    return 1;
+  }
+  const int n_moves = get_int("moves");
+  const int n_threads = ttt::journal::get_threads_num(get_int("threads"));
+  std::vector<BookBuilder> builders(n_threads, BookBuilder(get_int("radius")));
+  size_t n_games = 0;
+  for (int i = 0; const char *path = args.get_positional(i); ++i) {
+    ttt::journal::Journal journal;
+    if (!journal.open(path)) {
+      std::cerr << "error: " << path << ": " << journal.get_error() << '\n';
+      return 1;
+    }
+    n_games += journal.get_games_num();
+    ttt::journal::for_each_game_parallel(
+        journal, n_threads,
+        [&](const ttt::journal::GameView &game, int thread_no) {
+          add_game(game, n_moves, builders[thread_no]);
+        });
+  }
+  for (int i = 1; i < n_threads; ++i)
+    builders[0].merge(builders[i]);
+
+  std::string out = cli.get_default("out");
+  if (const char *const *kw = args.get_keyword("out", 0))
+    out = *kw;
+  if (!builders[0].save(out.c_str(), get_int("min-games"))) {
+    std::cerr << "error: cannot write " << out << '\n';
+    return 1;
+  }
+  ttt::engine::OpeningBook book;
+  const char *error = nullptr;
+  if (!book.open(out.c_str(), &error)) {
+    std::cerr << "error: " << out << ": " << error << '\n';
+    return 1;
+  }
+  std::cerr << n_games << " games, " << builders[0].get_positions_num()
+            << " book positions, " << builders[0].get_entries_num()
+            << " moves, " << book.get_entries_num() << " saved to " << out
+            << '\n';
+  return 0;
+}
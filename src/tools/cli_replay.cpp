@@ -0,0 +1,189 @@
+#include "journal/journal.hpp"
+#include "journal/replay.hpp"
+#include "player/my_observer.hpp"
+#include "player/terminal_renderer.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using ttt::game::MoveResult;
+using ttt::game::Sign;
+using ttt::journal::GameView;
+using ttt::journal::Journal;
+using ttt::my_player::ConsoleWriter;
+
+struct ResultCounter {
+  long games = 0;
+  long x_wins = 0;
+  long o_wins = 0;
+  long draws = 0;
+
+  void add(const GameView &game) {
+    ++games;
+    if (game.get_winner() == Sign::X)
+      ++x_wins;
+    else if (game.get_winner() == Sign::O)
+      ++o_wins;
+    else
+      ++draws;
+  }
+
+  void merge(const ResultCounter &other) {
+    games += other.games;
+    x_wins += other.x_wins;
+    o_wins += other.o_wins;
+    draws += other.draws;
+  }
+};
+
+static std::ostream &operator<<(std::ostream &os, const ResultCounter &c) {
+  const double n = c.games > 0 ? c.games : 1;
+  return os << c.games << " games, X " << 100. * c.x_wins / n << "%, O "
+            << 100. * c.o_wins / n << "%, draw " << 100. * c.draws / n << "%";
+}
+
+struct Analytics {
+  ResultCounter total;
+  std::map<std::pair<int, int>, ResultCounter> by_first_move;
+  ResultCounter by_wall_density[21];
+
+  void add(const GameView &game) {
+    total.add(game);
+    if (game.get_moves_num() > 0) {
+      const auto &first = game.get_moves()[0];
+      by_first_move[{first.x, first.y}].add(game);
+    }
+    const auto opts = game.get_opts();
+    const int cells = opts.rows * opts.cols;
+    by_wall_density[cells > 0 ? game.get_walls_num() * 20 / cells : 0].add(
+        game);
+  }
+
+  void merge(const Analytics &other) {
+    total.merge(other.total);
+    for (const auto &kv : other.by_first_move)
+      by_first_move[kv.first].merge(kv.second);
+    for (int i = 0; i < 21; ++i)
+      by_wall_density[i].merge(other.by_wall_density[i]);
+  }
+};
+
+static int run_stats(const Journal &journal, int n_threads, int top) {
+  n_threads = ttt::journal::get_threads_num(n_threads);
+  std::vector<Analytics> partial(n_threads);
+  ttt::journal::for_each_game_parallel(
+      journal, n_threads,
+      [&](const GameView &game, int thread_no) {
+        partial[thread_no].add(game);
+      });
+  Analytics result;
+  for (const auto &p : partial)
+    result.merge(p);
+
+  std::cout << "total: " << result.total << "\n\n";
+  std::vector<std::pair<std::pair<int, int>, ResultCounter>> moves(
+      result.by_first_move.begin(), result.by_first_move.end());
+  std::sort(moves.begin(), moves.end(), [](const auto &a, const auto &b) {
+    return a.second.games > b.second.games;
+  });
+  std::cout << "win rates by first move:\n";
+  for (int i = 0; i < int(moves.size()) && i < top; ++i) {
+    std::cout << "  (" << moves[i].first.first << ", "
+              << moves[i].first.second << "): " << moves[i].second << '\n';
+  }
+  std::cout << "\nwin rates by wall density:\n";
+  for (int i = 0; i < 21; ++i) {
+    if (result.by_wall_density[i].games == 0)
+      continue;
+    std::cout << "  " << i * 5 << "-" << i * 5 + 4
+              << "%: " << result.by_wall_density[i] << '\n';
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"game", 'g', 1, "id of the game to show or replay"},
+      {"move", 'm', 1, "show state after this number of moves"},
+      {"play", 'P', 0, "re-emit events of the game to console writer"},
+      {"pace", 0, 1, "delay between replayed moves in milliseconds", "0"},
+      {"stats", 's', 0, "compute win rates over all games"},
+      {"top", 0, 1, "number of first moves to show in stats", "20"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_replay [opts] {journal}";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_replay: inspect and replay recorded games.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  const char *path = args.get_positional(0);
+  if (path == nullptr) {
+    std::cerr << "error: journal is required, see --help\n";
+    return 1;
+  }
+  const char *const *kw = nullptr;
+  const char *threads_arg = cli.get_default("threads");
+  if ((kw = args.get_keyword("threads", 0)))
+    threads_arg = *kw;
+  const char *pace_arg = cli.get_default("pace");
+  if ((kw = args.get_keyword("pace", 0)))
+    pace_arg = *kw;
+  const char *top_arg = cli.get_default("top");
+  if ((kw = args.get_keyword("top", 0)))
+    top_arg = *kw;
+
+  Journal journal;
+  if (!journal.open(path)) {
+    std::cerr << "cannot open journal " << path << ": " << journal.get_error()
+              << '\n';
+    return 1;
+  }
+  std::cout << "journal " << path << ": " << journal.get_games_num()
+            << " games\n";
+
+  if (args.has_flag("stats"))
+    return run_stats(journal, std::stoi(threads_arg), std::stoi(top_arg));
+
+  if (!(kw = args.get_keyword("game", 0)))
+    return 0;
+  const GameView game = journal.find_game(std::stoull(*kw));
+  if (!game.is_valid()) {
+    std::cerr << "no game with id " << *kw << '\n';
+    return 1;
+  }
+  if (args.has_flag("play")) {
+    if (isatty(STDOUT_FILENO)) {
+      std::cout << std::flush;
+      ttt::my_player::TerminalRenderer renderer;
+      ttt::journal::replay_game(game, renderer, std::stoi(pace_arg));
+      return 0;
+    }
+    ConsoleWriter writer;
+    ttt::journal::replay_game(game, writer, std::stoi(pace_arg));
+    ConsoleWriter::print_game_state(ttt::journal::rebuild_state(game));
+    return 0;
+  }
+  int move_no = -1;
+  if ((kw = args.get_keyword("move", 0)))
+    move_no = std::stoi(*kw);
+  std::cout << "X: " << game.get_name(Sign::X)
+            << ", O: " << game.get_name(Sign::O)
+            << ", moves: " << game.get_moves_num() << '\n';
+  ConsoleWriter::print_game_state(ttt::journal::rebuild_state(game, move_no));
+  return 0;
+}
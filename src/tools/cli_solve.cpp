@@ -0,0 +1,161 @@
+#include "engine/position.hpp"
+#include "engine/proof_solver.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ttt::engine::Position;
+using ttt::engine::ProofResult;
+
+struct Task {
+  Position pos;
+  const char *error = nullptr;
+  ProofResult result;
+  double time_ms = 0;
+};
+
+// Every thread solves the next unsolved position with its own table.
+static void solve_all(std::vector<Task> &tasks, int n_threads,
+                      size_t hash_mb, const ttt::engine::ProofLimits &limits) {
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    ttt::engine::ProofSolver solver(hash_mb);
+    for (size_t i = next++; i < tasks.size(); i = next++) {
+      Task &task = tasks[i];
+      const auto state = ttt::engine::make_state(task.pos, &task.error);
+      if (!state)
+        continue;
+      const auto start = std::chrono::steady_clock::now();
+      task.result = solver.solve(*state, limits);
+      task.time_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"hash", 'H', 1, "size of the table of every thread (MB)", "64"},
+      {"time", 't', 1, "time limit per position (ms), 0 for no limit", "0"},
+      {"nodes", 'n', 1, "node limit per position, 0 for no limit", "0"},
+      {"annotate", 'a', 0,
+       "print the positions with `value` and `best` tags instead of a table"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_solve [opts] [positions file]";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_solve: exact values of positions by proof-number "
+                 "search.\nPositions are read from the file or from stdin, "
+                 "see engine/position.hpp\nfor the format.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoi(value);
+  };
+  int n_threads = get_int("threads");
+  if (n_threads <= 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  ttt::engine::ProofLimits limits;
+  limits.time_ms = get_int("time");
+  limits.nodes = get_int("nodes");
+
+  std::ifstream file;
+  const char *path = args.get_positional(0);
+  if (path) {
+    file.open(path);
+    if (!file) {
+      std::cerr << "error: cannot open " << path << '\n';
+      return 1;
+    }
+  }
+  std::istream &in = path ? file : std::cin;
+  std::vector<Task> tasks;
+  Task task;
+  while (ttt::engine::read_position(in, task.pos, &task.error))
+    tasks.push_back(task);
+  if (task.error) {
+    std::cerr << "error: position " << tasks.size() + 1 << ": " << task.error
+              << '\n';
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  solve_all(tasks, n_threads, get_int("hash"), limits);
+  const double total_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+  int counts[4] = {0, 0, 0, 0};
+  int64_t nodes = 0;
+  if (!args.has_flag("annotate"))
+    std::cout << std::setw(6) << "#" << std::setw(6) << "side"
+              << std::setw(9) << "value" << std::setw(10) << "move"
+              << std::setw(12) << "nodes" << std::setw(12) << "time (ms)"
+              << '\n';
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const Task &t = tasks[i];
+    if (t.error) {
+      std::cerr << "position " << i + 1 << ": " << t.error << '\n';
+      continue;
+    }
+    const ProofResult &r = t.result;
+    ++counts[int(r.value)];
+    nodes += r.nodes;
+    if (args.has_flag("annotate")) {
+      Position pos = t.pos;
+      pos.tags.emplace_back("value", ttt::engine::to_string(r.value));
+      if (r.move.x >= 0)
+        pos.tags.emplace_back("best", std::to_string(r.move.x) + " " +
+                                          std::to_string(r.move.y));
+      ttt::engine::write_position(std::cout, pos);
+      continue;
+    }
+    int n_stones = 0;
+    for (const auto &row : t.pos.rows)
+      n_stones += std::count(row.begin(), row.end(), 'X') +
+                  std::count(row.begin(), row.end(), 'O');
+    std::string move = "-";
+    if (r.move.x >= 0)
+      move = std::to_string(r.move.x) + "," + std::to_string(r.move.y);
+    std::cout << std::setw(6) << i + 1 << std::setw(6)
+              << (n_stones % 2 ? 'O' : 'X') << std::setw(9)
+              << ttt::engine::to_string(r.value) << std::setw(10) << move
+              << std::setw(12) << r.nodes << std::setw(12) << std::fixed
+              << std::setprecision(1) << t.time_ms << '\n';
+    std::cout.unsetf(std::ios::fixed);
+  }
+  std::cerr << tasks.size() << " positions, " << n_threads << " threads: "
+            << counts[1] << " wins, " << counts[2] << " draws, " << counts[3]
+            << " losses, " << counts[0] << " unknown; " << nodes
+            << " nodes in " << std::fixed << std::setprecision(0) << total_ms
+            << " ms\n";
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include "journal/journal.hpp"
+#include "journal/replay.hpp"
+#include "remote/cli_utils.hpp"
+#include "stats/aggregator.hpp"
+#include "stats/column_store.hpp"
+#include "stats/recorder.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using ttt::stats::ColumnStore;
+using ttt::stats::Query;
+
+static int import_journal(const char *dir, const char *journal_path) {
+  ttt::journal::Journal journal;
+  if (!journal.open(journal_path)) {
+    std::cerr << "cannot open journal " << journal_path << ": "
+              << journal.get_error() << '\n';
+    return 1;
+  }
+  ttt::stats::ColumnWriter writer(dir);
+  if (!writer.is_open()) {
+    std::cerr << "cannot open store " << dir << '\n';
+    return 1;
+  }
+  for (size_t i = 0; i < journal.get_games_num(); ++i) {
+    const auto game = journal.get_game(i);
+    ttt::stats::StatsRecorder recorder(writer, game.get_id());
+    ttt::journal::replay_game(game, recorder);
+  }
+  std::cout << "imported " << journal.get_games_num() << " games\n";
+  return 0;
+}
+
+static void print_heatmap(const ttt::stats::Heatmap &heatmap) {
+  long max_moves = 1;
+  for (long m : heatmap.moves)
+    max_moves = std::max(max_moves, m);
+  std::cout << "move heatmap of " << heatmap.rows << 'x' << heatmap.cols
+            << " fields (per mille of the busiest cell) and win rate (%)"
+            << ":\n";
+  for (int y = 0; y < heatmap.rows; ++y) {
+    std::cout << std::setw(3) << y << " |";
+    for (int x = 0; x < heatmap.cols; ++x)
+      std::cout << std::setw(4) << heatmap.get_moves(x, y) * 999 / max_moves;
+    std::cout << "   |";
+    for (int x = 0; x < heatmap.cols; ++x) {
+      const long m = heatmap.get_moves(x, y);
+      if (m == 0)
+        std::cout << "   .";
+      else
+        std::cout << std::setw(4) << heatmap.get_wins(x, y) * 100 / m;
+    }
+    std::cout << '\n';
+  }
+  std::cout << '\n';
+}
+
+static void print_heatmaps(const ColumnStore &store, const Query &query) {
+  for (const auto &heatmap : ttt::stats::compute_heatmaps(store, query))
+    print_heatmap(heatmap);
+}
+
+static void print_move_numbers(const ColumnStore &store, const Query &query) {
+  const auto stats = ttt::stats::compute_move_number_stats(store, query);
+  std::cout << "win rate of the moving player by move number:\n";
+  for (size_t i = 0; i < stats.moves.size(); ++i) {
+    if (stats.moves[i] == 0)
+      continue;
+    const double n = stats.moves[i];
+    std::cout << std::setw(5) << i << ": " << std::setw(9) << stats.moves[i]
+              << " moves, win " << std::fixed << std::setprecision(1)
+              << 100. * stats.wins[i] / n << "%, draw "
+              << 100. * stats.draws[i] / n << "%\n";
+  }
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << '\n';
+}
+
+static void print_latency(const ColumnStore &store, const Query &query) {
+  const auto hist = ttt::stats::compute_latency(store, query);
+  std::cout << "think time over " << hist.get_count() << " moves (us):\n";
+  for (double p : {50., 90., 99., 99.9, 100.})
+    std::cout << "  p" << p << ": " << hist.percentile(p) << '\n';
+  std::cout << '\n';
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"import", 'i', 1, "append games from a journal to the store"},
+      {"player", 'p', 1, "only count moves of this player"},
+      {"sign", 0, 1, "only count moves of this sign (X or O)"},
+      {"heatmap", 'H', 0, "print heatmap of moves"},
+      {"by-move", 'm', 0, "print win rates by move number"},
+      {"latency", 'l', 0, "print think time percentiles"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_stats [opts] {store_dir}";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_stats: query columnar game statistics.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  const char *dir = args.get_positional(0);
+  if (dir == nullptr) {
+    std::cerr << "error: store directory is required, see --help\n";
+    return 1;
+  }
+  const char *const *kw = nullptr;
+  if ((kw = args.get_keyword("import", 0)))
+    return import_journal(dir, *kw);
+
+  ColumnStore store;
+  if (!store.open(dir)) {
+    std::cerr << "cannot open store " << dir << ": " << store.get_error()
+              << '\n';
+    return 1;
+  }
+  Query query;
+  const char *threads_arg = cli.get_default("threads");
+  if ((kw = args.get_keyword("threads", 0)))
+    threads_arg = *kw;
+  query.n_threads = std::stoi(threads_arg);
+  if ((kw = args.get_keyword("player", 0))) {
+    query.player = store.find_player(*kw);
+    if (query.player < 0) {
+      std::cerr << "unknown player: " << *kw << '\n';
+      return 1;
+    }
+  }
+  if ((kw = args.get_keyword("sign", 0))) {
+    const std::string sign = *kw;
+    query.sign = int(sign == "X"   ? ttt::game::Sign::X
+                     : sign == "O" ? ttt::game::Sign::O
+                                   : ttt::game::Sign::NONE);
+  }
+  std::cout << "store " << dir << ": " << store.get_games_num() << " games, "
+            << store.get_moves_num() << " moves, "
+            << store.get_players().size() << " players\n\n";
+
+  auto start = std::chrono::steady_clock::now();
+  if (args.has_flag("heatmap"))
+    print_heatmaps(store, query);
+  if (args.has_flag("by-move"))
+    print_move_numbers(store, query);
+  if (args.has_flag("latency"))
+    print_latency(store, query);
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  std::cout << "queries took " << ms << " ms\n";
+  return 0;
+}
@@ -0,0 +1,227 @@
+#include "engine/suite.hpp"
+#include "player/mcts_player.hpp"
+#include "player/my_player.hpp"
+#include "player/search_player.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ttt::engine::SuiteEntry;
+using ttt::game::Point;
+
+struct Budget {
+  const char *engine;
+  int time_ms;
+  int64_t nodes;
+  size_t hash_mb;
+};
+
+struct Task {
+  const SuiteEntry *entry;
+  Point move = {-1, -1};
+  bool solved = false;
+  // time of the move and the time from which its search kept a solution
+  double time_ms = 0;
+  double solution_ms = 0;
+  int depth = 0;
+};
+
+// Time from which the best moves of all later iterations of the search of
+// the move solve the position, the whole time without iterations.
+static double get_solution_time(const SuiteEntry &entry,
+                                const ttt::engine::SearchResult &result,
+                                double time_ms) {
+  const auto &its = result.stats.iterations;
+  int first = its.size();
+  while (first > 0 && entry.is_solved_by(its[first - 1].move))
+    --first;
+  return first < int(its.size()) ? its[first].time_ms : time_ms;
+}
+
+// Every thread plays the next position with its own player, the tables of
+// the player are cleared for every position, so with a node budget the
+// results do not depend on the number of threads.
+static void run_all(std::vector<Task> &tasks, int n_threads,
+                    const Budget &budget) {
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    std::unique_ptr<ttt::my_player::SearchPlayer> search;
+    std::unique_ptr<ttt::game::IPlayer> player;
+    if (std::strcmp(budget.engine, "search") == 0) {
+      search = std::make_unique<ttt::my_player::SearchPlayer>(
+          "search", budget.time_ms, budget.hash_mb);
+      search->set_node_limit(budget.nodes);
+    } else if (std::strcmp(budget.engine, "mcts") == 0) {
+      player =
+          std::make_unique<ttt::my_player::MctsPlayer>("mcts", budget.time_ms);
+    } else {
+      player = std::make_unique<ttt::my_player::MyPlayer>("my");
+    }
+    ttt::game::IPlayer &p = search ? *search : *player;
+    for (size_t i = next++; i < tasks.size(); i = next++) {
+      Task &task = tasks[i];
+      const ttt::game::State &state = *task.entry->state;
+      if (search)
+        search->get_table().clear();
+      p.set_sign(state.get_current_player());
+      const auto start = std::chrono::steady_clock::now();
+      task.move = p.make_move(state);
+      task.time_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+      task.solved = task.entry->is_solved_by(task.move);
+      task.solution_ms = task.time_ms;
+      if (search) {
+        const auto &result = search->get_last_result();
+        task.depth = result.depth;
+        if (task.solved)
+          task.solution_ms =
+              get_solution_time(*task.entry, result, task.time_ms);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < n_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+static std::string to_string(Point pt) {
+  return std::to_string(pt.x) + "," + std::to_string(pt.y);
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"engine", 'e', 1, "player to test: search, mcts or my", "search"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"time", 't', 1, "time limit per move (ms)", "1000"},
+      {"nodes", 'n', 1,
+       "node limit per move of the search player instead of the time, 0 "
+       "for the time",
+       "0"},
+      {"hash", 'H', 1, "size of the table of every thread (MB)", "16"},
+      {"min-rate", 0, 1,
+       "exit with an error if less than this percent of the positions is "
+       "solved",
+       "0"},
+      {"verbose", 'v', 0, "print every position, not only the failed ones"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_suite [opts] {suite file}...";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_suite: solve rate of a player on test suites of "
+                 "positions with the expected\nbest moves, see "
+                 "engine/suite.hpp for the format.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoll(value);
+  };
+  Budget budget;
+  budget.engine = cli.get_default("engine");
+  if (const char *const *kw = args.get_keyword("engine", 0))
+    budget.engine = *kw;
+  if (std::strcmp(budget.engine, "search") != 0 &&
+      std::strcmp(budget.engine, "mcts") != 0 &&
+      std::strcmp(budget.engine, "my") != 0) {
+    std::cerr << "error: unknown engine " << budget.engine
+              << ", see --help\n";
+    return 1;
+  }
+  budget.time_ms = get_int("time");
+  budget.nodes = get_int("nodes");
+  budget.hash_mb = get_int("hash");
+  int n_threads = get_int("threads");
+  if (n_threads <= 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  if (args.get_positional(0) == nullptr) {
+    std::cerr << "error: suite file is required, see --help\n";
+    return 1;
+  }
+
+  // entries keep their states, so the suites are never reallocated
+  std::vector<std::unique_ptr<std::vector<SuiteEntry>>> suites;
+  std::vector<Task> tasks;
+  for (int i = 0; const char *path = args.get_positional(i); ++i) {
+    std::ifstream file(path);
+    if (!file) {
+      std::cerr << "error: cannot open " << path << '\n';
+      return 1;
+    }
+    suites.push_back(std::make_unique<std::vector<SuiteEntry>>());
+    auto &suite = *suites.back();
+    const char *error = nullptr;
+    if (!ttt::engine::read_suite(file, suite, &error)) {
+      std::cerr << "error: " << path << ": position " << suite.size() + 1
+                << ": " << error << '\n';
+      return 1;
+    }
+    for (const auto &entry : suite)
+      tasks.push_back({&entry});
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  run_all(tasks, n_threads, budget);
+  const double total_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+  int n_solved = 0;
+  double solution_ms = 0;
+  std::cout << std::setw(6) << "#" << std::setw(8) << "result"
+            << std::setw(10) << "move" << std::setw(7) << "depth"
+            << std::setw(12) << "time (ms)" << "  " << std::left
+            << std::setw(20) << "expected" << std::right << "  name\n";
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    const Task &t = tasks[i];
+    if (t.solved) {
+      ++n_solved;
+      solution_ms += t.solution_ms;
+    }
+    if (t.solved && !args.has_flag("verbose"))
+      continue;
+    std::string expected;
+    for (const auto &pt : t.entry->best)
+      expected += (expected.empty() ? "" : " ") + to_string(pt);
+    std::cout << std::setw(6) << i + 1 << std::setw(8)
+              << (t.solved ? "ok" : "FAIL") << std::setw(10)
+              << to_string(t.move) << std::setw(7) << t.depth
+              << std::setw(12) << std::fixed << std::setprecision(1)
+              << (t.solved ? t.solution_ms : t.time_ms) << "  " << std::left
+              << std::setw(20) << expected << std::right << "  "
+              << t.entry->get_name() << '\n';
+    std::cout.unsetf(std::ios::fixed);
+  }
+  const double rate = tasks.empty() ? 0 : 100.0 * n_solved / tasks.size();
+  std::cout << "solved " << n_solved << '/' << tasks.size() << " ("
+            << std::fixed << std::setprecision(1) << rate
+            << "%), average time to solution "
+            << (n_solved ? solution_ms / n_solved : 0) << " ms; "
+            << n_threads << " threads, " << std::setprecision(0) << total_ms
+            << " ms in total\n";
+  return rate < get_int("min-rate") ? 1 : 0;
+}
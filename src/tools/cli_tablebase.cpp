@@ -0,0 +1,166 @@
+#include "engine/position.hpp"
+#include "engine/tablebase.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using ttt::engine::Position;
+using ttt::engine::Tablebase;
+using ttt::engine::TablebaseBuilder;
+using ttt::game::State;
+
+static int generate(const char *path, const State &state, int n_threads) {
+  TablebaseBuilder builder;
+  const char *error = nullptr;
+  if (!builder.init(state, &error)) {
+    std::cerr << "error: " << error << '\n';
+    return 1;
+  }
+  const auto &index = builder.get_index();
+  std::cout << index.get_rows() << "x" << index.get_cols() << ", win "
+            << index.get_win_len() << ", " << index.get_cells_num()
+            << " playable cells, " << index.get_max_moves() << " moves: "
+            << index.get_entries_num() << " positions, "
+            << (index.get_entries_num() + 3) / 4 << " bytes\n";
+  const auto start = std::chrono::steady_clock::now();
+  builder.generate(n_threads);
+  const double time_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  if (!builder.save(path)) {
+    std::cerr << "error: cannot write " << path << '\n';
+    return 1;
+  }
+  std::cout << "solved in " << std::fixed << std::setprecision(0) << time_ms
+            << " ms on " << n_threads << " threads, empty field: "
+            << ttt::engine::to_string(builder.get_value(0)) << '\n';
+  return 0;
+}
+
+// Prints the positions with `value` and `best` tags, as `cli_solve -a`.
+static int probe(const char *path, std::istream &in) {
+  Tablebase tb;
+  const char *error = nullptr;
+  if (!tb.open(path, &error)) {
+    std::cerr << "error: " << path << ": " << error << '\n';
+    return 1;
+  }
+  Position pos;
+  for (int i = 1; ttt::engine::read_position(in, pos, &error); ++i) {
+    const auto state = ttt::engine::make_state(pos, &error);
+    if (!state) {
+      std::cerr << "position " << i << ": " << error << '\n';
+      error = nullptr;
+      continue;
+    }
+    const ttt::engine::Board board(*state);
+    if (!tb.fits(board)) {
+      std::cerr << "position " << i << ": field of another tablebase\n";
+      continue;
+    }
+    pos.tags.emplace_back("value", ttt::engine::to_string(tb.probe(board)));
+    ttt::game::Point move;
+    if (tb.find_move(board, move))
+      pos.tags.emplace_back("best", std::to_string(move.x) + " " +
+                                        std::to_string(move.y));
+    ttt::engine::write_position(std::cout, pos);
+  }
+  if (error) {
+    std::cerr << "error: " << error << '\n';
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"rows", 'r', 1, "rows of the field", "4"},
+      {"cols", 'c', 1, "columns of the field", "4"},
+      {"win", 'w', 1, "length of the winning line", "3"},
+      {"max-moves", 'm', 1, "limit of moves, 0 for the whole field", "0"},
+      {"field", 'f', 1,
+       "position file whose first position gives the field and its walls "
+       "instead of the options above"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"probe", 'p', 1,
+       "print the values of the positions of the file, - for stdin, instead "
+       "of generating"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_tablebase [opts] {tablebase file}";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_tablebase: solves every position of a small field by "
+                 "retrograde analysis.\nFields have at most "
+              << ttt::engine::TB_MAX_CELLS
+              << " playable cells, see engine/position.hpp for the format "
+                 "of\npositions.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  const char *path = args.get_positional(0);
+  if (!path) {
+    std::cerr << "error: tablebase file is required, see --help\n";
+    return 1;
+  }
+  if (const char *const *kw = args.get_keyword("probe", 0)) {
+    if (std::string(*kw) == "-")
+      return probe(path, std::cin);
+    std::ifstream file(*kw);
+    if (!file) {
+      std::cerr << "error: cannot open " << *kw << '\n';
+      return 1;
+    }
+    return probe(path, file);
+  }
+
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoi(value);
+  };
+  int n_threads = get_int("threads");
+  if (n_threads <= 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  Position pos;
+  const char *error = nullptr;
+  if (const char *const *kw = args.get_keyword("field", 0)) {
+    std::ifstream file(*kw);
+    if (!ttt::engine::read_position(file, pos, &error)) {
+      std::cerr << "error: " << *kw << ": "
+                << (error ? error : "no position") << '\n';
+      return 1;
+    }
+    // only the field and the walls are used
+    for (auto &row : pos.rows)
+      for (char &c : row)
+        if (c != '#')
+          c = '.';
+  } else {
+    pos.opts.rows = get_int("rows");
+    pos.opts.cols = get_int("cols");
+    pos.opts.win_len = get_int("win");
+    pos.opts.max_moves = get_int("max-moves");
+    pos.rows.assign(pos.opts.rows, std::string(pos.opts.cols, '.'));
+  }
+  const auto state = ttt::engine::make_state(pos, &error);
+  if (!state) {
+    std::cerr << "error: " << error << '\n';
+    return 1;
+  }
+  return generate(path, *state, n_threads);
+}
@@ -0,0 +1,222 @@
+#include "core/game.hpp"
+#include "engine/board.hpp"
+#include "engine/nnue.hpp"
+#include "engine/nnue_train.hpp"
+#include "journal/journal.hpp"
+#include "journal/replay.hpp"
+#include "player/my_player.hpp"
+#include "player/search_player.hpp"
+#include "remote/cli_utils.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using ttt::engine::Board;
+using ttt::game::Sign;
+using ttt::game::State;
+
+// Plays random moves at the start of the game and then the moves of the
+// engine, so the games of deterministic engines differ.
+class OpeningPlayer : public ttt::game::IPlayer {
+  ttt::game::IPlayer &m_engine;
+  ttt::my_player::MyPlayer m_random;
+  int m_random_moves;
+
+public:
+  OpeningPlayer(ttt::game::IPlayer &engine, int random_moves)
+      : m_engine(engine), m_random("random"), m_random_moves(random_moves) {}
+
+  void set_sign(Sign sign) override {
+    m_engine.set_sign(sign);
+    m_random.set_sign(sign);
+  }
+  ttt::game::Point make_move(const State &state) override {
+    if (state.get_move_no() < m_random_moves)
+      return m_random.make_move(state);
+    return m_engine.make_move(state);
+  }
+  const char *get_name() const override { return m_engine.get_name(); }
+  void handle_event(const State &state,
+                    const ttt::game::Event &event) override {
+    m_engine.handle_event(state, event);
+  }
+};
+
+static bool play_games(const char *path, int n_games, const State::Opts &opts,
+                       float playable, int time_ms, int random_moves,
+                       std::shared_ptr<const ttt::engine::Network> net) {
+  ttt::journal::JournalWriter writer(path);
+  if (!writer.is_open())
+    return false;
+  ttt::my_player::SearchPlayer x_engine("search_x", time_ms, 16);
+  ttt::my_player::SearchPlayer o_engine("search_o", time_ms, 16);
+  x_engine.set_network(net);
+  o_engine.set_network(net);
+  OpeningPlayer x_player(x_engine, random_moves);
+  OpeningPlayer o_player(o_engine, random_moves);
+  ttt::game::RandomObstaclesFI initializer(playable, 3, 1);
+  ttt::game::Game game(opts, &initializer);
+  game.add_player(Sign::X, &x_player);
+  game.add_player(Sign::O, &o_player);
+  game.add_observer(&writer);
+  for (int i = 0; i < n_games; ++i) {
+    while (game.process() == ttt::game::MoveResult::OK)
+      ;
+    game.reset();
+    std::cerr << "\rself-play: " << i + 1 << " / " << n_games << std::flush;
+  }
+  std::cerr << '\n';
+  game.remove_observer(&writer);
+  return true;
+}
+
+// Positions of every game after each move until the game is decided, the
+// target mixes the result of the game with the evaluation by line windows.
+static void add_games(const ttt::journal::Journal &journal,
+                      ttt::engine::NetworkTrainer &trainer, double lambda,
+                      int &n_games, int &n_skipped) {
+  for (size_t i = 0; i < journal.get_games_num(); ++i) {
+    const auto game = journal.get_game(i);
+    const State start = ttt::journal::rebuild_state(game, 0);
+    Board board(start);
+    if (!trainer.fits(board)) {
+      ++n_skipped;
+      continue;
+    }
+    ++n_games;
+    const double result = game.get_winner() == Sign::X   ? 1
+                          : game.get_winner() == Sign::O ? 0
+                                                         : 0.5;
+    const auto *moves = game.get_moves();
+    for (int k = 0; k < game.get_moves_num(); ++k) {
+      // a disqualifying move ends the game
+      if (moves[k].x >= board.get_cols() || moves[k].y >= board.get_rows())
+        break;
+      const int cell = board.index(moves[k].x, moves[k].y);
+      if (board.is_over() || !board.is_empty(cell))
+        break;
+      board.make(cell);
+      if (board.is_over() || board.is_last_move())
+        continue;
+      const double eval =
+          1 / (1 + std::exp(-double(board.get_window_eval()) /
+                            ttt::engine::NNUE_EVAL_SCALE));
+      trainer.add_position(board, lambda * result + (1 - lambda) * eval);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"out", 'o', 1, "file of the trained weights", "nnue.bin"},
+      {"hidden", 0, 1, "size of the hidden layer, rounded up to 16", "32"},
+      {"epochs", 'e', 1, "number of passes over the positions", "10"},
+      {"lr", 0, 1, "learning rate", "0.01"},
+      {"lambda", 0, 1,
+       "weight of the game result in the target, the rest is the "
+       "evaluation by line windows",
+       "0.7"},
+      {"validation", 0, 1, "part of the positions left for validation",
+       "0.1"},
+      {"seed", 0, 1, "seed of the initial weights and of the shuffles", "1"},
+      {"selfplay", 's', 1,
+       "play this many games of the search player into the journal first",
+       "0"},
+      {"size", 0, 1, "field size of the self-play games", "15"},
+      {"win", 0, 1, "line length of the self-play games", "5"},
+      {"playable", 0, 1, "part of the field without walls in self-play",
+       "0.8"},
+      {"time", 't', 1, "time per move in self-play (ms)", "50"},
+      {"random-moves", 0, 1, "random moves at the start of self-play games",
+       "4"},
+      {"nnue", 0, 1, "network of the players in self-play"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: cli_train [opts] {journal}";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "cli_train: trains weights of the neural evaluator on the "
+                 "games of a journal.\nOnly games with the field of the "
+                 "first one are used. The weights are for\n`cli_client "
+                 "--nnue`.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  const char *path = args.get_positional(0);
+  if (path == nullptr) {
+    std::cerr << "error: journal is required, see --help\n";
+    return 1;
+  }
+  auto get = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return value;
+  };
+
+  if (const int n_games = std::stoi(get("selfplay")); n_games > 0) {
+    State::Opts opts;
+    opts.rows = opts.cols = std::stoi(get("size"));
+    opts.win_len = std::stoi(get("win"));
+    opts.max_moves = 0;
+    std::shared_ptr<ttt::engine::Network> net;
+    if (const char *const *kw = args.get_keyword("nnue", 0)) {
+      net = std::make_shared<ttt::engine::Network>();
+      const char *error = nullptr;
+      if (!net->open(*kw, &error)) {
+        std::cerr << "error: " << *kw << ": " << error << '\n';
+        return 1;
+      }
+    }
+    if (!play_games(path, n_games, opts, std::stof(get("playable")),
+                    std::stoi(get("time")), std::stoi(get("random-moves")),
+                    net)) {
+      std::cerr << "error: cannot write " << path << '\n';
+      return 1;
+    }
+  }
+
+  ttt::journal::Journal journal;
+  if (!journal.open(path)) {
+    std::cerr << "error: " << path << ": " << journal.get_error() << '\n';
+    return 1;
+  }
+  if (journal.get_games_num() == 0) {
+    std::cerr << "error: no games in " << path << '\n';
+    return 1;
+  }
+  const auto opts = journal.get_game(0).get_opts();
+  ttt::engine::NetworkTrainer trainer(opts.rows, opts.cols, opts.win_len,
+                                      std::stoi(get("hidden")),
+                                      std::stoull(get("seed")));
+  int n_games = 0;
+  int n_skipped = 0;
+  add_games(journal, trainer, std::stod(get("lambda")), n_games, n_skipped);
+  trainer.split(std::stod(get("validation")));
+  std::cerr << opts.rows << "x" << opts.cols << " win " << opts.win_len
+            << ": " << n_games << " games (" << n_skipped
+            << " with other fields skipped), " << trainer.get_samples_num()
+            << " positions with reflections\n";
+
+  const int epochs = std::stoi(get("epochs"));
+  const float lr = std::stof(get("lr"));
+  for (int epoch = 0; epoch < epochs; ++epoch) {
+    const double loss = trainer.train_epoch(lr);
+    std::cerr << "epoch " << epoch + 1 << ": loss " << loss
+              << ", validation " << trainer.get_validation_loss() << '\n';
+  }
+  if (!trainer.save(get("out"))) {
+    std::cerr << "error: cannot write " << get("out") << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -12,7 +12,7 @@ void HumanPlayer::set_sign(Sign sign) {
 }
 
 const char* HumanPlayer::get_name() const {
-    return m_name.c_str();
+    return game::get_name(m_name);
 }
 
 
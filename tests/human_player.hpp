@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/game.hpp"
-#include <string>
 
 namespace ttt::human_player {
 
@@ -12,7 +11,8 @@ using game::State;
 
 class HumanPlayer : public IPlayer {
 public:
-    HumanPlayer(const char* name) : m_name(name), m_sign(Sign::NONE) {}
+    HumanPlayer(const char* name)
+        : m_name(game::intern_name(name)), m_sign(Sign::NONE) {}
     ~HumanPlayer() = default;
 
     //IPlayer interface
@@ -25,7 +25,7 @@ private:
     //convert sign to char
     char sign_to_char(Sign sign) const;
     
-    std::string m_name;
+    game::NameId m_name;
     Sign m_sign;
 };
 
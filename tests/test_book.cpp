@@ -0,0 +1,116 @@
+#include "engine/opening_book.hpp"
+#include "player/book_player.hpp"
+#include "player/my_player.hpp"
+#include "test_positions.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using ttt::engine::BookBuilder;
+using ttt::engine::BookMove;
+using ttt::engine::OpeningBook;
+using ttt::game::Point;
+using ttt::test::parse;
+
+// Symmetric positions share a key, walls outside the window do not count
+// and a stone outside the window leaves the book.
+static void test_keys() {
+  const auto a = parse("7 7 4\n.......\n.......\n..X....\n...O...\n"
+                       ".......\n.......\n#......\n");
+  const auto mirrored = parse("7 7 4\n.......\n.......\n....X..\n...O...\n"
+                              ".......\n.......\n......#\n");
+  const auto rotated = parse("7 7 4\n.......\n.......\n...O...\n"
+                             "...X...\n.......\n.......\n.......\n");
+  const auto other = parse("7 7 4\n.......\n.......\n..X....\n...O...\n"
+                           ".......\n.......\n.......\n");
+  const auto k = ttt::engine::make_book_key(*a, 1);
+  assert(k.valid);
+  assert(ttt::engine::make_book_key(*mirrored, 1).key == k.key);
+  assert(ttt::engine::make_book_key(*other, 1).key == k.key);
+  assert(ttt::engine::make_book_key(*rotated, 1).key != k.key);
+  // the wall is inside the wider window
+  assert(ttt::engine::make_book_key(*a, 3).key !=
+         ttt::engine::make_book_key(*other, 3).key);
+  const auto outside = parse("7 7 4\nX......\n.......\n.......\n...O...\n"
+                             ".......\n.......\n.......\n");
+  assert(!ttt::engine::make_book_key(*outside, 2).valid);
+  assert(ttt::engine::make_book_key(*outside, 3).valid);
+}
+
+static void test_book() {
+  const char *path = "test_book.bin";
+  const auto empty = parse("7 7 4\n.......\n.......\n.......\n.......\n"
+                           ".......\n.......\n.......\n");
+  const auto x_moved = parse("7 7 4\n.......\n.......\n..X....\n.......\n"
+                             ".......\n.......\n.......\n");
+  BookBuilder builder(2);
+  // the centre wins, the corner of the window loses
+  int n_added = 0;
+  for (int i = 0; i < 3; ++i)
+    n_added += builder.add_move(*empty, {3, 3}, 1);
+  n_added += builder.add_move(*empty, {1, 1}, 0);
+  n_added += builder.add_move(*empty, {5, 5}, 0.5);
+  assert(n_added == 5);
+  const bool added = builder.add_move(*empty, {0, 0}, 1);
+  assert(!added);
+  // O answers next to the stone in the mirrored position
+  BookBuilder other(2);
+  const auto x_mirrored = parse("7 7 4\n.......\n.......\n....X..\n"
+                                ".......\n.......\n.......\n.......\n");
+  n_added = other.add_move(*x_mirrored, {3, 2}, 1);
+  assert(n_added == 1);
+  builder.merge(other);
+  assert(builder.get_positions_num() == 6);
+  const bool saved = builder.save(path);
+  assert(saved);
+
+  OpeningBook book;
+  const char *error = nullptr;
+  bool opened = book.open(path, &error);
+  assert(opened);
+  assert(book.get_radius() == 2);
+  std::vector<BookMove> moves;
+  book.probe(*empty, moves);
+  assert(moves.size() == 3);
+  assert(moves[0].move.x == 3 && moves[0].move.y == 3);
+  assert(moves[0].games == 3 && moves[0].wins == 3);
+  Point move;
+  bool found = book.find_move(*empty, move);
+  assert(found && move.x == 3 && move.y == 3);
+  // (3, 2) in the mirrored position is (3, 2) or (2, 3) here
+  found = book.find_move(*x_moved, move);
+  assert(found);
+  assert((move.x == 3 && move.y == 2) || (move.x == 2 && move.y == 3));
+  found = book.find_move(*x_moved, move, 2);
+  assert(!found);
+
+  // the player falls back to the wrapped one out of the book
+  auto shared = std::make_shared<OpeningBook>();
+  opened = shared->open(path);
+  assert(opened);
+  ttt::my_player::MyPlayer random("random");
+  ttt::my_player::BookPlayer player(random, shared, 1);
+  player.set_sign(ttt::game::Sign::X);
+  move = player.make_move(*empty);
+  assert(move.x == 3 && move.y == 3 && player.get_book_moves() == 1);
+  player.make_move(*x_moved);
+  assert(player.get_book_moves() == 1);
+
+  std::FILE *file = std::fopen(path, "ab");
+  std::fputc(0, file);
+  std::fclose(file);
+  opened = book.open(path, &error);
+  assert(!opened);
+  std::remove(path);
+}
+
+int main() {
+  test_keys();
+  test_book();
+  std::cout << "opening book tests passed\n";
+  return 0;
+}
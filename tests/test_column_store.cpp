@@ -0,0 +1,167 @@
+#include "player/my_player.hpp"
+#include "stats/aggregator.hpp"
+#include "stats/column_store.hpp"
+#include "stats/recorder.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ttt;
+
+struct PlayedGame {
+  game::State state;
+  int rows;
+  int cols;
+};
+
+// Plays games of two MyPlayers on a field and records them to the store.
+static void play_games(stats::StatsRecorder &recorder, int rows, int cols,
+                       int n_games, std::vector<PlayedGame> &played) {
+  game::State::Opts opts;
+  opts.rows = rows;
+  opts.cols = cols;
+  opts.win_len = 4;
+  opts.max_moves = 0;
+  auto field_initializer = game::RandomObstaclesFI(0.8, 4, 1);
+  my_player::MyPlayer p1("p1");
+  my_player::MyPlayer p2("p2");
+  stats::ThinkTimer t1(p1, recorder), t2(p2, recorder);
+  game::Game game(opts, &field_initializer);
+  game.add_player(game::Sign::X, &t1);
+  game.add_player(game::Sign::O, &t2);
+  game.add_observer(&recorder);
+  for (int i = 0; i < n_games; ++i) {
+    while (game.process() == game::MoveResult::OK)
+      ;
+    played.push_back({game.get_state(), rows, cols});
+    game.reset();
+  }
+}
+
+// Columns of the store hold the games in the order they were played.
+static void check_store(const stats::ColumnStore &store,
+                        const std::vector<PlayedGame> &played) {
+  assert(store.get_games_num() == played.size());
+  assert(store.get_players().size() == 2);
+  const int p1 = store.find_player("p1");
+  assert(p1 >= 0 && store.find_player("nobody") < 0);
+  size_t move = 0;
+  for (size_t i = 0; i < played.size(); ++i) {
+    const auto &st = played[i].state;
+    assert(store.games.game_id[i] == i);
+    assert(store.games.rows[i] == played[i].rows);
+    assert(store.games.cols[i] == played[i].cols);
+    assert(store.games.x_player[i] == p1);
+    assert(store.games.winner[i] == uint8_t(st.get_winner()));
+    assert(store.games.n_moves[i] == st.get_move_no());
+    for (int m = 0; m < st.get_move_no(); ++m, ++move) {
+      assert(store.moves.game_id[move] == i);
+      assert(store.moves.move_no[move] == m);
+      const auto sign = game::Sign(store.moves.sign[move]);
+      assert(sign == (m % 2 == 0 ? game::Sign::X : game::Sign::O));
+      assert(st.get_value(store.moves.x[move], store.moves.y[move]) == sign);
+      const auto outcome = stats::Outcome(store.moves.outcome[move]);
+      assert(outcome == (st.get_winner() == game::Sign::NONE
+                             ? stats::Outcome::DRAW
+                         : st.get_winner() == sign ? stats::Outcome::WIN
+                                                   : stats::Outcome::LOSS));
+    }
+  }
+  assert(store.get_moves_num() == move);
+}
+
+// Aggregates add up to the moves of the games of every field size.
+static void check_aggregates(const stats::ColumnStore &store,
+                             const std::vector<PlayedGame> &played) {
+  long moves_10x10 = 0, moves_8x12 = 0, x_moves = 0;
+  for (const auto &g : played) {
+    const int n = g.state.get_move_no();
+    (g.rows == 10 ? moves_10x10 : moves_8x12) += n;
+    x_moves += (n + 1) / 2;
+  }
+  for (int n_threads : {1, 3}) {
+    stats::Query query;
+    query.n_threads = n_threads;
+    const auto heatmaps = stats::compute_heatmaps(store, query);
+    assert(heatmaps.size() == 2);
+    long totals[2] = {0, 0};
+    for (int i = 0; i < 2; ++i)
+      for (long m : heatmaps[i].moves)
+        totals[i] += m;
+    assert(totals[0] >= totals[1]);
+    for (const auto &h : heatmaps) {
+      const long total = &h == &heatmaps[0] ? totals[0] : totals[1];
+      if (h.rows == 10) {
+        assert(h.cols == 10 && total == moves_10x10);
+      } else {
+        assert(h.rows == 8 && h.cols == 12 && total == moves_8x12);
+      }
+      for (int y = 0; y < h.rows; ++y)
+        for (int x = 0; x < h.cols; ++x)
+          assert(h.get_wins(x, y) <= h.get_moves(x, y));
+    }
+
+    const auto by_move = stats::compute_move_number_stats(store, query);
+    long total = 0;
+    for (long m : by_move.moves)
+      total += m;
+    assert(total == moves_10x10 + moves_8x12);
+    assert(stats::compute_latency(store, query).get_count() == total);
+
+    query.sign = int(game::Sign::X);
+    total = 0;
+    for (long m : stats::compute_move_number_stats(store, query).moves)
+      total += m;
+    assert(total == x_moves);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  std::cout << "Testing column store of game statistics\n";
+  if (argc >= 2) {
+    std::srand(atoi(argv[1]));
+  }
+  const std::string dir = "test_column_store.dir";
+  std::filesystem::remove_all(dir);
+
+  std::vector<PlayedGame> played;
+  {
+    stats::ColumnWriter writer(dir.c_str());
+    assert(writer.is_open());
+    stats::StatsRecorder recorder(writer);
+    play_games(recorder, 10, 10, 4, played);
+    play_games(recorder, 8, 12, 3, played);
+  }
+  stats::ColumnStore store;
+  bool opened = store.open(dir.c_str());
+  assert(opened);
+  check_store(store, played);
+
+  // games appended by a new writer go on with the ids of the store
+  {
+    stats::ColumnWriter writer(dir.c_str());
+    assert(writer.get_next_game_id() == played.size());
+    stats::StatsRecorder recorder(writer);
+    play_games(recorder, 8, 12, 2, played);
+  }
+  opened = store.open(dir.c_str());
+  assert(opened);
+  check_store(store, played);
+  check_aggregates(store, played);
+
+  // a failed open does not stick to the store
+  assert(!store.open("test_column_store.missing"));
+  assert(store.get_error() != nullptr);
+  opened = store.open(dir.c_str());
+  assert(opened);
+  assert(store.get_error() == nullptr);
+
+  std::cout << "recorded " << store.get_games_num() << " games, "
+            << store.get_moves_num() << " moves\n";
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "journal/journal.hpp"
+#include "journal/replay.hpp"
+#include "player/my_player.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ttt;
+
+struct EventCounter : public game::IObserver {
+  int moves = 0;
+  int finished = 0;
+  void handle_event(const game::State &, const game::Event &event) override {
+    if (event.type == game::EventType::MOVE)
+      ++moves;
+    if (event.type == game::EventType::WIN ||
+        event.type == game::EventType::DRAW ||
+        event.type == game::EventType::DQ)
+      ++finished;
+  }
+};
+
+static bool same_field(const game::State &a, const game::State &b) {
+  const auto &opts = a.get_opts();
+  for (int x = 0; x < opts.cols; ++x)
+    for (int y = 0; y < opts.rows; ++y)
+      if (a.get_value(x, y) != b.get_value(x, y))
+        return false;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  std::cout << "Testing journal writer and replay\n";
+  if (argc >= 2) {
+    std::srand(atoi(argv[1]));
+  }
+  const std::string path = "test_journal.bin";
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+
+  game::State::Opts opts;
+  opts.rows = opts.cols = 20;
+  opts.win_len = 5;
+  opts.max_moves = 0;
+  auto field_initializer = game::RandomObstaclesFI(0.75, 50, 1);
+
+  my_player::MyPlayer p1("p1");
+  my_player::MyPlayer p2("p2");
+  game::Game game(opts, &field_initializer);
+  game.add_player(game::Sign::X, &p1);
+  game.add_player(game::Sign::O, &p2);
+
+  const int n_games = 30;
+  std::vector<game::State> final_states;
+  {
+    journal::JournalWriter writer(path.c_str(), 100);
+    assert(writer.is_open());
+    game.add_observer(&writer);
+    for (int i = 0; i < n_games; ++i) {
+      while (game.process() == game::MoveResult::OK)
+        ;
+      final_states.push_back(game.get_state());
+      game.reset();
+    }
+    game.remove_observer(&writer);
+  }
+
+  journal::Journal jr;
+  bool opened = jr.open(path.c_str());
+  assert(opened);
+  assert(jr.get_games_num() == n_games);
+  for (int i = 0; i < n_games; ++i) {
+    auto view = jr.find_game(100 + i);
+    assert(view.is_valid());
+    assert(view.get_name(game::Sign::X) == "p1");
+    assert(view.get_name(game::Sign::O) == "p2");
+    auto state = journal::rebuild_state(view);
+    assert(same_field(state, final_states[i]));
+    assert(state.get_winner() == final_states[i].get_winner());
+    assert(view.get_winner() == final_states[i].get_winner());
+
+    EventCounter counter;
+    journal::replay_game(view, counter);
+    assert(counter.moves == view.get_moves_num());
+    assert(counter.finished == 1);
+
+    auto half = journal::rebuild_state(view, view.get_moves_num() / 2);
+    assert(half.get_move_no() == view.get_moves_num() / 2);
+  }
+  assert(!jr.find_game(100 + n_games).is_valid());
+
+  // second open uses the saved index
+  journal::Journal jr2;
+  opened = jr2.open(path.c_str());
+  assert(opened);
+  assert(jr2.get_games_num() == n_games);
+
+  std::atomic<int> total_moves{0};
+  journal::for_each_game_parallel(jr2, 4, [&](const journal::GameView &view,
+                                              int) {
+    total_moves += view.get_moves_num();
+  });
+  int expected_moves = 0;
+  for (auto &st : final_states)
+    expected_moves += st.get_move_no();
+  assert(total_moves == expected_moves);
+
+  // an index entry outside of the journal is reported, not read
+  {
+    std::FILE *f = std::fopen((path + ".idx").c_str(), "r+b");
+    assert(f);
+    journal::IndexHeader hdr;
+    size_t n = std::fread(&hdr, sizeof(hdr), 1, f);
+    journal::IndexEntry entry;
+    n += std::fread(&entry, sizeof(entry), 1, f);
+    entry.offset = hdr.journal_size + 64;
+    std::fseek(f, sizeof(hdr), SEEK_SET);
+    n += std::fwrite(&entry, sizeof(entry), 1, f);
+    std::fclose(f);
+    assert(n == 3);
+  }
+  journal::Journal jr3;
+  opened = jr3.open(path.c_str());
+  assert(!opened && jr3.get_error() != nullptr);
+  std::remove((path + ".idx").c_str());
+  opened = jr3.open(path.c_str());
+  assert(opened);
+  assert(jr3.get_games_num() == n_games);
+
+  std::cout << "replayed " << n_games << " games, " << total_moves
+            << " moves\n";
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "engine/mcts.hpp"
+#include "player/mcts_player.hpp"
+#include "player/my_player.hpp"
+#include "test_positions.hpp"
+#include "test_stats.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using ttt::engine::Board;
+using ttt::engine::Mcts;
+using ttt::game::Point;
+using ttt::game::State;
+using ttt::test::make_state;
+
+static Point search(const State &state, int playouts) {
+  Mcts mcts;
+  mcts.reset(Board(state));
+  ttt::engine::MctsLimits limits;
+  limits.playouts = playouts;
+  return mcts.run(limits).move;
+}
+
+static void test_tactics() {
+  // X completes the line and O has nothing to answer with
+  State state = make_state(10, 4, {{1, 1}, {1, 5}, {2, 1}, {2, 5}, {3, 1},
+                                   {8, 8}});
+  Point pt = search(state, 2000);
+  assert(pt.y == 1 && (pt.x == 0 || pt.x == 4));
+
+  // O must block the line of X
+  state = make_state(10, 4, {{1, 1}, {0, 1}, {2, 1}, {5, 5}, {3, 1}});
+  pt = search(state, 2000);
+  assert(pt.x == 4 && pt.y == 1);
+
+  // X has completed a line, O draws with the last reply
+  state = make_state(10, 4, {{1, 1}, {1, 5}, {2, 1}, {2, 5}, {3, 1}, {3, 5},
+                             {4, 1}});
+  pt = search(state, 100);
+  assert(pt.y == 5 && (pt.x == 0 || pt.x == 4));
+}
+
+static void test_reuse() {
+  const State state = make_state(12, 4, {{5, 5}, {6, 6}, {5, 6}});
+  Mcts mcts;
+  mcts.reset(Board(state));
+  ttt::engine::MctsLimits limits;
+  limits.playouts = 3000;
+  auto result = mcts.run(limits);
+  assert(result.reused_visits == 0 && result.playouts == 3000);
+  // the subtree of the chosen move keeps its visits
+  mcts.advance(result.move);
+  result = mcts.run(limits);
+  assert(result.reused_visits > 0);
+  // and so does the subtree of the expected reply
+  mcts.advance(result.move);
+  result = mcts.run(limits);
+  assert(result.reused_visits > 0);
+  // a move far from the stones has no node
+  mcts.advance({0, 11});
+  result = mcts.run(limits);
+  assert(result.reused_visits == 0);
+  // a taken cell drops the position
+  mcts.advance({5, 5});
+  assert(!mcts.is_synced(Board(state)));
+}
+
+// Counts moves of the player playing X which started from a tree kept from the
+// previous moves.
+struct ReuseObserver : ttt::game::IObserver {
+  const ttt::my_player::MctsPlayer *player;
+  int moves = 0;
+  int reused = 0;
+
+  void handle_event(const State &state,
+                    const ttt::game::Event &event) override {
+    if (event.type != ttt::game::EventType::MOVE ||
+        event.data.move.player != ttt::game::Sign::X)
+      return;
+    ++moves;
+    reused += player->get_last_result().reused_visits > 0;
+  }
+};
+
+static void test_games() {
+  ttt::engine::MctsParams params;
+  // a small arena makes the tree compact during the games
+  params.max_nodes = 1 << 14;
+  ttt::my_player::MctsPlayer mcts_player("mcts", 300, params);
+  // a playout budget instead of the time keeps the games and the reuse of
+  // the tree independent of the load of the machine
+  mcts_player.set_playout_limit(1000);
+  ttt::my_player::MyPlayer random_player("random");
+  ReuseObserver observer;
+  observer.player = &mcts_player;
+  auto result = ttt::test::run_game_tests(mcts_player, random_player, 3, 12,
+                                          4, 0.75, 50, 1, &observer);
+  ttt::test::print_test_results(result, "mcts", "random");
+  std::cout << "tree reused in " << observer.reused << " of "
+            << observer.moves << " moves\n";
+  assert(result.x_wins + result.draws == 3 && result.x_wins >= 2);
+  // replies of the random player are often not in the tree
+  assert(observer.reused > 0);
+  result = ttt::test::run_game_tests(random_player, mcts_player, 3, 12, 4);
+  ttt::test::print_test_results(result, "random", "mcts");
+  assert(result.o_wins + result.draws == 3);
+}
+
+int main(int argc, char *argv[]) {
+  std::srand(argc > 1 ? std::atoi(argv[1]) : 1);
+  test_tactics();
+  test_reuse();
+  test_games();
+  std::cout << "mcts tests passed\n";
+  return 0;
+}
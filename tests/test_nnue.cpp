@@ -0,0 +1,178 @@
+#include "engine/board.hpp"
+#include "engine/nnue.hpp"
+#include "engine/nnue_train.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using ttt::engine::Board;
+using ttt::engine::Network;
+using ttt::engine::NetworkTrainer;
+using ttt::engine::SimdIsa;
+using ttt::game::Sign;
+using ttt::game::State;
+
+static State::Opts make_opts(int size, int win_len) {
+  State::Opts opts;
+  opts.rows = opts.cols = size;
+  opts.win_len = win_len;
+  opts.max_moves = 0;
+  return opts;
+}
+
+static void random_moves(State &state, int n) {
+  const auto &opts = state.get_opts();
+  for (int i = 0; i < n; ++i) {
+    if (state.get_status() == ttt::game::Status::ENDED)
+      return;
+    int x, y;
+    do {
+      x = std::rand() % opts.cols;
+      y = std::rand() % opts.rows;
+    } while (state.get_value(x, y) != Sign::NONE);
+    state.process_move(state.get_current_player(), x, y);
+  }
+}
+
+static std::shared_ptr<Network> make_network(const NetworkTrainer &trainer,
+                                             SimdIsa isa) {
+  const auto data = trainer.quantize();
+  auto net = std::make_shared<Network>();
+  const char *error = nullptr;
+  const bool assigned = net->assign(data.data(), data.size(), &error);
+  assert(assigned);
+  net->set_isa(isa);
+  return net;
+}
+
+// Accumulators updated on make and unmake give the evaluation of a board
+// which is built from scratch, with either instruction set.
+static void test_incremental() {
+  ttt::game::RandomObstaclesFI initializer(0.8, 3, 1);
+  const State::Opts opts = make_opts(9, 4);
+  NetworkTrainer trainer(opts.rows, opts.cols, opts.win_len, 32, 7);
+  const auto scalar = make_network(trainer, SimdIsa::SCALAR);
+  const auto best = make_network(trainer, SimdIsa::AVX2);
+  for (int game = 0; game < 10; ++game) {
+    State state(opts, &initializer);
+    random_moves(state, game);
+    Board board(state);
+    bool attached = board.set_network(best);
+    assert(attached);
+    const int start_eval = board.get_eval();
+    Board fresh(state);
+    attached = fresh.set_network(scalar);
+    assert(attached);
+    assert(fresh.get_eval() == start_eval);
+
+    std::vector<int> cells;
+    while (!board.is_over() && int(cells.size()) < 20) {
+      int cell;
+      do {
+        cell = board.index(std::rand() % opts.cols, std::rand() % opts.rows);
+      } while (!board.is_empty(cell));
+      board.make(cell);
+      cells.push_back(cell);
+      fresh = board;
+      attached = fresh.set_network(scalar);
+      assert(attached);
+      assert(fresh.get_eval() == board.get_eval());
+    }
+    for (size_t i = 0; i < cells.size(); ++i)
+      board.unmake();
+    assert(board.get_eval() == start_eval);
+    // moves made before the network was attached are undone from scratch
+    for (int cell : cells)
+      board.make(cell);
+    attached = board.set_network(best);
+    assert(attached);
+    for (size_t i = 0; i < cells.size(); ++i)
+      board.unmake();
+    assert(board.get_eval() == start_eval);
+  }
+
+  Board other(State(make_opts(8, 4)));
+  const bool attached = other.set_network(best);
+  assert(!attached && !other.get_network());
+}
+
+static void test_file() {
+  const State::Opts opts = make_opts(6, 4);
+  NetworkTrainer trainer(opts.rows, opts.cols, opts.win_len, 20, 3);
+  assert(trainer.get_hidden() == 32);
+  const char *path = "test_nnue.bin";
+  const bool saved = trainer.save(path);
+  assert(saved);
+  auto mapped = std::make_shared<Network>();
+  const char *error = nullptr;
+  bool opened = mapped->open(path, &error);
+  assert(opened);
+  assert(mapped->get_rows() == 6 && mapped->get_hidden() == 32);
+  const auto copy = make_network(trainer, ttt::engine::get_best_isa());
+
+  State state(opts);
+  random_moves(state, 9);
+  Board a(state), b(state);
+  const bool attached = a.set_network(mapped) && b.set_network(copy);
+  assert(attached);
+  assert(a.get_eval() == b.get_eval());
+
+  std::FILE *file = std::fopen(path, "r+b");
+  std::fputc('X', file);
+  std::fclose(file);
+  Network bad;
+  opened = bad.open(path, &error);
+  assert(!opened);
+  opened = bad.open("no_such_network.bin", &error);
+  assert(!opened);
+  std::remove(path);
+}
+
+// The network learns the evaluation by line windows on random positions and
+// the quantised network is close to the float one.
+static void test_training() {
+  const State::Opts opts = make_opts(7, 4);
+  NetworkTrainer trainer(opts.rows, opts.cols, opts.win_len, 32, 5);
+  std::vector<State> positions;
+  for (int i = 0; i < 300; ++i) {
+    State state(opts);
+    random_moves(state, 2 + i % 12);
+    const Board board(state);
+    if (board.is_over() || board.is_last_move())
+      continue;
+    const float target = 1 / (1 + std::exp(-board.get_eval() / 233.f));
+    trainer.add_position(board, target);
+    positions.push_back(state);
+  }
+  trainer.split(0.1);
+  const double first = trainer.train_epoch(0.05f);
+  double loss = first;
+  for (int epoch = 0; epoch < 10; ++epoch)
+    loss = trainer.train_epoch(0.05f);
+  std::cout << "training loss " << first << " -> " << loss
+            << ", validation " << trainer.get_validation_loss() << '\n';
+  assert(loss < first);
+
+  const auto net = make_network(trainer, ttt::engine::get_best_isa());
+  for (const State &state : positions) {
+    Board board(state);
+    const float p = trainer.predict(board);
+    board.set_network(net);
+    const float q = 1 / (1 + std::exp(-board.get_eval() / 233.f));
+    assert(std::abs(p - q) < 0.05);
+  }
+}
+
+int main() {
+  std::srand(5);
+  test_incremental();
+  test_file();
+  test_training();
+  std::cout << "nnue tests passed\n";
+  return 0;
+}
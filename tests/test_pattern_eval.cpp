@@ -0,0 +1,133 @@
+#include "engine/board.hpp"
+#include "engine/pattern_eval.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using ttt::engine::Board;
+using ttt::engine::PatternEval;
+using ttt::engine::SimdIsa;
+using ttt::game::Sign;
+using ttt::game::State;
+
+static const SimdIsa ISAS[] = {SimdIsa::SCALAR, SimdIsa::SSE2, SimdIsa::AVX2};
+
+// Every instruction set gives the evaluation and the gains of `Board`.
+static void check(const State &state) {
+  const Board board(state);
+  const int cols = state.get_opts().cols;
+  std::vector<int> gains;
+  for (const SimdIsa isa : ISAS) {
+    PatternEval eval;
+    eval.set_isa(isa);
+    eval.load(state);
+    assert(eval.evaluate() == board.get_eval());
+    for (int side = 0; side < 2; ++side) {
+      eval.get_gains(side, gains);
+      for (int y = 0; y < state.get_opts().rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+          const int cell = board.index(x, y);
+          const int expected =
+              board.is_empty(cell) ? board.get_move_gain(cell, side) : 0;
+          assert(gains[y * cols + x] == expected);
+        }
+      }
+    }
+  }
+}
+
+static void test_random_positions() {
+  ttt::game::RandomObstaclesFI initializer(0.8, 3, 1);
+  const int sizes[][3] = {{3, 3, 3}, {7, 5, 4},   {15, 15, 5},
+                          {20, 20, 5}, {9, 30, 6}, {20, 20, 17}};
+  for (const auto &size : sizes) {
+    State::Opts opts;
+    opts.rows = size[0];
+    opts.cols = size[1];
+    opts.win_len = size[2];
+    opts.max_moves = 0;
+    for (int game = 0; game < 4; ++game) {
+      State state(opts, &initializer);
+      check(state);
+      for (int i = 0; i < opts.rows * opts.cols / 3; ++i) {
+        if (state.get_status() == ttt::game::Status::ENDED)
+          break;
+        int x, y;
+        do {
+          x = std::rand() % opts.cols;
+          y = std::rand() % opts.rows;
+        } while (state.get_value(x, y) != Sign::NONE);
+        state.process_move(state.get_current_player(), x, y);
+        if (i % 5 == 0)
+          check(state);
+      }
+      check(state);
+    }
+  }
+}
+
+static void test_patterns() {
+  State::Opts opts;
+  opts.rows = opts.cols = 6;
+  opts.win_len = 4;
+  opts.max_moves = 0;
+  State state(opts);
+  state.process_move(Sign::X, 0, 0);
+  state.process_move(Sign::O, 1, 1);
+  PatternEval eval;
+  eval.load(state);
+  // one X and three empty cells, one X and one O
+  assert(eval.get_pattern(0, 0, 0) == 1);
+  assert(eval.get_pattern(0, 0, 2) == 1 + 5);
+  // windows past the edge count the missing cells as walls
+  assert(eval.get_pattern(4, 0, 0) == 2 * 25);
+  assert(eval.get_pattern(2, 0, 3) == 25 + 5);
+}
+
+static void bench() {
+  State::Opts opts;
+  opts.rows = opts.cols = 20;
+  opts.win_len = 5;
+  opts.max_moves = 0;
+  State state(opts);
+  for (int i = 0; i < 40; ++i) {
+    int x, y;
+    do {
+      x = std::rand() % opts.cols;
+      y = std::rand() % opts.rows;
+    } while (state.get_value(x, y) != Sign::NONE);
+    state.process_move(state.get_current_player(), x, y);
+  }
+  std::vector<int> gains;
+  for (const SimdIsa isa : ISAS) {
+    PatternEval eval;
+    eval.set_isa(isa);
+    if (eval.get_isa() != isa)
+      continue;
+    const int n = 200;
+    const auto start = std::chrono::steady_clock::now();
+    int sum = 0;
+    for (int i = 0; i < n; ++i) {
+      eval.load(state);
+      eval.get_gains(i & 1, gains);
+      sum += eval.evaluate() + gains[0];
+    }
+    const double us = std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    std::cout << ttt::engine::to_string(isa) << ": " << us / n
+              << " us per position (" << sum % 2 << ")\n";
+  }
+}
+
+int main() {
+  std::srand(3);
+  test_patterns();
+  test_random_positions();
+  bench();
+  std::cout << "pattern evaluator tests passed\n";
+  return 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/game.hpp"
+#include "engine/board.hpp"
+#include "engine/position.hpp"
+#include "engine/proof_solver.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ttt::test {
+
+// Square field without walls after the moves, X moves first.
+inline game::State make_state(int size, int win_len,
+                              const std::vector<game::Point> &moves) {
+  game::State::Opts opts;
+  opts.rows = opts.cols = size;
+  opts.win_len = win_len;
+  opts.max_moves = 0;
+  game::State state(opts);
+  for (const auto &pt : moves) {
+    const game::MoveResult rc =
+        state.process_move(state.get_current_player(), pt.x, pt.y);
+    assert(rc == game::MoveResult::OK);
+  }
+  return state;
+}
+
+// State of a position in the text format of `engine::read_position`.
+inline std::unique_ptr<game::State> parse(const std::string &text) {
+  std::istringstream in(text);
+  engine::Position pos;
+  const char *error = nullptr;
+  const bool read = engine::read_position(in, pos, &error);
+  assert(read);
+  auto state = engine::make_state(pos, &error);
+  assert(state && !error);
+  return state;
+}
+
+// Plain minimax over every empty cell: 1, 0 or -1 for the side to move.
+// Positions are memoized by their hash, which covers the stones, hence the
+// move number, and the LAST_MOVE state.
+inline int minimax(engine::Board &b, std::unordered_map<uint64_t, int> &memo) {
+  if (b.is_over()) {
+    if (b.get_outcome() == engine::Outcome::DRAW)
+      return 0;
+    const int winner = b.get_outcome() == engine::Outcome::X_WINS ? 0 : 1;
+    return winner == b.get_side_to_move() ? 1 : -1;
+  }
+  const auto it = memo.find(b.get_hash());
+  if (it != memo.end())
+    return it->second;
+  int best = -1;
+  for (int y = 0; y < b.get_rows() && best < 1; ++y) {
+    for (int x = 0; x < b.get_cols() && best < 1; ++x) {
+      const int cell = b.index(x, y);
+      if (!b.is_empty(cell))
+        continue;
+      b.make(cell);
+      best = std::max(best, -minimax(b, memo));
+      b.unmake();
+    }
+  }
+  memo[b.get_hash()] = best;
+  return best;
+}
+
+inline engine::ProofValue value_of(int score) {
+  return score > 0   ? engine::ProofValue::WIN
+         : score < 0 ? engine::ProofValue::LOSS
+                     : engine::ProofValue::DRAW;
+}
+
+}; // namespace ttt::test
@@ -0,0 +1,202 @@
+#include "engine/position.hpp"
+#include "engine/proof_solver.hpp"
+#include "engine/suite.hpp"
+#include "test_positions.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using ttt::engine::Board;
+using ttt::engine::Position;
+using ttt::engine::ProofLimits;
+using ttt::engine::ProofResult;
+using ttt::engine::ProofSolver;
+using ttt::engine::ProofValue;
+using ttt::game::State;
+using ttt::test::minimax;
+using ttt::test::parse;
+using ttt::test::value_of;
+
+// The solved value agrees with minimax and the move keeps it.
+static void check(ProofSolver &solver, const State &state) {
+  Board board(state);
+  std::unordered_map<uint64_t, int> memo;
+  const int score = minimax(board, memo);
+  const ProofResult result = solver.solve(state, ProofLimits());
+  assert(result.value == value_of(score));
+  if (board.is_over())
+    return;
+  board.make(board.index(result.move.x, result.move.y));
+  if (result.value != ProofValue::LOSS)
+    assert(-minimax(board, memo) == score);
+}
+
+static void test_positions() {
+  ProofSolver solver(4);
+  // X completes the row and O has no line to answer with
+  auto state = parse("3 3 3 0\n"
+                     "XXX\n"
+                     "O..\n"
+                     "..O\n"
+                     "last 2 0\n");
+  assert(state->get_status() == ttt::game::Status::LAST_MOVE);
+  ProofResult result = solver.solve(*state, ProofLimits());
+  assert(result.value == ProofValue::LOSS);
+
+  // the same with a reply which completes the line of O
+  state = parse("3 4 3 0\n"
+                "XXX.\n"
+                "OO..\n"
+                "#...\n"
+                "last 2 0\n");
+  result = solver.solve(*state, ProofLimits());
+  assert(result.value == ProofValue::DRAW);
+  assert(result.move.x == 2 && result.move.y == 1);
+  check(solver, *state);
+
+  // walls split the field
+  state = parse("4 4 3 0\n"
+                "X.#.\n"
+                ".O#.\n"
+                "..#.\n"
+                "....\n");
+  check(solver, *state);
+}
+
+static void test_random() {
+  ProofSolver solver(4);
+  std::srand(7);
+  int counts[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 30; ++i) {
+    State::Opts opts;
+    opts.rows = opts.cols = 4;
+    opts.win_len = 3;
+    opts.max_moves = i % 3 == 0 ? 12 : 0;
+    State state(opts);
+    const int n_stones = 4 + i % 4;
+    for (int k = 0; k < n_stones; ++k) {
+      int x, y;
+      do {
+        x = std::rand() % 4;
+        y = std::rand() % 4;
+      } while (state.get_value(x, y) != ttt::game::Sign::NONE);
+      state.process_move(state.get_current_player(), x, y);
+    }
+    check(solver, state);
+    ++counts[int(solver.solve(state, ProofLimits()).value)];
+  }
+  std::cout << "random 4x4: " << counts[1] << " wins, " << counts[2]
+            << " draws, " << counts[3] << " losses\n";
+
+  // the empty 3x3 field
+  State::Opts opts;
+  opts.rows = opts.cols = opts.win_len = 3;
+  opts.max_moves = 0;
+  check(solver, State(opts));
+}
+
+static void test_limits() {
+  // an empty 7x7 field is far beyond the budget
+  State::Opts opts;
+  opts.rows = opts.cols = 7;
+  opts.win_len = 4;
+  opts.max_moves = 0;
+  ProofSolver solver(1);
+  ProofLimits limits;
+  limits.nodes = 5000;
+  const ProofResult result = solver.solve(State(opts), limits);
+  assert(result.value == ProofValue::UNKNOWN);
+  assert(result.nodes < limits.nodes + 2048);
+}
+
+static void test_format() {
+  const char *text = "# comment\n"
+                     "\n"
+                     "3 4 3 6\n"
+                     "X.O#\n"
+                     ".X..\n"
+                     "....\n"
+                     "last 1 1\n"
+                     "name sample\n";
+  std::istringstream in(text);
+  Position pos;
+  const char *error = nullptr;
+  bool read = ttt::engine::read_position(in, pos, &error);
+  assert(read);
+  assert(pos.opts.max_moves == 6 && pos.last.x == 1 && pos.last.y == 1);
+  assert(pos.get_tag("name") && *pos.get_tag("name") == "sample");
+  read = ttt::engine::read_position(in, pos, &error);
+  assert(!read && !error);
+
+  auto state = ttt::engine::make_state(pos);
+  assert(state && state->get_move_no() == 3);
+  std::ostringstream out;
+  const Position written = ttt::engine::make_position(*state, pos.last);
+  ttt::engine::write_position(out, written);
+  assert(out.str() == "3 4 3 6\nX.O#\n.X..\n....\nlast 1 1\n\n");
+
+  // O cannot have more stones than X
+  std::istringstream bad("2 2 2 0\nO.\n..\n");
+  read = ttt::engine::read_position(bad, pos, &error);
+  assert(read);
+  state = ttt::engine::make_state(pos, &error);
+  assert(!state && error);
+  std::istringstream cut("3 3 3 0\n...\n");
+  read = ttt::engine::read_position(cut, pos, &error);
+  assert(!read && error);
+}
+
+// Suites check their optional tags against the stones and keep the entries
+// read before an error.
+static void test_suite() {
+  const char *text = "3 4 3\n"
+                     "XX..\n"
+                     "O...\n"
+                     ".O..\n"
+                     "side X\n"
+                     "status play\n"
+                     "best 2 0 3 0\n"
+                     "\n"
+                     "1 4 2\n"
+                     "XX.O\n"
+                     "last 1 0\n"
+                     "status last_move\n"
+                     "best 2 0\n";
+  std::istringstream in(text);
+  std::vector<ttt::engine::SuiteEntry> suite;
+  const char *error = nullptr;
+  bool read = ttt::engine::read_suite(in, suite, &error);
+  assert(read && !error);
+  assert(suite.size() == 2 && suite[0].best.size() == 2);
+  assert(suite[0].is_solved_by({3, 0}) && !suite[0].is_solved_by({1, 1}));
+  assert(suite[1].state->get_status() == ttt::game::Status::LAST_MOVE);
+
+  const char *bad[] = {
+      "2 2 2\nX.\n..\n",                     // no best moves
+      "2 2 2\nX.\n..\nbest 1\n",             // half of a move
+      "2 2 2\nX.\n..\nbest 0 0\n",           // a stone
+      "2 2 2\nX.\n..\nside X\nbest 1 0\n",  // O moves
+      "2 2 2\nX.\n..\nstatus last_move\nbest 1 0\n",
+  };
+  for (const char *t : bad) {
+    std::istringstream bad_in(std::string("2 2 2\n..\n..\nbest 0 0\n\n") +
+                              t);
+    suite.clear();
+    read = ttt::engine::read_suite(bad_in, suite, &error);
+    assert(!read && error);
+    assert(suite.size() == 1);
+  }
+}
+
+int main() {
+  test_format();
+  test_suite();
+  test_positions();
+  test_random();
+  test_limits();
+  std::cout << "proof solver tests passed\n";
+  return 0;
+}
@@ -0,0 +1,199 @@
+#include "player/my_player.hpp"
+#include "player/terminal_renderer.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ttt;
+
+// field rows start after the column indices and the separator line, cells
+// after the "yy |" prefix; rows and columns of the terminal start from 1
+static const int FIELD_TOP = 3;
+static const int FIELD_LEFT = 5;
+
+// Screen of an ANSI terminal which understands the sequences of the renderer
+// and remembers which cells every frame has written.
+struct Screen {
+  std::vector<std::string> chars;
+  std::vector<std::vector<bool>> inverse;
+  int row = 1;
+  int col = 1;
+  bool attr = false;
+  std::set<std::pair<int, int>> written;
+
+  void clear() {
+    chars.assign(64, std::string(128, ' '));
+    inverse.assign(64, std::vector<bool>(128, false));
+  }
+
+  void put(char c) {
+    chars[row][col] = c;
+    inverse[row][col] = attr;
+    written.insert({row, col});
+    ++col;
+  }
+
+  void apply(const std::string &frame) {
+    written.clear();
+    for (size_t i = 0; i < frame.size(); ++i) {
+      if (frame[i] == '\n') {
+        ++row;
+        col = 1;
+        continue;
+      }
+      if (frame[i] != '\x1b') {
+        put(frame[i]);
+        continue;
+      }
+      assert(frame[i + 1] == '[');
+      std::vector<int> params(1, 0);
+      for (i += 2; frame[i] == ';' || (frame[i] >= '0' && frame[i] <= '9');
+           ++i) {
+        if (frame[i] == ';')
+          params.push_back(0);
+        else
+          params.back() = params.back() * 10 + (frame[i] - '0');
+      }
+      switch (frame[i]) {
+      case 'H':
+        row = params.size() == 2 ? params[0] : 1;
+        col = params.size() == 2 ? params[1] : 1;
+        break;
+      case 'J':
+        assert(params[0] == 2);
+        clear();
+        break;
+      case 'K':
+        assert(params[0] == 2);
+        chars[row].assign(chars[row].size(), ' ');
+        break;
+      case 'm':
+        attr = params[0] == 7;
+        break;
+      default:
+        assert(false);
+      }
+    }
+  }
+};
+
+// Passes the events to the renderer and applies every frame to the screen.
+class ScreenObserver : public game::IObserver {
+  std::ostringstream m_out;
+  my_player::TerminalRenderer m_renderer;
+  Screen &m_screen;
+
+public:
+  ScreenObserver(Screen &screen) : m_renderer(m_out), m_screen(screen) {}
+
+  std::vector<game::Event> events;
+  std::vector<std::set<std::pair<int, int>>> field_writes;
+
+  void handle_event(const game::State &state,
+                    const game::Event &event) override {
+    m_renderer.handle_event(state, event);
+    m_screen.apply(m_out.str());
+    m_out.str("");
+    const auto &opts = state.get_opts();
+    std::set<std::pair<int, int>> cells;
+    for (const auto &[row, col] : m_screen.written) {
+      const int y = row - FIELD_TOP, x = (col - FIELD_LEFT) / 2;
+      if (y >= 0 && y < opts.rows && col >= FIELD_LEFT &&
+          (col - FIELD_LEFT) % 2 == 0 && x < opts.cols)
+        cells.insert({x, y});
+    }
+    events.push_back(event);
+    field_writes.push_back(cells);
+    // joined players are only remembered for the status line
+    if (event.type != game::EventType::PLAYER_JOINED)
+      check_field(state);
+  }
+
+  // The screen shows the state and highlights only the last move.
+  void check_field(const game::State &state) const {
+    const auto &opts = state.get_opts();
+    const auto &last = events.back();
+    for (int y = 0; y < opts.rows; ++y)
+      for (int x = 0; x < opts.cols; ++x) {
+        const int row = FIELD_TOP + y, col = FIELD_LEFT + 2 * x;
+        const char c = m_screen.chars[row][col];
+        switch (state.get_value(x, y)) {
+        case game::Sign::X:
+          assert(c == 'X');
+          break;
+        case game::Sign::O:
+          assert(c == 'O');
+          break;
+        case game::Sign::WALL:
+          assert(c == '#');
+          break;
+        default:
+          assert(c == '.');
+        }
+        const bool is_last = last.type == game::EventType::MOVE &&
+                             last.data.move.x == x && last.data.move.y == y;
+        assert(m_screen.inverse[row][col] == is_last ||
+               last.type != game::EventType::MOVE);
+      }
+  }
+};
+
+int main(int argc, char *argv[]) {
+  std::cout << "Testing terminal renderer\n";
+  if (argc >= 2) {
+    std::srand(atoi(argv[1]));
+  }
+  game::State::Opts opts;
+  opts.rows = 12;
+  opts.cols = 15;
+  opts.win_len = 5;
+  opts.max_moves = 0;
+  auto field_initializer = game::RandomObstaclesFI(0.8, 4, 1);
+  my_player::MyPlayer p1("p1");
+  my_player::MyPlayer p2("p2");
+  Screen screen;
+  screen.clear();
+  ScreenObserver obs(screen);
+  game::Game game(opts, &field_initializer);
+  game.add_player(game::Sign::X, &p1);
+  game.add_player(game::Sign::O, &p2);
+  game.add_observer(&obs);
+  for (int i = 0; i < 2; ++i) {
+    while (game.process() == game::MoveResult::OK)
+      ;
+    game.reset();
+  }
+
+  // the field is drawn at the start of a game, then a move writes its cell
+  // and the cell of the previous move only
+  int n_moves = 0, n_starts = 0;
+  const game::Event *prev_move = nullptr;
+  for (size_t i = 0; i < obs.events.size(); ++i) {
+    const auto &event = obs.events[i];
+    const auto &cells = obs.field_writes[i];
+    if (event.type == game::EventType::GAME_STARTED) {
+      assert(cells.size() == size_t(opts.rows * opts.cols));
+      prev_move = nullptr;
+      ++n_starts;
+    } else if (event.type == game::EventType::MOVE) {
+      std::set<std::pair<int, int>> expected = {
+          {event.data.move.x, event.data.move.y}};
+      if (prev_move)
+        expected.insert({prev_move->data.move.x, prev_move->data.move.y});
+      assert(cells == expected);
+      prev_move = &event;
+      ++n_moves;
+    } else {
+      assert(cells.empty());
+    }
+  }
+  assert(n_starts == 2 && n_moves > 0);
+  std::cout << "checked " << n_moves << " moves\n";
+  return 0;
+}
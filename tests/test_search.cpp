@@ -0,0 +1,561 @@
+#include "engine/analyzer.hpp"
+#include "engine/board.hpp"
+#include "engine/large_pages.hpp"
+#include "engine/move_order.hpp"
+#include "engine/parallel_search.hpp"
+#include "engine/time_manager.hpp"
+#include "engine/transposition_table.hpp"
+#include "player/analysis_writer.hpp"
+#include "player/my_player.hpp"
+#include "player/search_player.hpp"
+#include "test_positions.hpp"
+#include "test_stats.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using ttt::engine::Board;
+using ttt::engine::Bound;
+using ttt::engine::Outcome;
+using ttt::engine::TranspositionTable;
+using ttt::engine::TTEntry;
+using ttt::game::Point;
+using ttt::game::Sign;
+using ttt::game::State;
+using ttt::test::make_state;
+
+// Lists of winning cells match a scan of the field and the cells of
+// `list_x_wins` win against every reply of O.
+static void check_winning_cells(Board &board) {
+  for (int side = 0; side < 2; ++side) {
+    std::vector<int> cells = board.get_winning_cells(side), scan;
+    for (int cell = 0; cell < board.get_cells_num(); ++cell)
+      if (board.is_empty(cell) && board.is_winning_cell(cell, side))
+        scan.push_back(cell);
+    std::sort(cells.begin(), cells.end());
+    assert(cells == scan);
+  }
+  if (board.is_over() || board.get_side_to_move() != 0)
+    return;
+  // the list changes with moves
+  const std::vector<int> x_cells = board.get_winning_cells(0);
+  std::vector<int> wins, replies;
+  board.list_x_wins(wins);
+  for (const int cell : x_cells) {
+    board.make(cell);
+    bool x_wins = board.get_outcome() == Outcome::X_WINS;
+    if (board.is_last_move()) {
+      replies.clear();
+      for (int reply = 0; reply < board.get_cells_num(); ++reply)
+        if (board.is_empty(reply))
+          replies.push_back(reply);
+      x_wins = true;
+      for (const int reply : replies) {
+        board.make(reply);
+        x_wins &= board.get_outcome() == Outcome::X_WINS;
+        board.unmake();
+      }
+      assert(x_wins == (board.get_last_move_outcome() == Outcome::X_WINS));
+    }
+    board.unmake();
+    assert(x_wins == (std::count(wins.begin(), wins.end(), cell) == 1));
+  }
+}
+
+// Candidates of the masks match a scan of the cells around every cell.
+static void check_candidates(const Board &board) {
+  const auto &masks = board.get_masks();
+  assert(masks.is_valid());
+  ttt::engine::CandidateOpts opts;
+  for (int mode = 0; mode < 3; ++mode) {
+    opts.radius = mode == 0 ? 1 : 2;
+    opts.threats_only = mode == 2;
+    std::vector<Point> moves, scan;
+    ttt::engine::list_candidates(masks, opts, moves);
+    const int stride = board.get_geometry().stride;
+    for (int y = 0; y < board.get_rows(); ++y) {
+      for (int x = 0; x < board.get_cols(); ++x) {
+        const int cell = board.index(x, y);
+        if (!board.is_empty(cell))
+          continue;
+        bool ok = false;
+        if (opts.threats_only) {
+          ok = false;
+          for (int side = 0; side < 2; ++side)
+            ok |= board.is_winning_cell(cell, side) ||
+                  board.makes_threat(cell, side);
+        } else {
+          for (int dy = -opts.radius; dy <= opts.radius; ++dy)
+            for (int dx = -opts.radius; dx <= opts.radius; ++dx) {
+              const int v = board.at(cell + dy * stride + dx);
+              ok |= v == ttt::engine::X_STONE || v == ttt::engine::O_STONE;
+            }
+        }
+        if (ok)
+          scan.push_back({x, y});
+      }
+    }
+    if (scan.empty() && !opts.threats_only)
+      for (int y = 0; y < board.get_rows(); ++y)
+        for (int x = 0; x < board.get_cols(); ++x)
+          if (board.is_empty(board.index(x, y)))
+            scan.push_back({x, y});
+    assert(moves.size() == scan.size());
+    for (size_t i = 0; i < moves.size(); ++i)
+      assert(moves[i].x == scan[i].x && moves[i].y == scan[i].y);
+  }
+}
+
+// Incremental updates must give the same board as building it anew.
+static void test_board_consistency() {
+  ttt::game::RandomObstaclesFI initializer(0.8, 3, 1);
+  State::Opts opts;
+  opts.rows = opts.cols = 12;
+  opts.win_len = 4;
+  opts.max_moves = 0;
+  for (int game = 0; game < 20; ++game) {
+    State state(opts, &initializer);
+    Board board(state);
+    std::vector<uint64_t> hashes;
+    while (state.get_status() != ttt::game::Status::ENDED) {
+      int x, y;
+      do {
+        x = std::rand() % opts.cols;
+        y = std::rand() % opts.rows;
+      } while (state.get_value(x, y) != Sign::NONE);
+      hashes.push_back(board.get_hash());
+      state.process_move(state.get_current_player(), x, y);
+      board.make(board.index(x, y));
+      const Board fresh(state);
+      assert(fresh.get_hash() == board.get_hash());
+      assert(fresh.get_eval() == board.get_eval());
+      assert(fresh.get_threats(0) == board.get_threats(0));
+      assert(fresh.get_threats(1) == board.get_threats(1));
+      assert(fresh.is_last_move() == board.is_last_move());
+      assert(fresh.get_outcome() == board.get_outcome());
+      check_winning_cells(board);
+      check_candidates(board);
+    }
+    while (!hashes.empty()) {
+      board.unmake();
+      check_winning_cells(board);
+      check_candidates(board);
+      assert(board.get_hash() == hashes.back());
+      hashes.pop_back();
+    }
+  }
+}
+
+// Empty cells cut off from the stones by walls are still candidates.
+static void test_walled_candidates() {
+  const auto state = ttt::test::parse("6 6 4 0\n"
+                                      "XO##..\n"
+                                      "OX##..\n"
+                                      "####..\n"
+                                      "####..\n"
+                                      "......\n"
+                                      "......\n");
+  Board board(*state);
+  std::vector<int> cells;
+  ttt::engine::list_candidates(board, cells);
+  assert(cells.size() == 20);
+  check_candidates(board);
+  ttt::my_player::MyPlayer player("my");
+  player.set_sign(state->get_current_player());
+  for (int i = 0; i < 20; ++i) {
+    const Point move = player.make_move(*state);
+    assert(state->get_value(move.x, move.y) == ttt::game::Sign::NONE);
+  }
+}
+
+static void test_transposition_table() {
+  TranspositionTable tt(1);
+  TTEntry entry;
+  assert(!tt.probe(42, entry));
+  entry.cell = 7;
+  entry.score = -123;
+  entry.depth = 6;
+  entry.bound = Bound::LOWER;
+  tt.store(42, entry);
+  TTEntry found;
+  assert(tt.probe(42, found));
+  assert(found.cell == 7 && found.score == -123 && found.depth == 6 &&
+         found.bound == Bound::LOWER);
+  // a shallow bound of the same search keeps the deep result
+  entry.depth = 2;
+  entry.bound = Bound::UPPER;
+  tt.store(42, entry);
+  assert(tt.probe(42, found) && found.depth == 6);
+
+  // concurrent writers never produce an entry with data of another key
+  const int n_threads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&tt, t]() {
+      uint64_t key = 0x12345678u + t;
+      for (int i = 0; i < 200000; ++i) {
+        key = key * 6364136223846793005ull + 1442695040888963407ull;
+        // few distinct buckets make the threads collide
+        const uint64_t k = key & 0xffff000000000fffull;
+        TTEntry e;
+        if (tt.probe(k, e))
+          assert(e.score == int(k >> 48) && e.cell == int(k & 0xfff));
+        e.cell = int(k & 0xfff);
+        e.score = int(k >> 48);
+        e.depth = i & 15;
+        e.bound = Bound::EXACT;
+        tt.store(k, e);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  const auto stats = tt.get_stats();
+  std::cout << "tt: probes " << stats.probes << ", hits " << stats.hits
+            << ", collisions " << stats.collisions << ", fill "
+            << stats.fill_permille << "/1000\n";
+  assert(stats.probes == 3 + n_threads * 200000ull);
+}
+
+// Every page mode gives zeroed memory, huge pages fall back when the system
+// has none and small blocks get normal pages.
+static void test_large_pages() {
+  using ttt::engine::PageMode;
+  for (PageMode mode :
+       {PageMode::NORMAL, PageMode::TRANSPARENT, PageMode::HUGETLB}) {
+    ttt::engine::PageMemory memory(ttt::engine::HUGE_PAGE_SIZE + 1, mode);
+    assert(memory.get_data() && memory.get_size() > 0);
+    const char *bytes = static_cast<const char *>(memory.get_data());
+    assert(std::all_of(bytes, bytes + memory.get_size(),
+                       [](char c) { return c == 0; }));
+    assert(int(memory.get_mode()) <= int(mode));
+    std::cout << "pages: asked " << ttt::engine::to_string(mode) << ", got "
+              << ttt::engine::to_string(memory.get_mode()) << '\n';
+  }
+  ttt::engine::PageArray<int> small(16, PageMode::HUGETLB);
+  assert(small.size() == 16 && small.get_mode() == PageMode::NORMAL);
+  ttt::engine::PageArray<int> other(4, PageMode::NORMAL);
+  small[3] = 5;
+  small.swap(other);
+  assert(other[3] == 5 && small.size() == 4);
+  PageMode mode;
+  assert(ttt::engine::parse_page_mode("huge", mode) &&
+         mode == PageMode::HUGETLB);
+  assert(!ttt::engine::parse_page_mode("large", mode));
+
+  ttt::engine::set_page_policy(PageMode::NORMAL);
+  TranspositionTable tt(4);
+  assert(tt.get_page_mode() == PageMode::NORMAL);
+  ttt::engine::set_page_policy(PageMode::TRANSPARENT);
+}
+
+static Point search(const State &state, int depth, int n_threads) {
+  TranspositionTable tt(1);
+  ttt::engine::ParallelSearch search(n_threads);
+  search.set_table(&tt);
+  ttt::engine::SearchLimits limits;
+  limits.depth = depth;
+  const auto result = search.run(Board(state), limits);
+  // the counters of the helpers are added to those of the main search
+  const auto &stats = result.stats;
+  assert(stats.nodes == result.nodes && stats.depth == result.depth);
+  assert(stats.tt_hits <= stats.tt_probes && stats.qnodes <= stats.nodes);
+  if (!stats.iterations.empty())
+    assert(stats.iterations.back().depth <= result.depth);
+  return result.move;
+}
+
+static void test_tactics(int n_threads) {
+  // X completes the line and O has nothing to answer with
+  State state = make_state(10, 4, {{1, 1}, {1, 5}, {2, 1}, {2, 5}, {3, 1},
+                                   {8, 8}});
+  Point pt = search(state, 3, n_threads);
+  assert(pt.y == 1 && (pt.x == 0 || pt.x == 4));
+
+  // O must block the line of X
+  state = make_state(10, 4, {{1, 1}, {0, 1}, {2, 1}, {5, 5}, {3, 1}});
+  pt = search(state, 3, n_threads);
+  assert(pt.x == 4 && pt.y == 1);
+
+  // X has completed a line, O draws with the last reply
+  state = make_state(10, 4, {{1, 1}, {1, 5}, {2, 1}, {2, 5}, {3, 1}, {3, 5},
+                             {4, 1}});
+  assert(state.get_status() == ttt::game::Status::LAST_MOVE);
+  pt = search(state, 1, n_threads);
+  assert(pt.y == 5 && (pt.x == 0 || pt.x == 4));
+}
+
+static void test_games() {
+  ttt::my_player::SearchPlayer search_player("search", 20);
+  ttt::my_player::MyPlayer random_player("random");
+  ttt::engine::SearchStatsTotal stats;
+  search_player.set_stats_observer(&stats);
+  auto result =
+      ttt::test::run_game_tests(search_player, random_player, 3, 12, 4);
+  ttt::test::print_test_results(result, "search", "random");
+  ttt::test::print_search_stats(stats, "search");
+  assert(result.x_wins == 3);
+  const auto &total = stats.get_total();
+  assert(stats.get_searches_num() > 0 && total.nodes > 0);
+  assert(total.qnodes <= total.nodes);
+  assert(total.tt_hits <= total.tt_probes);
+  assert(total.first_cutoffs <= total.cutoffs);
+  search_player.set_stats_observer(nullptr);
+  result = ttt::test::run_game_tests(random_player, search_player, 3, 12, 4);
+  ttt::test::print_test_results(result, "random", "search");
+  assert(result.o_wins + result.draws == 3);
+}
+
+// Checks the moves of a search player with a node limit which were searched
+// while pondering.
+class PonderChecker : public ttt::game::IPlayer {
+  ttt::my_player::SearchPlayer &m_base;
+
+public:
+  int n_hits = 0;
+
+  PonderChecker(ttt::my_player::SearchPlayer &base) : m_base(base) {}
+
+  void set_sign(Sign sign) override { m_base.set_sign(sign); }
+  Point make_move(const State &state) override {
+    const int hits = m_base.get_ponder_hits();
+    const Point move = m_base.make_move(state);
+    if (m_base.get_ponder_hits() > hits) {
+      const auto &result = m_base.get_last_result();
+      int n_empty = 0;
+      for (int y = 0; y < state.get_opts().rows; ++y)
+        for (int x = 0; x < state.get_opts().cols; ++x)
+          n_empty += state.get_value(x, y) == Sign::NONE;
+      // nodes are checked every 1024 of them; the search may also end with
+      // a won score or after the last depth, and a single move needs none
+      const int64_t limit = m_base.get_node_limit();
+      assert(result.nodes < limit + 1024);
+      assert(result.nodes >= limit || result.depth > n_empty ||
+             result.depth == 0 || ttt::engine::is_win_score(result.score));
+      ++n_hits;
+    }
+    return move;
+  }
+  const char *get_name() const override { return m_base.get_name(); }
+  void handle_event(const State &state,
+                    const ttt::game::Event &event) override {
+    m_base.handle_event(state, event);
+  }
+};
+
+static void test_ponder() {
+  ttt::my_player::SearchPlayer x_player("x", 20, 4);
+  ttt::my_player::SearchPlayer o_player("o", 20, 4);
+  x_player.set_ponder(true);
+  o_player.set_ponder(true);
+  const auto result =
+      ttt::test::run_game_tests(x_player, o_player, 2, 12, 4);
+  assert(result.x_wins + result.o_wins + result.draws == 2);
+  const int hits = x_player.get_ponder_hits() + o_player.get_ponder_hits();
+  const int misses =
+      x_player.get_ponder_misses() + o_player.get_ponder_misses();
+  std::cout << "ponder: " << hits << " hits, " << misses << " misses\n";
+  // both players predict the moves of the same search
+  assert(hits > 0);
+
+  // with a node limit a hit plays a search of the full budget
+  PonderChecker x_checker(x_player), o_checker(o_player);
+  for (auto *player : {&x_player, &o_player}) {
+    player->set_node_limit(3000);
+    player->set_ponder(true);
+  }
+  ttt::test::run_game_tests(x_checker, o_checker, 2, 12, 4);
+  std::cout << "ponder with node limit: "
+            << x_checker.n_hits + o_checker.n_hits << " hits\n";
+  assert(x_checker.n_hits + o_checker.n_hits > 0);
+}
+
+// Deadlines leave the round trip and the margin, the soft one is shorter in
+// the opening and full with threats on the board, and a search stops soon
+// after it.
+static void test_time_manager() {
+  ttt::engine::TimeManager time(1000);
+  assert(time.get_round_trip_ms() == 0);
+  time.add_round_trip(30);
+  time.add_round_trip(12.5);
+  time.add_round_trip(40);
+  assert(time.get_round_trip_ms() == 12.5);
+  assert(time.get_margin_ms() == 5 + 50 + 13);
+  for (int i = 0; i < ttt::engine::TimeManager::N_SAMPLES; ++i)
+    time.add_round_trip(20);
+  assert(time.get_round_trip_ms() == 20);
+
+  const Board opening(make_state(15, 5, {{7, 7}}));
+  const Board middle(make_state(15, 5, {{7, 7}, {8, 8}, {9, 9}, {2, 2},
+                                        {6, 4}, {3, 10}}));
+  const Board threats(make_state(15, 5, {{7, 7}, {1, 1}, {7, 8}, {1, 3},
+                                         {7, 9}, {1, 5}, {7, 10}}));
+  const auto t_opening = time.start_move(opening);
+  const auto t_middle = time.start_move(middle);
+  const auto t_threats = time.start_move(threats);
+  assert(t_middle.hard_ms == 1000 - time.get_margin_ms());
+  assert(t_opening.hard_ms == t_middle.hard_ms);
+  assert(t_opening.soft_ms < t_middle.soft_ms);
+  assert(t_middle.soft_ms < t_middle.hard_ms);
+  assert(t_threats.soft_ms == t_threats.hard_ms);
+  time.set_limit(10);
+  assert(time.start_move(middle).hard_ms >= 1);
+
+  ttt::engine::Search search;
+  ttt::engine::SearchLimits limits;
+  limits.time_ms = 20000;
+  limits.soft_time_ms = 10;
+  const auto result = search.run(middle, limits);
+  assert(result.move.x >= 0);
+  assert(result.time_ms < limits.time_ms / 2);
+}
+
+// Cutoffs raise a move above others, misses lower it and aging keeps the
+// order of history but forgets killers.
+static void test_move_order() {
+  const Board board(make_state(15, 5, {{7, 7}, {8, 8}}));
+  ttt::engine::MoveOrder order;
+  order.prepare(board);
+  const int a = board.index(6, 6), b = board.index(9, 9);
+  const int prev = board.index(8, 8);
+  order.add_cutoff(0, 3, a, prev, 4);
+  order.add_miss(0, b, 4);
+  assert(order.get_killer(3, 0) == a && order.get_killer(3, 1) == -1);
+  assert(order.get_counter(0, prev) == a);
+  assert(order.get_score(0, 3, a, prev) > order.get_score(0, 3, b, prev));
+  assert(order.get_score(0, 5, a, -1) > 0);
+  assert(order.get_score(0, 5, b, -1) < 0);
+  assert(order.get_score(1, 5, a, -1) == 0);
+  for (int i = 0; i < 1000; ++i)
+    order.add_cutoff(1, 0, a, -1, 100);
+  assert(order.get_history(1, a) <= ttt::engine::MoveOrder::MAX_HISTORY);
+  order.add_cutoff(0, 3, b, prev, 4);
+  assert(order.get_killer(3, 0) == b && order.get_killer(3, 1) == a);
+
+  const int history = order.get_history(0, a);
+  order.prepare(board);
+  assert(order.get_history(0, a) == history / 2);
+  assert(order.get_killer(3, 0) == -1);
+  order.prepare(Board(make_state(9, 5, {})));
+  assert(order.get_history(0, board.index(6, 6)) == 0);
+
+  std::vector<int> cells;
+  ttt::engine::list_candidates(board, cells);
+  assert(!cells.empty());
+  for (int cell : cells)
+    assert(board.is_empty(cell) && board.has_neighbours(cell));
+  const Board empty(make_state(9, 5, {}));
+  ttt::engine::list_candidates(empty, cells);
+  assert(cells.size() == 81);
+  for (int cell : cells)
+    assert(ttt::engine::centre_score(empty, cell) <=
+           ttt::engine::centre_score(empty, empty.index(4, 4)));
+}
+
+// Counts the iterations reported by an analysis.
+class IterationCounter : public ttt::engine::IIterationObserver {
+public:
+  int n_iterations = 0;
+  void on_iteration(const ttt::engine::SearchResult &result) override {
+    assert(!result.lines.empty());
+    ++n_iterations;
+  }
+};
+
+// Multi-PV lines have exact scores in descending order, the first one is the
+// played move, and the analysis runs and stops on its own thread.
+static void test_multi_pv() {
+  // X completes the line at either end
+  State state = make_state(10, 4, {{1, 1}, {1, 5}, {2, 1}, {2, 5}, {3, 1},
+                                   {8, 8}});
+  ttt::engine::Search search;
+  search.set_multi_pv(3);
+  ttt::engine::SearchLimits limits;
+  limits.depth = 3;
+  auto result = search.run(Board(state), limits);
+  assert(result.lines.size() == 3);
+  assert(result.lines[0].move.x == result.move.x &&
+         result.lines[0].move.y == result.move.y);
+  assert(result.lines[0].score == result.score);
+  for (int i = 0; i < 2; ++i) {
+    const auto &line = result.lines[i];
+    assert(line.move.y == 1 && (line.move.x == 0 || line.move.x == 4));
+    assert(ttt::engine::is_win_score(line.score));
+  }
+  assert(result.lines[1].move.x != result.lines[0].move.x);
+  assert(result.lines[2].score <= result.lines[1].score);
+  for (const auto &line : result.lines)
+    assert(!line.pv.empty() && line.pv[0].x == line.move.x &&
+           line.pv[0].y == line.move.y);
+
+  TranspositionTable tt(4);
+  ttt::engine::Analyzer analyzer(&tt);
+  state = make_state(12, 4, {{5, 5}, {6, 6}});
+  result = analyzer.analyze(state, limits, 4);
+  assert(result.depth == 3 && result.lines.size() == 4);
+  for (size_t i = 1; i < result.lines.size(); ++i)
+    assert(result.lines[i].score <= result.lines[i - 1].score);
+
+  IterationCounter counter;
+  analyzer.start(state, ttt::engine::SearchLimits(), 2, &counter);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  assert(analyzer.is_running());
+  analyzer.stop();
+  assert(!analyzer.is_running() && counter.n_iterations > 0);
+  assert(analyzer.get_result().lines.size() == 2);
+
+  std::ostringstream out;
+  {
+    ttt::my_player::AnalysisWriter writer(out, 2, limits, &tt);
+    ttt::my_player::MyPlayer x_player("x"), o_player("o");
+    ttt::test::run_game_tests(x_player, o_player, 1, 10, 4, 0.75, 50, 1,
+                              &writer);
+  }
+  assert(out.str().find("analysis move") != std::string::npos);
+
+  // the positions of the moves of the analysed player (X, even move numbers)
+  // are skipped
+  out.str("");
+  {
+    ttt::my_player::AnalysisWriter writer(out, 2, limits, &tt);
+    ttt::my_player::MyPlayer x_player("x"), o_player("o");
+    ttt::my_player::AnalysedPlayer analysed(x_player, writer);
+    ttt::test::run_game_tests(analysed, o_player, 1, 10, 4, 0.75, 50, 1,
+                              &writer);
+  }
+  std::istringstream in(out.str());
+  std::string word;
+  int n_analysed = 0;
+  while (in >> word) {
+    if (word != "analysis" || !(in >> word) || word != "move")
+      continue;
+    int move_no = 0;
+    in >> move_no;
+    assert(move_no % 2 == 1);
+    ++n_analysed;
+  }
+  assert(n_analysed > 0);
+}
+
+int main(int argc, char *argv[]) {
+  std::srand(argc > 1 ? std::atoi(argv[1]) : 1);
+  test_board_consistency();
+  test_walled_candidates();
+  test_transposition_table();
+  test_large_pages();
+  test_tactics(1);
+  // helpers of the parallel search must not change the results
+  test_tactics(3);
+  test_games();
+  test_ponder();
+  test_time_manager();
+  test_move_order();
+  test_multi_pv();
+  std::cout << "search tests passed\n";
+  return 0;
+}
@@ -1,5 +1,8 @@
 #include "player/my_player.hpp"
+#include "player/search_player.hpp"
+#include "stats/recorder.hpp"
 #include "test_stats.hpp"
+#include <memory>
 #include <iostream>
 #include <cstdlib>
 
@@ -12,10 +15,33 @@ int main(int argc, char *argv[]) {
     
     ttt::my_player::MyPlayer p1("MyPlayer"); ////поместите вашего игрока сюда
     ttt::my_player::MyPlayer p2("MyPlayer");
-    auto result = ttt::test::run_game_tests(p1, p2, 100); //здесь вы можете изменить количество тестовых итераций ~~ 100
+    //второй аргумент - папка, куда записывается статистика по каждому ходу (см. cli_stats)
+    std::unique_ptr<ttt::stats::ColumnWriter> writer;
+    std::unique_ptr<ttt::stats::StatsRecorder> recorder;
+    std::unique_ptr<ttt::stats::ThinkTimer> t1, t2;
+    ttt::game::IPlayer *x_player = &p1, *o_player = &p2;
+    if (argc >= 3) {
+        writer.reset(new ttt::stats::ColumnWriter(argv[2]));
+        recorder.reset(new ttt::stats::StatsRecorder(*writer));
+        t1.reset(new ttt::stats::ThinkTimer(p1, *recorder));
+        t2.reset(new ttt::stats::ThinkTimer(p2, *recorder));
+        x_player = t1.get();
+        o_player = t2.get();
+    }
+    auto result = ttt::test::run_game_tests(*x_player, *o_player, 100, 20, 5, 0.75, 50, 1, recorder.get()); //здесь вы можете изменить количество тестовых итераций ~~ 100
     
     
     ttt::test::print_test_results(result, "MyPlayer", "MyPlayer");
+
+    //статистика поиска SearchPlayer по всем его ходам (глубина, узлы, попадания в таблицу)
+    std::cout << "Testing SearchPlayer vs MyPlayer\n";
+    ttt::my_player::SearchPlayer p3("SearchPlayer", 300, 4);
+    p3.set_node_limit(10000);
+    ttt::engine::SearchStatsTotal search_stats;
+    p3.set_stats_observer(&search_stats);
+    auto search_result = ttt::test::run_game_tests(p3, p2, 4, 20, 5);
+    ttt::test::print_test_results(search_result, "SearchPlayer", "MyPlayer");
+    ttt::test::print_search_stats(search_stats, "SearchPlayer");
     
     return 0;
 }
\ No newline at end of file
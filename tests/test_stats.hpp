@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/game.hpp"
+#include "engine/search_stats.hpp"
 #include <iostream>
 #include <cassert>
 #include <ctime>
@@ -90,7 +91,7 @@ struct TestResult {
     double game_time = 0;
 };
 
-static TestResult run_game_tests(
+inline TestResult run_game_tests(
     game::IPlayer& p1, 
     game::IPlayer& p2, 
     int num_iterations = 100,
@@ -98,7 +99,8 @@ static TestResult run_game_tests(
     int win_length = 5,
     float playable_part = 0.75,
     int max_obstacle_len = 50,
-    int obstacles_gap = 1) {
+    int obstacles_gap = 1,
+    game::IObserver *observer = nullptr) {
     
     //game options
     game::State::Opts opts;
@@ -116,6 +118,7 @@ static TestResult run_game_tests(
     game::Game game(opts, &field_initializer);
     game.add_player(game::Sign::X, &tm_p1);
     game.add_player(game::Sign::O, &tm_p2);
+    game.add_observer(observer);
     
     //prepare result counters
     TestResult result;
@@ -160,7 +163,7 @@ static TestResult run_game_tests(
 }
 
 //helper to print test results
-static void print_test_results(const TestResult& result, 
+inline void print_test_results(const TestResult& result, 
                               const std::string& player_x_name = "X",
                               const std::string& player_o_name = "O") {
     std::cout << player_x_name << " wins: " << result.x_wins << "\n"
@@ -186,4 +189,19 @@ static void print_test_results(const TestResult& result,
     assert(result.x_move_time < 100);
 }
 
+//helper to print the search statistics of all moves of a player
+inline void print_search_stats(const engine::SearchStatsTotal& total,
+                               const std::string& player_name) {
+    const auto& stats = total.get_total();
+    const int n = total.get_searches_num();
+    std::cout << player_name << " search statistics (" << n << " moves):\n"
+              << " - average depth: " << total.get_average_depth()
+              << "\n - nodes per move: " << (n > 0 ? stats.nodes / n : 0)
+              << " (quiescence " << (n > 0 ? stats.qnodes / n : 0) << ")"
+              << "\n - knodes/s: " << stats.get_nps() / 1000
+              << "\n - TT hits (%): " << stats.get_tt_hit_rate() * 100
+              << "\n - first move cutoffs (%): "
+              << stats.get_first_cutoff_rate() * 100 << "\n\n";
+}
+
 } // namespace ttt::test
\ No newline at end of file
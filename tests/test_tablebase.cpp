@@ -0,0 +1,157 @@
+#include "engine/tablebase.hpp"
+#include "player/my_player.hpp"
+#include "player/search_player.hpp"
+#include "test_positions.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+using ttt::engine::Board;
+using ttt::engine::ProofValue;
+using ttt::engine::Tablebase;
+using ttt::engine::TablebaseBuilder;
+using ttt::game::State;
+using ttt::test::minimax;
+using ttt::test::parse;
+using ttt::test::value_of;
+
+// Every reachable position has the minimax value, finished games included,
+// and the move of the tablebase keeps it.
+static void check_all(const Tablebase &tb, Board &b,
+                      std::unordered_map<uint64_t, int> &memo,
+                      std::unordered_set<uint64_t> &seen) {
+  if (!seen.insert(b.get_hash()).second)
+    return;
+  const ProofValue value = value_of(minimax(b, memo));
+  assert(tb.probe(b) == value);
+  if (b.is_over())
+    return;
+  ttt::game::Point move;
+  const bool found = tb.find_move(b, move);
+  assert(found);
+  b.make(b.index(move.x, move.y));
+  const ProofValue after = value_of(-minimax(b, memo));
+  b.unmake();
+  assert(after == value || value == ProofValue::LOSS);
+  for (int y = 0; y < b.get_rows(); ++y) {
+    for (int x = 0; x < b.get_cols(); ++x) {
+      const int cell = b.index(x, y);
+      if (!b.is_empty(cell))
+        continue;
+      b.make(cell);
+      check_all(tb, b, memo, seen);
+      b.unmake();
+    }
+  }
+}
+
+static void test_index() {
+  ttt::engine::TablebaseIndex index;
+  bool ok = index.init(3, 4, 3, 0, 1ull << 5);
+  assert(ok);
+  assert(index.get_cells_num() == 11);
+  for (int k = 0; k <= index.get_cells_num(); ++k) {
+    assert(index.get_group_begin(k) % 4 == 0);
+    for (uint64_t rank = 0; rank < index.get_group_size(k); ++rank) {
+      uint32_t x, o;
+      index.unindex(k, rank, x, o);
+      assert(__builtin_popcount(x) == (k + 1) / 2 && !(x & o));
+      assert(__builtin_popcount(x | o) == k);
+      assert(index.index(x, o) == index.get_group_begin(k) + rank);
+    }
+  }
+  const char *error = nullptr;
+  ok = index.init(5, 5, 4, 0, 0, &error);
+  assert(!ok && error);
+}
+
+static void test_solve(const char *text, int n_threads, ProofValue root) {
+  const char *path = "test_tablebase.bin";
+  const auto state = parse(text);
+  TablebaseBuilder builder;
+  const char *error = nullptr;
+  bool ok = builder.init(*state, &error);
+  assert(ok);
+  builder.generate(n_threads);
+  ok = builder.save(path);
+  assert(ok);
+  Tablebase tb;
+  ok = tb.open(path, &error);
+  assert(ok);
+  Board board(*state);
+  assert(tb.fits(board) && tb.probe(board) == root);
+  std::unordered_map<uint64_t, int> memo;
+  std::unordered_set<uint64_t> seen;
+  check_all(tb, board, memo, seen);
+  std::cout << "tablebase " << state->get_opts().rows << "x"
+            << state->get_opts().cols << ": " << seen.size()
+            << " positions, " << ttt::engine::to_string(root) << '\n';
+
+  // another field does not fit
+  const auto other = parse("2 2 2 0\n..\n..\n");
+  assert(!tb.fits(Board(*other)) &&
+         tb.probe(*other) == ProofValue::UNKNOWN);
+  std::FILE *file = std::fopen(path, "ab");
+  std::fputc(0, file);
+  std::fclose(file);
+  ok = tb.open(path, &error);
+  assert(!ok);
+  std::remove(path);
+}
+
+// The search player plays a drawn field by the tablebase and never loses.
+static void test_player() {
+  const char *path = "test_tablebase_player.bin";
+  State::Opts opts;
+  opts.rows = opts.cols = 3;
+  opts.win_len = 3;
+  opts.max_moves = 0;
+  TablebaseBuilder builder;
+  bool ok = builder.init(State(opts));
+  assert(ok);
+  builder.generate(2);
+  ok = builder.save(path);
+  assert(ok);
+  auto tb = std::make_shared<Tablebase>();
+  ok = tb->open(path);
+  assert(ok);
+  ttt::my_player::SearchPlayer player("tablebase", 20);
+  player.set_tablebase(tb);
+  ttt::my_player::MyPlayer random_player("random");
+  for (int i = 0; i < 10; ++i) {
+    const bool x_tb = i % 2 == 0;
+    ttt::game::Game game(opts, nullptr);
+    game.add_player(ttt::game::Sign::X,
+                    x_tb ? static_cast<ttt::game::IPlayer *>(&player)
+                         : &random_player);
+    game.add_player(ttt::game::Sign::O,
+                    x_tb ? static_cast<ttt::game::IPlayer *>(&random_player)
+                         : &player);
+    ttt::game::MoveResult res;
+    do {
+      res = game.process();
+    } while (res == ttt::game::MoveResult::OK);
+    assert(!ttt::game::is_dq(res) && res != ttt::game::MoveResult::ERROR);
+    const auto loser = x_tb ? ttt::game::Sign::O : ttt::game::Sign::X;
+    assert(res == ttt::game::MoveResult::DRAW ||
+           game.get_state().get_winner() != loser);
+  }
+  std::remove(path);
+}
+
+int main() {
+  test_index();
+  test_solve("3 3 3 0\n...\n...\n...\n", 1, ProofValue::DRAW);
+  // X completes a line with the last move of the game
+  test_solve("1 3 2 0\n...\n", 1, ProofValue::WIN);
+  test_solve("2 3 2 3\n...\n...\n", 1, ProofValue::WIN);
+  // walls and the limit of moves, solved by several threads
+  test_solve("3 4 3 0\n....\n.#..\n....\n", 3, ProofValue::DRAW);
+  test_solve("3 4 3 7\n#...\n....\n...#\n", 2, ProofValue::WIN);
+  test_player();
+  std::cout << "tablebase tests passed\n";
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include "engine/position.hpp"
+#include "engine/proof_solver.hpp"
+#include "engine/threat_solver.hpp"
+#include "player/search_player.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using ttt::engine::Board;
+using ttt::engine::Outcome;
+using ttt::engine::ThreatLimits;
+using ttt::engine::ThreatMode;
+using ttt::engine::ThreatResult;
+using ttt::engine::ThreatSolver;
+using ttt::game::Point;
+using ttt::game::Sign;
+using ttt::game::State;
+
+class WallsFI : public ttt::game::IFieldInitializer {
+  std::vector<Point> m_walls;
+
+public:
+  WallsFI(const std::vector<Point> &walls) : m_walls(walls) {}
+  void initialize(ttt::game::FieldBitmap &field) override {
+    for (const auto &pt : m_walls)
+      field.set(pt.x, pt.y, Sign::WALL);
+  }
+  IFieldInitializer *clone() const override { return new WallsFI(*this); }
+};
+
+// Position on a 15x15 field with five in a row to win, stones of X and O are
+// placed in turn.
+static Board make_board(const std::vector<Point> &x_stones,
+                        const std::vector<Point> &o_stones,
+                        const std::vector<Point> &walls = {}) {
+  State::Opts opts;
+  opts.rows = opts.cols = 15;
+  opts.win_len = 5;
+  opts.max_moves = 0;
+  WallsFI initializer(walls);
+  State state(opts, &initializer);
+  for (size_t i = 0; i < x_stones.size() || i < o_stones.size(); ++i) {
+    if (i < x_stones.size())
+      state.process_move(Sign::X, x_stones[i].x, x_stones[i].y);
+    if (i < o_stones.size())
+      state.process_move(Sign::O, o_stones[i].x, o_stones[i].y);
+  }
+  return Board(state);
+}
+
+static ThreatResult solve(const Board &board, ThreatMode mode) {
+  ThreatSolver solver;
+  ThreatLimits limits;
+  limits.nodes = 1000000;
+  return solver.solve(board, mode, limits);
+}
+
+// The sequence must end with a line the defender cannot answer.
+static void check_sequence(Board board, const ThreatResult &result) {
+  const int attacker = board.get_side_to_move();
+  assert(result.win && !result.sequence.empty());
+  for (const auto &pt : result.sequence) {
+    const int cell = board.index(pt.x, pt.y);
+    assert(board.is_empty(cell));
+    board.make(cell);
+  }
+  if (board.is_last_move())
+    assert(attacker == 0 && board.get_threats(1) == 0);
+  else
+    assert(board.get_outcome() ==
+           (attacker == 0 ? Outcome::X_WINS : Outcome::O_WINS));
+}
+
+static void test_fours() {
+  // an open three becomes an open four
+  const std::vector<Point> three = {{3, 3}, {4, 3}, {5, 3}};
+  Board board = make_board(three, {{10, 10}, {12, 10}, {10, 12}});
+  ThreatResult result = solve(board, ThreatMode::VCF);
+  check_sequence(board, result);
+  std::cout << "vcf: " << result.sequence.size() << " moves, "
+            << result.nodes << " nodes\n";
+
+  // O wins the same way without the last reply of X
+  board = make_board({{0, 0}, {14, 14}, {0, 14}, {14, 0}}, three);
+  result = solve(board, ThreatMode::VCF);
+  check_sequence(board, result);
+
+  // walls leave no room for a line
+  board = make_board(three, {{10, 10}, {12, 10}, {10, 12}}, {{2, 3}, {6, 3}});
+  assert(!solve(board, ThreatMode::VCF).win);
+  assert(!solve(board, ThreatMode::VCT).win);
+
+  // X has to block a four of O, which makes no threat
+  board = make_board({{3, 3}, {4, 3}, {5, 3}, {10, 9}},
+                     {{10, 10}, {10, 11}, {10, 12}, {10, 13}});
+  assert(!solve(board, ThreatMode::VCF).win);
+
+  // X completes a line, but O completes own one with the last reply
+  board = make_board({{3, 3}, {4, 3}, {5, 3}, {6, 3}},
+                     {{10, 10}, {10, 11}, {10, 12}, {10, 13}});
+  assert(!solve(board, ThreatMode::VCF).win);
+}
+
+static void test_threes() {
+  // two open threes at once need a three to start with
+  const Board board = make_board({{4, 4}, {5, 4}, {6, 5}, {6, 6}},
+                                 {{12, 12}, {13, 12}, {12, 13}, {0, 13}});
+  assert(!solve(board, ThreatMode::VCF).win);
+  const ThreatResult result = solve(board, ThreatMode::VCT);
+  check_sequence(board, result);
+  std::cout << "vct: " << result.sequence.size() << " moves, "
+            << result.nodes << " nodes\n";
+}
+
+static void test_counter_three() {
+  // the VCT line of X starts with a three at 7,2 and O answers it with a
+  // block, but O escapes without a block or a four: its own three at 1,5
+  // leaves X no win
+  std::istringstream in("10 10 5 0\n"
+                        "#..##..#..\n"
+                        "...###....\n"
+                        "#...X.X...\n"
+                        "OO#..##.X#\n"
+                        "..##.##X##\n"
+                        "...O...X##\n"
+                        ".O#.O...X.\n"
+                        "X.##O.##..\n"
+                        "...#..###.\n"
+                        ".#......O.\n");
+  ttt::engine::Position pos;
+  const char *error = nullptr;
+  const bool read = ttt::engine::read_position(in, pos, &error);
+  assert(read);
+  const auto state = ttt::engine::make_state(pos);
+  assert(state);
+  Board board(*state);
+  assert(!solve(board, ThreatMode::VCF).win);
+  const ThreatResult result = solve(board, ThreatMode::VCT);
+  assert(result.win && result.sequence[0].x == 7 && result.sequence[0].y == 2);
+
+  board.make(board.index(7, 2));
+  const int escape = board.index(1, 5);
+  assert(board.count_windows(escape, 0, board.get_win_len() - 2) == 0);
+  assert(!board.makes_threat(escape, 1));
+  assert(board.count_windows(escape, 1, board.get_win_len() - 3) > 0);
+  board.make(escape);
+  ttt::engine::ProofSolver proof(16);
+  ttt::engine::ProofLimits limits;
+  limits.nodes = 1000000;
+  assert(proof.solve(board, limits).value == ttt::engine::ProofValue::DRAW);
+
+  // the player does not take the line for a win
+  ttt::my_player::SearchPlayer player("search", 300, 1);
+  player.set_node_limit(20000);
+  player.set_sign(Sign::X);
+  player.make_move(*state);
+  assert(!ttt::engine::is_win_score(player.get_last_result().score));
+}
+
+static void test_budget() {
+  // the solver stops within the budget on an open position
+  const Board board = make_board({{7, 7}, {8, 8}, {6, 8}}, {{7, 8}, {8, 7}});
+  ThreatSolver solver;
+  ThreatLimits limits;
+  limits.nodes = 2000;
+  limits.depth = 30;
+  const auto result = solver.find_win(board, limits);
+  assert(result.win || result.nodes <= limits.nodes + 512);
+}
+
+int main() {
+  test_fours();
+  test_threes();
+  test_counter_three();
+  test_budget();
+  std::cout << "threat solver tests passed\n";
+  return 0;
+}
@@ -0,0 +1,262 @@
+#include "player/search_player.hpp"
+#include "remote/cli_utils.hpp"
+#include "test_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Tunes the evaluation weights and the tempo of the search player by SPSA:
+// every iteration perturbs all parameters at once by random signs, plays the
+// two perturbed players against each other and moves the parameters towards
+// the winner. Steps follow the usual schedule of Spall with the values of
+// perturbation `c_end` and learning rate `r_end` at the last iteration, the
+// rate is larger than usual for runs of thousands rather than of millions of
+// games.
+
+using ttt::my_player::SearchPlayer;
+
+struct TuneParam {
+  const char *name;
+  double value;
+  double min;
+  double max;
+  double c_end;
+  double r_end;
+};
+
+static std::vector<TuneParam> default_params() {
+  const ttt::engine::EvalWeights weights;
+  const ttt::engine::SearchParams search;
+  return {
+      {"missing0", double(weights.missing[0]), 256, 4096, 64, 0.02},
+      {"missing1", double(weights.missing[1]), 16, 1024, 12, 0.02},
+      {"missing2", double(weights.missing[2]), 2, 128, 2, 0.02},
+      {"missing3", double(weights.missing[3]), 1, 32, 1, 0.02},
+      {"tempo", double(search.tempo), 0, 64, 4, 0.02},
+  };
+}
+
+static void set_values(const std::vector<double> &values, SearchPlayer &player) {
+  ttt::engine::EvalWeights weights;
+  for (int i = 0; i < 4; ++i)
+    weights.missing[i] = std::lround(values[i]);
+  ttt::engine::SearchParams search;
+  search.tempo = std::lround(values[4]);
+  player.set_weights(weights);
+  player.set_params(search);
+  player.get_table().clear();
+}
+
+static bool save_checkpoint(const char *path, int iteration,
+                            const std::vector<TuneParam> &params) {
+  const std::string tmp = std::string(path) + ".tmp";
+  {
+    std::ofstream out(tmp);
+    out << "iteration " << iteration << '\n' << std::setprecision(10);
+    for (const auto &p : params)
+      out << p.name << ' ' << p.value << '\n';
+    if (!out)
+      return false;
+  }
+  return std::rename(tmp.c_str(), path) == 0;
+}
+
+// Keeps the parameters and returns false if the file does not exist.
+static bool load_checkpoint(const char *path, int &iteration,
+                            std::vector<TuneParam> &params) {
+  std::ifstream in(path);
+  if (!in)
+    return false;
+  std::string name;
+  double value;
+  while (in >> name >> value) {
+    if (name == "iteration")
+      iteration = int(value);
+    for (auto &p : params)
+      if (name == p.name)
+        p.value = std::clamp(value, p.min, p.max);
+  }
+  return true;
+}
+
+// Pair of perturbed players of one thread.
+struct Worker {
+  SearchPlayer plus{"plus", 0, 4};
+  SearchPlayer minus{"minus", 0, 4};
+  int score = 0;
+};
+
+int main(int argc, char *argv[]) {
+  mycli::cli_t cli{{
+      {"iterations", 'n', 1, "number of SPSA iterations", "200"},
+      {"games", 'g', 1, "games of every iteration, rounded to pairs", "16"},
+      {"threads", 'j', 1, "number of threads, 0 for all cores", "0"},
+      {"movetime", 't', 1, "time limit of one move, ms", "20"},
+      {"size", 's', 1, "size of the field", "10"},
+      {"win", 'w', 1, "length of the winning line", "5"},
+      {"checkpoint", 'c', 1,
+       "file of the parameters after every iteration, tuning goes on from "
+       "it if it exists"},
+      {"report", 'r', 1, "iterations between the reports of convergence",
+       "10"},
+      {"seed", 0, 1, "seed of the perturbations"},
+      {"help", 'h', 0, "show this message"},
+  }};
+  const char *usage = "usage: tune_spsa [opts]";
+  auto args = cli.parse(argc - 1, argv + 1);
+  if (!args.error.empty()) {
+    std::cerr << "error: " << args.error << "\n";
+    std::cerr << usage << '\n';
+    cli.print_opts(std::cerr, 80);
+    return 1;
+  }
+  if (args.has_flag("help")) {
+    std::cout << "tune_spsa: tunes the evaluation weights and the tempo of "
+                 "the search player\nby SPSA on games of perturbed players "
+                 "against each other.\n"
+              << usage << '\n';
+    cli.print_opts(std::cout, 80);
+    return 0;
+  }
+  auto get_int = [&](const char *name) {
+    const char *value = cli.get_default(name);
+    if (const char *const *kw = args.get_keyword(name, 0))
+      value = *kw;
+    return std::stoi(value);
+  };
+  const int n_iterations = std::max(1, get_int("iterations"));
+  const int n_pairs = std::max(1, get_int("games") / 2);
+  int n_threads = get_int("threads");
+  if (n_threads <= 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  n_threads = std::min(n_threads, n_pairs);
+  const int movetime = get_int("movetime");
+  const int size = get_int("size");
+  const int win = get_int("win");
+  const int report = std::max(1, get_int("report"));
+  unsigned seed = std::random_device{}();
+  if (const char *const *kw = args.get_keyword("seed", 0))
+    seed = std::stoul(*kw);
+  const char *checkpoint = nullptr;
+  if (const char *const *kw = args.get_keyword("checkpoint", 0))
+    checkpoint = *kw;
+
+  auto params = default_params();
+  const int n_params = params.size();
+  int iteration = 0;
+  if (checkpoint && load_checkpoint(checkpoint, iteration, params))
+    std::cout << "resumed from " << checkpoint << " at iteration "
+              << iteration << '\n';
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (int i = 0; i < n_threads; ++i) {
+    workers.push_back(std::make_unique<Worker>());
+    workers.back()->plus.set_timelimit(movetime);
+    workers.back()->minus.set_timelimit(movetime);
+  }
+
+  const double alpha = 0.602;
+  const double gamma = 0.101;
+  const double big_a = 0.1 * n_iterations;
+  // values at the start of the report window
+  std::vector<double> window_start(n_params);
+  for (int i = 0; i < n_params; ++i)
+    window_start[i] = params[i].value;
+  // variance of the moves of the parameters over the window if the players
+  // were equal and every game a coin toss
+  std::vector<double> window_noise(n_params);
+  int window_score = 0;
+  int window_games = 0;
+
+  for (int k = iteration + 1; k <= n_iterations; ++k) {
+    std::mt19937 rng(seed ^ (k * 0x9e3779b9u));
+    std::vector<double> c(n_params), plus(n_params), minus(n_params);
+    std::vector<int> delta(n_params);
+    for (int i = 0; i < n_params; ++i) {
+      const auto &p = params[i];
+      c[i] = p.c_end * std::pow(double(n_iterations) / k, gamma);
+      delta[i] = rng() & 1 ? 1 : -1;
+      plus[i] = std::clamp(p.value + c[i] * delta[i], p.min, p.max);
+      minus[i] = std::clamp(p.value - c[i] * delta[i], p.min, p.max);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+      Worker &w = *workers[t];
+      const int pairs = n_pairs / n_threads + (t < n_pairs % n_threads);
+      set_values(plus, w.plus);
+      set_values(minus, w.minus);
+      threads.emplace_back([&w, pairs, size, win] {
+        auto r = ttt::test::run_game_tests(w.plus, w.minus, pairs, size, win);
+        w.score = r.x_wins - r.o_wins;
+        r = ttt::test::run_game_tests(w.minus, w.plus, pairs, size, win);
+        w.score += r.o_wins - r.x_wins;
+      });
+    }
+    for (auto &t : threads)
+      t.join();
+    int score = 0;
+    for (int t = 0; t < n_threads; ++t)
+      score += workers[t]->score;
+
+    for (int i = 0; i < n_params; ++i) {
+      auto &p = params[i];
+      const double a_end = p.r_end * p.c_end * p.c_end;
+      const double a =
+          a_end * std::pow((big_a + n_iterations) / (big_a + k), alpha);
+      // step a / c^2 per unit of the difference of the scores times c
+      const double step = a / c[i];
+      p.value = std::clamp(p.value + step * score * delta[i], p.min, p.max);
+      window_noise[i] += step * step * 2 * n_pairs;
+    }
+    window_score += score;
+    window_games += 2 * n_pairs;
+
+    std::cout << "iteration " << k << '/' << n_iterations << " score "
+              << std::showpos << score << std::noshowpos << '/'
+              << 2 * n_pairs << std::fixed << std::setprecision(2);
+    for (const auto &p : params)
+      std::cout << ' ' << p.name << ' ' << p.value;
+    std::cout << std::defaultfloat << '\n';
+    if (checkpoint && !save_checkpoint(checkpoint, k, params)) {
+      std::cerr << "error: cannot write " << checkpoint << '\n';
+      return 1;
+    }
+
+    if (k % report == 0 || k == n_iterations) {
+      // parameters which have moved by no more than two deviations of the
+      // noise over the window only wander around the optimum
+      double max_drift = 0;
+      std::cout << "drift in deviations of noise:";
+      for (int i = 0; i < n_params; ++i) {
+        const double drift = (params[i].value - window_start[i]) /
+                             std::max(std::sqrt(window_noise[i]), 1e-9);
+        max_drift = std::max(max_drift, std::abs(drift));
+        std::cout << ' ' << params[i].name << ' ' << std::fixed
+                  << std::setprecision(2) << drift << std::defaultfloat;
+        window_start[i] = params[i].value;
+        window_noise[i] = 0;
+      }
+      std::cout << "\nscore of the perturbations " << window_score << '/'
+                << window_games << ", "
+                << (max_drift <= 2 ? "converged" : "not converged") << '\n';
+      window_score = window_games = 0;
+    }
+  }
+
+  std::cout << "EvalWeights missing = {";
+  for (int i = 0; i < 4; ++i)
+    std::cout << (i ? ", " : "") << std::lround(params[i].value);
+  std::cout << "}, SearchParams tempo = " << std::lround(params[4].value)
+            << '\n';
+  return 0;
+}